@@ -6,7 +6,7 @@ use CMakeList;
 use strict;
 
 ## EXECUTABLES
-my @masterprog=("activation");
+my @masterprog=("activation","testMain");
 
 
 
@@ -21,7 +21,7 @@ my @libnames=@sublibdir;
 
 ## SYSTEM Directory
 
-my @incdir=qw( include fileSupportInc globalInc );
+my @incdir=qw( include fileSupportInc globalInc testInc );
 
 
 my $gM=new CMakeList;
@@ -38,6 +38,12 @@ $gM->addDepUnit("activation",   ["src","attachComp","input","log","process",
 				 "geometry","glob","mersenne","monte",
 				 "src","xml","poly","support","md5",
 				 "fileSupport","work","support"]);
+
+$gM->addDepUnit("testMain",     ["test","src","attachComp","input","log",
+				 "process","geometry","glob","mersenne",
+				 "monte","src","xml","poly","support","md5",
+				 "fileSupport","work","support"]);
+$gM->addTestProgs(["testMain"]);
 $gM->writeCMake();
 
 print "FINISH CMake.pl\n";
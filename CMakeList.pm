@@ -16,6 +16,7 @@ sub new
     boostLib => "-L/opt/local/lib ",
     
     masterProg => undef,
+    testProg => undef,
     definitions => undef,
     depLists => undef,
     optimise => "",
@@ -30,6 +31,7 @@ sub new
   
   bless $self,$class;
   $self->{masterProg}=[ ];
+  $self->{testProg}=[ ];
   $self->{definitions}=[ ];
   $self->{incDir}=[ ];
   $self->{srcDir}={ };
@@ -52,6 +54,18 @@ sub addMasterProgs
   return;
 }
 
+sub addTestProgs
+  ##
+  ## Add an array of test programs [run by ctest]
+  ##
+{
+  my $self=shift;
+  my $Ar=shift;
+  
+  push(@{$self->{testProg}},@{$Ar});
+  return;
+}
+
 sub hasCPPFiles
   ##
     ## Simple test to find if we have C++
@@ -325,10 +339,21 @@ sub writeExcutables
       print $DX "target_link_libraries(",$item," gsl)\n";
       print $DX "target_link_libraries(",$item," gslcblas)\n";
       print $DX "target_link_libraries(",$item," m)\n";
+      print $DX "target_link_libraries(",$item," pthread)\n";
     }
   
   
   print $DX "## END EXECUTABLE \n\n";
+
+  if (@{$self->{testProg}})
+    {
+      print $DX "enable_testing()\n";
+      foreach my $item (@{$self->{testProg}})
+        {
+	  print $DX "add_test(NAME ",$item," COMMAND ",$item," -1 -1)\n";
+	}
+      print $DX "\n";
+    }
   return;
 }
 
@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <memory>
 #include <array>
+#include <functional>
 #include <endian.h>
 
 #include "Exception.h"
@@ -58,10 +59,14 @@
 #include "WorkData.h"
 #include "cinderOption.h"
 #include "cinderHistory.h"
+#include "scenarioSet.h"
 #include "htapeProcess.h"
 #include "tallyProcess.h"
 #include "materialProcess.h"
 #include "Control.h"
+#include "runPlan.h"
+#include "shardMerge.h"
+#include "runProgs.h"
 
 MTRand RNG(12345UL);
 
@@ -82,17 +87,54 @@ main(int argc,char* argv[])
 
   // PROCESS INPUT:
   InputControl::mainVector(argc,argv,Names);
+  int nWorkers(0);
+  const int workerFlag=
+    InputControl::flagVExtract(Names,"j","workers",nWorkers);
+  const int resumeFlag=
+    InputControl::flagExtract(Names,"r","resume");
+  std::string shardSpec;
+  const int shardFlag=
+    InputControl::flagVExtract(Names,"s","shard",shardSpec);
+  int nMerge(0);
+  const int mergeFlag=
+    InputControl::flagVExtract(Names,"m","merge",nMerge);
+  const int planFlag=
+    InputControl::flagExtract(Names,"p","plan");
+  int jobID(0);
+  const int jobFlag=
+    InputControl::flagVExtract(Names,"c","run-cell",jobID);
   const std::string IName=InputControl::getFileName(Names);
   
+  // SIGINT/SIGTERM end each phase cleanly [exit 130]
+  runProgs::Instance().catchSignals(1);
   Control mainProcess;
   
   mainProcess.readControlFile(IName);
-  mainProcess.runHTape();
+  if (mergeFlag==2 && nMerge>0)
+    return (shardMerge(mainProcess).merge(static_cast<size_t>(nMerge))) ? 1 : 0;
+  if (jobFlag==2 && jobID>0)
+    return runPlan(mainProcess).runCell(static_cast<size_t>(jobID));
+  if (shardFlag==2)
+    mainProcess.setShard(shardSpec);
+  if (workerFlag==2 && nWorkers>=0)
+    mainProcess.setWorkers(static_cast<size_t>(nWorkers));
+  mainProcess.setResume(resumeFlag);
   mainProcess.readFluxes();
+  mainProcess.pruneCells();
+  if (runProgs::stopLevel()) return 130;
+  mainProcess.runHTape();
+  if (runProgs::stopLevel()) return 130;
   mainProcess.readMaterials();
+  mainProcess.groupCells();
+  if (runProgs::stopLevel()) return 130;
 
-  mainProcess.writeCinderInput();
-  
-  return 0;
+  if (planFlag)
+    {
+      runPlan(mainProcess).writePlan();
+      return 0;
+    }
+  // 1 : failed jobs / 2 : stopped
+  const int runFlag=mainProcess.writeCinderInput();
+  return (runFlag==2) ? 130 : runFlag;
 
 }
@@ -0,0 +1,235 @@
+/********************************************************************* 
+  CombLayer : MCNP(X) SSW/SSR Reader
+ 
+ * File:   Main/testMain.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ ****************************************************************************/
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <vector>
+#include <set>
+#include <map>
+#include <string>
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "MersenneTwister.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h" 
+#include "GTKreport.h"
+#include "OutputLog.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "InputControl.h"
+#include "MainProcess.h"
+#include "support.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "TestFunc.h"
+#include "testCellRunner.h"
+#include "testRunProgs.h"
+#include "testResultCache.h"
+#include "testRunJournal.h"
+#include "testShardMerge.h"
+#include "testCellDedup.h"
+#include "testNormSweep.h"
+#include "testScenario.h"
+#include "testSampleStats.h"
+#include "testUQSampler.h"
+#include "testTallyProcess.h"
+#include "testMaterialProcess.h"
+#include "testHtapeScan.h"
+#include "testHtapeStream.h"
+
+MTRand RNG(12345UL);
+
+namespace ELog 
+{
+  ELog::OutputLog<EReport> EM;
+}
+
+int
+activationTest(const int type,const int extra)
+  /*!
+    Run the tests of a test class
+    \param type :: Test class [0 : list / -ve : all]
+    \param extra :: Test of the class [0 : list / -ve : all]
+    \return -ve on error / 0 on success
+  */
+{
+  if (!type)
+    {
+      std::cout<<"testCellRunner         (1)"<<std::endl;
+      std::cout<<"testRunProgs           (2)"<<std::endl;
+      std::cout<<"testResultCache        (3)"<<std::endl;
+      std::cout<<"testRunJournal         (4)"<<std::endl;
+      std::cout<<"testShardMerge         (5)"<<std::endl;
+      std::cout<<"testCellDedup          (6)"<<std::endl;
+      std::cout<<"testNormSweep          (7)"<<std::endl;
+      std::cout<<"testScenario           (8)"<<std::endl;
+      std::cout<<"testSampleStats        (9)"<<std::endl;
+      std::cout<<"testUQSampler          (10)"<<std::endl;
+      std::cout<<"testTallyProcess       (11)"<<std::endl;
+      std::cout<<"testMaterialProcess    (12)"<<std::endl;
+      std::cout<<"testHtapeScan          (13)"<<std::endl;
+      std::cout<<"testHtapeStream        (14)"<<std::endl;
+      return 0;
+    }
+  if (type==1 || type<0)
+    {
+      testCellRunner A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==2 || type<0)
+    {
+      testRunProgs A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==3 || type<0)
+    {
+      testResultCache A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==4 || type<0)
+    {
+      testRunJournal A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==5 || type<0)
+    {
+      testShardMerge A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==6 || type<0)
+    {
+      testCellDedup A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==7 || type<0)
+    {
+      testNormSweep A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==8 || type<0)
+    {
+      testScenario A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==9 || type<0)
+    {
+      testSampleStats A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==10 || type<0)
+    {
+      testUQSampler A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==11 || type<0)
+    {
+      testTallyProcess A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==12 || type<0)
+    {
+      testMaterialProcess A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==13 || type<0)
+    {
+      testHtapeScan A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  if (type==14 || type<0)
+    {
+      testHtapeStream A;
+      const int X=A.applyTest(extra);
+      if (X) return X;
+    }
+  return 0;
+}
+
+int 
+main(int argc,char* argv[])
+  /*!
+    Run the tests : testMain [type] [extra]
+    with -1 for all [default]. testMain 0 lists the
+    test classes and testMain type 0 the tests of a class.
+  */
+{
+  ELog::RegMethod RControl("","main");
+  mainSystem::activateLogging(RControl);
+
+  std::vector<std::string> Names;  
+  InputControl::mainVector(argc,argv,Names);
+
+  int type(-1),extra(-1);
+  if (!Names.empty() && !StrFunc::convert(Names[0],type))
+    {
+      ELog::EM<<"Usage : testMain [type] [extra]"<<ELog::endCrit;
+      return -1;
+    }
+  if (Names.size()>1 && !StrFunc::convert(Names[1],extra))
+    {
+      ELog::EM<<"Usage : testMain [type] [extra]"<<ELog::endCrit;
+      return -1;
+    }
+
+  int exitFlag(0);
+  try
+    {
+      exitFlag=activationTest(type,extra);
+    }
+  catch (ColErr::ExBase& A)
+    {
+      ELog::EM<<"\nEXCEPTION FAILURE :: "
+	      <<A.what()<<ELog::endCrit;
+      exitFlag= -1;
+    }
+  catch (boost::filesystem::filesystem_error& A)
+    {
+      ELog::EM<<"\nFILESYSTEM FAILURE :: "
+	      <<A.what()<<ELog::endCrit;
+      exitFlag= -1;
+    }
+
+  if (exitFlag)
+    ELog::EM<<"Failed :: "<<TestFunc::getName()<<ELog::endCrit;
+  else if (type && extra)
+    std::cout<<"All tests passed"<<std::endl;
+  return (exitFlag) ? 1 : 0;
+}
@@ -106,6 +106,8 @@ class Material
   void setENDF7();
   void setDensity(const double);
   bool hasZaid(const int,const int,const char) const;
+  /// Number of zaid components
+  size_t nZaid() const { return zaidVec.size(); }
 
   /// remove mt cards
   void removeSQW() { SQW.clear(); }
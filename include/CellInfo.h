@@ -44,6 +44,7 @@ struct CellInfo
   virtual ~CellInfo();
 
   void addCell(const int,const double);
+  double totalVolume() const;
 };
  
 #endif
@@ -22,6 +22,8 @@
 #ifndef Control_h
 #define Control_h
 
+class cellRunner;
+
 /*!
   \class Control
   \brief General information from file
@@ -34,6 +36,13 @@ class Control
 {
  private:
 
+  friend class shardPlan;
+  friend class cellDedup;
+  friend class normSweep;
+  friend class uqSampler;
+  friend class runPlan;
+  friend class shardMerge;
+
   std::string libraryPath;               ///< Path to main library
   std::string matFile;                   ///< Material info file
 
@@ -41,7 +50,34 @@ class Control
   std::vector<std::string> mcnpHFiles;   ///< MCNP htape files
   
   std::string outDirBase;         ///< Output directory header
-
+  size_t nWorkers;                ///< Number of parallel cells [0 : cores]
+  std::string cacheDir;           ///< Result cache directory [empty : none]
+  size_t cacheSize;               ///< Max result cache size [MB / 0 : no limit]
+  std::string journalFile;        ///< Run journal file
+  std::string manifestFile;       ///< Job manifest file [plan mode]
+  std::string dedupFile;          ///< Map of cells to the cell run for them
+  std::string scratchDir;         ///< Node local run root [empty : none]
+  size_t scratchCells;            ///< Max cells on scratch [0 : 2*workers]
+  double wallLimit;               ///< Wall time of a cell run [sec / 0 : none]
+  double cpuLimit;                ///< CPU time of CINDER/TABCODE [sec / 0 : none]
+  double memLimit;                ///< Memory of CINDER/TABCODE [MB / 0 : none]
+  size_t maxRetry;                ///< Re-runs of a failed cell
+  double retryDelay;              ///< Delay of the first re-run [sec]
+  bool resumeFlag;                ///< Skip cells completed in the journal
+  bool dedupFlag;                 ///< Run identical cell problems once
+  bool groupFlag;                 ///< Run each cell_list name as one problem
+  std::string groupFile;          ///< Map of the cell groups
+  double fluxTol;                 ///< Min integral flux of a cell to run
+  double clusterTol;              ///< Error bound of approximate reuse [0 : off]
+  std::vector<double> sweepScale; ///< Normalisation factors to sweep
+  double burnXS;                  ///< Bounding cross section [barn]
+  double burnTol;                 ///< Max burn-up fraction for scaling
+  size_t sweepCheck;              ///< Bounded cells run as a sweep check
+  size_t uqSamples;               ///< UQ samples per cell [0 : no UQ]
+  size_t uqSeed;                  ///< Seed of the UQ sample streams
+  std::vector<std::string> uqFiles;  ///< Outputs reduced over the samples
+  size_t shardIndex;              ///< Shard to run [0 to nShard-1]
+  size_t nShard;                  ///< Number of shards [0 : not sharded]
   
   cinderOption COpt;              ///< Cinder options
   double htapeNorm;               ///< htape normalization [if different]
@@ -52,7 +88,7 @@ class Control
   std::map<int,int> MatNumber;          ///< Cell materials
 
   std::map<int,int> CellReMap;          ///< Decide if cell needs remapping
-  cinderHistory history;                ///< history set
+  scenarioSet Histories;                ///< Main and named histories
 
   htapeProcess HT;                      ///< Htape (spallation)
   tallyProcess fluxes;                  ///< Neutron fluxes [input]
@@ -65,13 +101,21 @@ class Control
   void setBaseName(const std::string&);
   void procFiles(const std::string&,std::string);
   void procNormalization(const std::string&,std::string);
+  void procRunOptions(const std::string&,std::string);
   void procCellList(const std::string&,std::string);    
   void procCellReMap(const std::string&,std::string);
   
   std::string getOutDir(const int) const;
+  void setRunner(cellRunner&) const;
+  std::string writeCellInput(const int,const double) const;
+  void writeDeckBase(const std::string&,const int,const double) const;
+  void writeDecks(const std::vector<int>&) const;
+  void writeCellInput(const std::string&,const int,
+		      const double,const double,const std::string&) const;
   
   void writeLibrary(const std::string&) const;
-  void writeInput(const std::string&,const int,const double) const;
+  void writeInput(const std::string&,const int,const double,
+		  const double,const std::string&) const;
   void addTallyCells(const std::string&,const int);
   
  public:
@@ -82,12 +126,17 @@ class Control
   virtual ~Control();
 
   int getCellMat(const int) const;
+  void setWorkers(const size_t);
+  void setResume(const bool);
+  void setShard(const std::string&);
   
   void readControlFile(const std::string&);
   void runHTape();
   void readFluxes();
+  void pruneCells();
   void readMaterials();
-  void writeCinderInput() const;
+  void groupCells();
+  int writeCinderInput() const;
   
 };
  
@@ -0,0 +1,67 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/cellDedup.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef cellDedup_h
+#define cellDedup_h
+
+class Control;
+
+/*!
+  \class cellDedup
+  \brief Exact and approximate reuse of cell problems
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Cells with the same CINDER deck are run once. With a
+  cluster tolerance, cells of the same material whose flux
+  spectrum and spallation production are within the
+  tolerance of a run cell take its results scaled by the
+  flux ratio and the volume ratio.
+*/
+
+class cellDedup
+{
+ private:
+
+  const Control& Ctrl;          ///< Problem and run options
+
+  ///\cond SINGLETON
+  cellDedup(const cellDedup&);
+  cellDedup& operator=(const cellDedup&);
+  ///\endcond SINGLETON
+
+  std::string problemString(const int,const double) const;
+  double spectralBound(const int,const int,const double) const;
+
+ public:
+
+  explicit cellDedup(const Control&);
+  ~cellDedup();
+
+  std::map<int,int> dedupCells(const std::vector<int>&) const;
+  std::map<int,std::pair<double,double>>
+    clusterCells(const std::vector<int>&,std::map<int,int>&) const;
+  void writeSourceMap(const size_t,const std::map<int,int>&,
+		      const std::map<int,std::pair<double,double>>&) const;
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/cellJob.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef cellJob_h
+#define cellJob_h
+
+/*!
+  \struct cellJob
+  \brief Single cell CINDER/TABCODE run
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+*/
+
+struct cellJob
+{
+  int cellN;                 ///< Cell number
+  std::string group;         ///< Named history [empty : main history]
+  std::string dirName;       ///< Cell directory
+  std::string runDir;        ///< Directory the programs run in [scratch]
+  double volume;             ///< Cell volume
+  size_t logIndex;           ///< Index for log files
+
+  size_t stage;              ///< 0 : waiting [deck] / 1 : CINDER / 2 : TABCODE / 3 : copy back / 4 : collect / 5 : done
+  pid_t pid;                 ///< Active process [0 if not running]
+  /// Status flag [-1 not run / 0 good / or of : 1 CINDER exit
+  /// 2 TABCODE exit / 4 directory / 8 missing output / 16 copy back
+  /// 32 time limit / 64 stopped by signal]
+  int status;
+  size_t nTry;               ///< Number of times the run was started
+  int cinderExit;            ///< CINDER exit code [-1 not run]
+  int tabcodeExit;           ///< TABCODE exit code [-1 not run]
+  double startTime;          ///< Start time [sec from run start]
+  double endTime;            ///< End time [sec from run start]
+  std::string hashKey;       ///< Cache key of the inputs [empty : none]
+  bool cacheHit;             ///< Results restored from the cache
+  bool resumed;              ///< Completed in a previous run [journal]
+  int sourceCell;            ///< Results copied from this cell [0 : run]
+  double fluxScale;          ///< Flux of cell / flux of source cell
+  double errorBound;         ///< Relative error bound of the copy
+
+  cellJob(const int,const std::string&,const double,const size_t);
+  cellJob(const cellJob&);
+  cellJob& operator=(const cellJob&);
+  virtual ~cellJob();
+
+  static const std::vector<std::string>& expectedOutputs();
+  std::string cinderLog() const;
+  std::string tabcodeLog() const;
+  bool isScaled() const;
+  std::string statusString() const;
+  /// Run time
+  double runTime() const { return endTime-startTime; }
+};
+
+#endif
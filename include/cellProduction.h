@@ -22,6 +22,8 @@
 #ifndef cellProduction_h
 #define cellProduction_h
 
+class MTRand;
+
 /*!
   \class cellProduction
   \brief Contains production information for each cell
@@ -54,10 +56,15 @@ class cellProduction
   cellProduction& operator=(const cellProduction&);
   virtual ~cellProduction();
 
+  cellProduction& operator+=(const cellProduction&);
   cellProduction& scale(const double);
+  cellProduction& sample(MTRand&);
   cellProduction& addComponent(const cellProduction&,
 			       const long int,const long int);
   DError::doubleErr getTotal() const;
+  std::map<int,double> getSprods() const;
+  /// Number of nuclides produced/destroyed
+  size_t nNuclide() const { return elmTotal.size(); }
   
   void cellIndexProd(const size_t,const int,const int,const int,
 		     const double&,const double&);
@@ -0,0 +1,185 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/cellRunner.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef cellRunner_h
+#define cellRunner_h
+
+struct cellJob;
+class resultCache;
+class runJournal;
+
+/*!
+  \class cellRunner
+  \brief Runs CINDER/TABCODE for a set of cells on N workers
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Each cell runs CINDER then TABCODE as child processes
+  started in the cell directory, so the cwd of the main
+  process is never altered. Up to nWorkers cells are in
+  flight at once. If a result cache is set, cells with
+  unchanged inputs are restored from it and not run.
+  Finished cells are recorded in the journal [if set].
+
+  The jobs go through three queued stages : the input deck
+  is written [Pending], the children are run [Ready/Active]
+  and the outputs are verified and collected [Collect].
+  Decks are written [and staged in] by forked children, so
+  deck writing overlaps launching and collection. Up to
+  nWorkers decks are ready or being written.
+
+  If a scratch root is set each cell is run in a copy of
+  its directory under the scratch root. The result files
+  are copied back by a child process [not counted as a
+  worker] and at most maxStaged cells are on scratch.
+
+  Cells with the same problem as another cell are added as
+  copies : they are not run and get the result files of
+  their source cell when it is collected. The tables of an
+  approximate copy are scaled by its flux scale.
+
+  A run over the wall time limit is killed. Runs that fail
+  [exit code, time limit, missing outputs] are re-run up to
+  maxRetry times, the delay doubling each time. On SIGINT
+  no more cells are started and the running cells finish;
+  a second SIGINT [or SIGTERM] kills them. Cells that are
+  not finished are not journalled, so a resumed run does them.
+*/
+
+class cellRunner
+{
+ private:
+
+  size_t nWorkers;                 ///< Max number of workers
+  std::chrono::steady_clock::time_point startClock;  ///< Reference time
+
+  std::vector<cellJob> Jobs;       ///< Submitted jobs
+  std::deque<size_t> Pending;      ///< Jobs waiting for the deck
+  std::deque<size_t> Ready;        ///< Jobs with deck written
+  std::map<pid_t,size_t> Active;   ///< Active pid : Jobs index
+  std::deque<size_t> Collect;      ///< Jobs to verify/collect
+  /// (Group,source cell) : Jobs index of copy
+  std::multimap<std::pair<std::string,int>,size_t> Copies;
+  std::multimap<double,size_t> Delayed;  ///< Retry time : Jobs index
+  size_t nCopy;                    ///< Active copy back children
+  size_t nDeck;                    ///< Active deck writing children
+
+  double wallLimit;                ///< Wall time of a run [sec / 0 : none]
+  size_t maxRetry;                 ///< Max re-runs of a failed job
+  double retryDelay;               ///< Delay of the first re-run [sec]
+  int stopLevel;                   ///< Stop requested [runProgs::stopLevel]
+  double killTime;                 ///< Time the running jobs were killed
+
+  /// Input deck writer [empty : deck already written]
+  std::function<void(const cellJob&)> Writer;
+  /// Called with each collected job [empty : none]
+  std::function<void(const cellJob&)> Collector;
+  resultCache* Cache;              ///< Result cache [not owned / 0 : none]
+  /// Run journal of each group [not owned]
+  std::map<std::string,runJournal*> Journals;
+
+  std::string scratchRoot;         ///< Scratch directory [empty : none]
+  size_t maxStaged;                ///< Max cells on scratch
+  size_t nStaged;                  ///< Cells on scratch
+
+  ///\cond SINGLETON
+  cellRunner(const cellRunner&);
+  cellRunner& operator=(const cellRunner&);
+  ///\endcond SINGLETON
+
+  double getTime() const;
+  runJournal* getJournal(const cellJob&) const;
+  bool canLaunch(const cellJob&) const;
+  std::string scratchDir(const cellJob&) const;
+  bool stageIn(cellJob&);
+  void unStage(cellJob&);
+  void prepare(const size_t);
+  void copyBack(const size_t);
+  void launch(const size_t);
+  void advance(const size_t,const int);
+  void finish(const size_t);
+  void collect(const size_t);
+  void fanOut(const size_t);
+  bool retryJob(const size_t);
+  void checkStop();
+  void checkLimits();
+  double nextEvent() const;
+  bool reapJob(const bool,const double);
+
+ public:
+
+  cellRunner(const size_t);
+  ~cellRunner();
+
+  static size_t defaultWorkers();
+  static bool isTable(const std::string&);
+  static bool tableNumber(const std::string&,double&,size_t&);
+  static bool timeColumns(const std::string&,std::vector<size_t>&);
+  static std::string scaleItem(const std::string&,const double,
+			       const size_t);
+  static std::string scaleLine(const std::string&,const double,
+			       const std::vector<size_t>&);
+  static void scaleTable(const boost::filesystem::path&,
+			 const boost::filesystem::path&,const double);
+  static void scaleStats(const boost::filesystem::path&,
+			 const boost::filesystem::path&,
+			 const boost::filesystem::path&,const double);
+  static bool tableValues(const boost::filesystem::path&,
+			  std::vector<double>&);
+  static double tableDeviation(const std::string&,const std::string&,
+			       const double);
+  static double tableScale(const cellJob&,const cellJob&);
+  static bool copyResults(const cellJob&,const cellJob&);
+
+  /// Set the result cache [0 to disable]
+  void setCache(resultCache* RC) { Cache=RC; }
+  /// Set the run journal of the main history [0 to disable]
+  void setJournal(runJournal* JR) { Journals[""]=JR; }
+  /// Set the run journal of a group [0 to disable]
+  void setJournal(const std::string& G,runJournal* JR) { Journals[G]=JR; }
+  void setScratch(const std::string&,const size_t);
+  /// Set the wall time limit of a run [0 : none]
+  void setTimeLimit(const double T) { wallLimit=T; }
+  void setRetry(const size_t,const double);
+  /// Set the input deck writer
+  void setWriter(const std::function<void(const cellJob&)>& W)
+    { Writer=W; }
+  /// Set the function called with each collected job
+  void setCollector(const std::function<void(const cellJob&)>& C)
+    { Collector=C; }
+
+  void addJob(const cellJob&);
+  void addCopy(const cellJob&,const int);
+  void waitAll();
+
+  /// Number of workers
+  size_t getWorkers() const { return nWorkers; }
+  /// Stop requested while running [0 : none]
+  int getStopLevel() const { return stopLevel; }
+  /// Access the jobs
+  const std::vector<cellJob>& getJobs() const { return Jobs; }
+  size_t nFailed() const;
+  void writeStatus(std::ostream&) const;
+
+};
+
+#endif
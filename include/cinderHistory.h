@@ -49,6 +49,9 @@ class cinderHistory
   virtual ~cinderHistory();
 
   void addLine(const std::string&,std::string);  
+  /// Number of time steps
+  size_t nSteps() const { return time.size(); }
+  double irradiation() const;
   void write(std::ostream&) const;
 
 };
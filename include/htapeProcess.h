@@ -23,6 +23,8 @@
 #define htapeProcess_h
 
 class cellProduction;
+class htapeSection;
+class htapeStream;
 
 /*!
   \class htapeProcess
@@ -42,15 +44,37 @@ class htapeProcess
   long int nps;     ///< number of points for cell production
   CTYPE cellProd;   ///< Cells  [master production]
 
-  
-  static void readZaid(const size_t,cellProduction&,std::istream&);
+  size_t nWorkers;          ///< Number of htape passes/read threads
+  std::string scratchDir;   ///< Scratch directory for htape runs
+
+  size_t maxCells;          ///< Max cells per htape run [0 : no limit]
+  double scanRate;          ///< Estimated histp read rate [bytes/sec]
+  double cellTime;          ///< Estimated time per cell per pass [sec]
+  bool streamFlag;          ///< Read htape tables from fifos
 
-  long int readHeader(const size_t prodType,std::istream&,
-		      CTYPE&) const;
-  void processHTape(const std::map<int,double>&);
-  long int procProduction(CTYPE&);
-  void procGas(CTYPE&);
-  void procDestruction(CTYPE&);
+  
+  static void scanTape(const std::string*,const bool,
+		       std::vector<htapeSection>*,long int*);
+  static void readBlock(const std::vector<std::string>*,
+			std::vector<std::vector<htapeSection>>*,
+			const size_t,const size_t);
+  void readTapes(const std::vector<std::string>&,
+		 std::vector<std::vector<htapeSection>>&,
+		 std::vector<long int>&) const;
+  void addSections(const size_t,const std::vector<htapeSection>&,
+		   const long int,CTYPE&) const;
+  static int openStream(const std::string&);
+  static int readStream(const int,htapeStream&);
+  static bool pollStreams(std::map<size_t,int>&,
+			  std::map<size_t,htapeStream>&);
+  static std::string passDir(const std::string&,const size_t);
+  double predictTime(const size_t,const size_t,const double) const;
+  size_t planBatches(const size_t,const double) const;
+  void updateModel(const std::vector<double>&,
+		   const std::vector<size_t>&,const double);
+  void processHTape(const std::string&,const std::map<int,double>&);
+  long int procTapes(const std::string&,const size_t,
+		     const std::map<size_t,htapeStream>&,CTYPE&) const;
 
   cellProduction* findCellProd(const int);
   cellProduction* findCellProd(CTYPE&,const int) const;
@@ -65,12 +89,25 @@ class htapeProcess
   htapeProcess& operator=(const htapeProcess&);
   virtual ~htapeProcess();
 
+  static std::vector<htapeSection>
+    findSections(std::istream&,const bool,long int&);
 
+  void setWorkers(const size_t);
+  void setMaxCells(const size_t);
+  void setStream(const bool);
+  void setScratch(const std::string&);
   void scale(const double);
+  void mergeCells(const int,const std::vector<int>&);
   void addSProdFile(const std::string&,
 		const std::map<int,double>&);
 
+  size_t nProducts(const int) const;
+  const cellProduction& getCellProd(const int) const;
+  std::map<int,double> getSprods(const int) const;
   void writeSprods(const std::string&,const int,const double) const;
+  void writeSprods(std::ostream&,const int,const double) const;
+  static void writeSprods(std::ostream&,const int,const double,
+			  const cellProduction&);
   void write(std::ostream&) const;
   
 };
@@ -0,0 +1,52 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/htapeScan.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef htapeScan_h
+#define htapeScan_h
+
+/*!
+  \namespace htapeScan
+  \brief Line scanners for the htape output tables
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  The patterns used to read the outt08/14/15 files. Those
+  that are only tested a few times per file are kept as
+  regular expressions compiled once. The lines that are
+  tested on every line of the file [case/cell headers and
+  the production rows] are matched by hand with the same
+  rules as the original expressions.
+*/
+
+namespace htapeScan
+{
+  const std::regex& npsRegex();
+  const std::regex& hydrogenRegex();
+  const std::regex& heliumRegex();
+
+  int caseLine(const std::string&,int&);
+  int cellLine(const std::string&,int&);
+  int zaidLine(const std::string&,int&,int&,
+	       std::string&,std::string&);
+}
+
+#endif
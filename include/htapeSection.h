@@ -0,0 +1,97 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/htapeSection.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef htapeSection_h
+#define htapeSection_h
+
+class cellProduction;
+
+/*!
+  \class htapeSection
+  \brief One cell section of an htape output file
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Holds the byte range of a "for cell:" block and the
+  production rows read from it. The read methods do not
+  use ELog [not thread safe] so that sections can be read
+  on separate threads. The rows are added to a
+  cellProduction afterwards on the main thread.
+  The lines can also be given one at a time [htapeStream].
+*/
+
+class htapeSection
+{
+ private:
+
+  /// Production row [z,n,value,relative error]
+  struct prodItem
+  {
+    int z;             ///< Atomic number
+    int n;             ///< Neutron number
+    double frac;       ///< Production
+    double fracErr;    ///< Relative error
+  };
+
+  int cellNum;                         ///< Cell number
+  std::streamoff startPos;             ///< First line after cell header
+  std::streamoff endPos;               ///< End of section [-1 : EOF]
+  size_t status;                       ///< Gas read state [0 complete]
+  int zNum;                            ///< Current atomic number
+
+  std::vector<prodItem> Items;         ///< Production rows
+  std::vector<std::string> BadLines;   ///< Unexpected lines
+
+  void addItem(const int,const int,const double,const double);
+
+ public:
+
+  htapeSection(const int,const std::streamoff);
+  htapeSection(const htapeSection&);
+  htapeSection& operator=(const htapeSection&);
+  ~htapeSection();
+
+  static int readLine(std::istream&,std::streamoff&,std::string&);
+
+  /// Set the end of the section
+  void setEnd(const std::streamoff P) { endPos=P; }
+  /// Has the end been set
+  bool hasEnd() const { return endPos>=0; }
+  /// Cell number
+  int getCell() const { return cellNum; }
+  /// Gas read state
+  size_t getStatus() const { return status; }
+  /// Lines not understood
+  const std::vector<std::string>& getBadLines() const
+    { return BadLines; }
+
+  /// Start a gas table [given line by line]
+  void startGas() { status=2; }
+  int zaidLine(const std::string&);
+  int gasLine(std::string);
+  void readZaid(std::istream&);
+  void readGas(std::istream&);
+  void addProd(const size_t,cellProduction&) const;
+
+};
+
+#endif
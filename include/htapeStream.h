@@ -0,0 +1,75 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/htapeStream.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef htapeStream_h
+#define htapeStream_h
+
+class htapeSection;
+
+/*!
+  \class htapeStream
+  \brief Incremental reader of an htape output table
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Takes the htape output in blocks as it arrives [e.g. from
+  a fifo while htape is running] and splits it into lines.
+  The headers are followed with the same states as
+  htapeProcess::findSections and the rows of each cell are
+  read into an htapeSection as they arrive.
+*/
+
+class htapeStream
+{
+ private:
+
+  bool prodFlag;                    ///< Production table [outt08/outt15]
+  size_t statusFlag;                ///< Header state
+  long int npsFile;                 ///< Number of histories
+  size_t nByte;                     ///< Bytes read
+
+  std::string Partial;              ///< Incomplete last line
+  std::vector<htapeSection> Sect;   ///< Cell sections
+
+  void addLine(std::string);
+
+ public:
+
+  htapeStream(const bool);
+  htapeStream(const htapeStream&);
+  htapeStream& operator=(const htapeStream&);
+  ~htapeStream();
+
+  void addData(const char*,const size_t);
+  void finish();
+
+  /// Number of histories
+  long int getNPS() const { return npsFile; }
+  /// Bytes read
+  size_t getNByte() const { return nByte; }
+  /// Sections read
+  const std::vector<htapeSection>& getSections() const
+    { return Sect; }
+
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/mappedFile.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef mappedFile_h
+#define mappedFile_h
+
+/*!
+  \class mappedFile
+  \brief Read only memory map of a text file
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Maps a [large] output file so that it can be searched
+  in place. Lines are found with memchr/memmem, which the C
+  library vectorises, and are given as [start,end) pointers
+  so no strings are built. If the file cannot be mapped
+  [e.g. a pipe] it is read into memory instead.
+  The map is not copied.
+*/
+
+class mappedFile
+{
+ private:
+
+  std::string FName;          ///< File name
+  const char* dataPtr;        ///< Start of data
+  size_t dataSize;            ///< Size of data [bytes]
+  bool mapFlag;               ///< Data is mapped [not in Buffer]
+  std::vector<char> Buffer;   ///< Data if not mapped
+
+  mappedFile(const mappedFile&);
+  mappedFile& operator=(const mappedFile&);
+
+ public:
+
+  mappedFile(const std::string&);
+  ~mappedFile();
+
+  /// Start of data
+  const char* begin() const { return dataPtr; }
+  /// End of data
+  const char* end() const { return dataPtr+dataSize; }
+  /// Size of data
+  size_t size() const { return dataSize; }
+  /// Data is memory mapped
+  bool isMapped() const { return mapFlag; }
+
+  static const char* lineEnd(const char*,const char*);
+  static const char* nextLine(const char*,const char*);
+  static const char* findLine(const char*,const char*,
+			      const char*,const size_t);
+  static bool hasText(const char*,const char*,
+		      const char*,const size_t);
+};
+
+#endif
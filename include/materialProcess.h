@@ -56,6 +56,8 @@ class materialProcess
 
   void readMCNP(const std::string&,std::map<int,int>&);
 
+  size_t nComponents(const int) const;
+  int mixMaterials(const std::vector<int>&,const std::vector<double>&);
   void writeMaterials(const std::string&) const;
   void write(std::ostream&) const;
   
@@ -0,0 +1,70 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/normSweep.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef normSweep_h
+#define normSweep_h
+
+class Control;
+class cellRunner;
+class resultCache;
+struct cellJob;
+
+/*!
+  \class normSweep
+  \brief Source normalisation sweep of the cell runs
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Each good cell of the base run is run again at each
+  factor of sweepScale if the burn-up bound does not show
+  it is linear in the source. The other cells are scaled
+  from the base results after a spot check of a few.
+*/
+
+class normSweep
+{
+ private:
+
+  typedef std::pair<std::string,int> GCell;       ///< (group,cell)
+  typedef std::map<GCell,const cellJob*> JMAP;    ///< Jobs of cells
+
+  const Control& Ctrl;          ///< Problem and run options
+
+  ///\cond SINGLETON
+  normSweep(const normSweep&);
+  normSweep& operator=(const normSweep&);
+  ///\endcond SINGLETON
+
+  double burnupBound(const int,const double,const std::string&) const;
+  size_t runFactor(const size_t,const JMAP&,const JMAP&,
+		   const std::map<GCell,double>&,resultCache*,
+		   std::vector<cellJob>&) const;
+
+ public:
+
+  explicit normSweep(const Control&);
+  ~normSweep();
+
+  size_t run(const cellRunner&,resultCache*) const;
+};
+
+#endif
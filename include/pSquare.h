@@ -0,0 +1,65 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/pSquare.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef pSquare_h
+#define pSquare_h
+
+/*!
+  \class pSquare
+  \brief Streaming quantile estimate [P-square algorithm]
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Jain and Chlamtac P^2 estimate of a quantile : five
+  markers are kept so the values need not be stored.
+  Exact for fewer than five values.
+*/
+
+class pSquare
+{
+ private:
+
+  double prob;          ///< Quantile [0-1]
+  size_t nCount;        ///< Number of values
+  double Q[5];          ///< Marker heights
+  double Pos[5];        ///< Marker positions
+  double DPos[5];       ///< Desired marker positions
+  double DInc[5];       ///< Increment of desired positions
+
+  double parabolic(const size_t,const double) const;
+  double linear(const size_t,const double) const;
+
+ public:
+
+  pSquare(const double);
+  pSquare(const pSquare&);
+  pSquare& operator=(const pSquare&);
+  ~pSquare();
+
+  void addValue(const double);
+  double getValue() const;
+  /// Number of values
+  size_t getCount() const { return nCount; }
+
+};
+
+#endif
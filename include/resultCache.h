@@ -0,0 +1,84 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/resultCache.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef resultCache_h
+#define resultCache_h
+
+/*!
+  \class resultCache
+  \brief Cache of CINDER/TABCODE results keyed on the input files
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Each entry is a directory [cacheDir/hash] holding the output
+  files of a cell run. The hash is the MD5 of the generated
+  input files (input/fluxes/splprods/material/locate).
+  The index file records the size and last use of each entry
+  and is used to evict the oldest entries when over maxSize.
+  Runs sharing a cache merge their index under a file lock.
+*/
+
+class resultCache
+{
+ private:
+
+  /// Index type [hash : (size,last use)]
+  typedef std::map<std::string,std::pair<size_t,long int>> ITYPE;
+
+  std::string cacheDir;          ///< Cache directory
+  size_t maxSize;                ///< Max cache size [bytes / 0 : no limit]
+
+  ITYPE Index;                   ///< Entries
+  std::set<std::string> Removed; ///< Entries removed by this run
+  size_t nHit;                   ///< Number of cache hits
+  size_t nMiss;                  ///< Number of cache misses
+  std::string tmpExt;            ///< Temporary extension [.tmpPID]
+
+  std::string indexFile() const;
+  void readIndex(ITYPE&) const;
+  void mergeIndex();
+  void writeIndex() const;
+  void evict();
+
+ public:
+
+  resultCache(const std::string&,const size_t);
+  resultCache(const resultCache&);
+  resultCache& operator=(const resultCache&);
+  ~resultCache();
+
+  static const std::vector<std::string>& inputFiles();
+  static const std::vector<std::string>& runFiles();
+  static bool isResult(const std::string&);
+  static std::string fileHash(const std::string&);
+  static void copyFile(const boost::filesystem::path&,
+		       const boost::filesystem::path&);
+  static std::string problemKey(const std::string&);
+
+  bool restore(const std::string&,const std::string&);
+  void store(const std::string&,const std::string&);
+  void flush();
+
+  void write(std::ostream&) const;
+};
+
+#endif
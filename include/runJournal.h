@@ -0,0 +1,96 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/runJournal.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef runJournal_h
+#define runJournal_h
+
+struct cellJob;
+
+/*!
+  \class runJournal
+  \brief Append-only record of finished cell runs
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  One line is appended per finished cell with a single
+  write() on an O_APPEND descriptor, so several processes
+  can share a journal and a crash leaves at most one torn
+  line (which is ignored on reading and ended on resume). On resume the last
+  good record of a cell is accepted if the inputs have the
+  same key and the outputs still have the recorded hashes.
+  Comment lines [#] hold the shard spec and planned cells
+  of a sharded run.
+*/
+
+class runJournal
+{
+ private:
+
+  /// Output file : hash
+  typedef std::map<std::string,std::string> HTYPE;
+  /// Cell : (input key, outputs)
+  typedef std::map<int,std::pair<std::string,HTYPE>> DTYPE;
+
+  std::string fileName;          ///< Journal file
+  int fd;                        ///< File descriptor for append
+  DTYPE Done;                    ///< Completed cells from the journal
+  std::map<int,std::string> Records;  ///< Last good record of done cells
+
+  size_t shardIndex;             ///< Shard index [from journal]
+  size_t nShard;                 ///< Number of shards [0 : not sharded]
+  std::vector<int> Planned;      ///< Cells planned for the shard
+
+  ///\cond SINGLETON
+  runJournal(const runJournal&);
+  runJournal& operator=(const runJournal&);
+  ///\endcond SINGLETON
+
+  void readJournal();
+  void writeLine(const std::string&);
+  bool checkOutputs(const int,const std::string&) const;
+  static HTYPE outputHashes(const std::string&);
+
+ public:
+
+  explicit runJournal(const std::string&);
+  runJournal(const std::string&,const bool,const bool =1);
+  ~runJournal();
+
+  static std::map<int,double> readTimes(const std::string&);
+
+  /// Number of completed cells read from the journal
+  size_t nDone() const { return Done.size(); }
+  bool isComplete(const cellJob&) const;
+  bool isComplete(const int) const;
+  const std::string& getRecord(const int) const;
+
+  /// Planned cells of the shard
+  const std::vector<int>& getPlanned() const { return Planned; }
+  bool getShard(size_t&,size_t&) const;
+
+  void record(const cellJob&);
+  void append(const std::string&);
+  void writeShard(const size_t,const size_t,const std::vector<int>&);
+
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/runPlan.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef runPlan_h
+#define runPlan_h
+
+class Control;
+
+/*!
+  \class runPlan
+  \brief Plan mode : manifest of cell jobs run one at a time
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Writes the deck of each cell and a manifest of the jobs
+  so that a batch system can run each job [runCell]
+  as a separate process.
+*/
+
+class runPlan
+{
+ private:
+
+  const Control& Ctrl;          ///< Problem and run options
+
+  ///\cond SINGLETON
+  runPlan(const runPlan&);
+  runPlan& operator=(const runPlan&);
+  ///\endcond SINGLETON
+
+
+ public:
+
+  explicit runPlan(const Control&);
+  ~runPlan();
+
+  void writePlan() const;
+  int runCell(const size_t) const;
+};
+
+#endif
@@ -22,6 +22,22 @@
 #ifndef runProgs_h
 #define runProgs_h
 
+/*!
+  \class runProgs
+  \brief Starts and tracks the external programs
+  \version 1.1
+  \date October 2016
+  \author S. Ansell
+
+  Children are started with fork/exec in an explicit working
+  directory and environment with stdout/stderr sent to files
+  [or stdout to a pipe]. Only the
+  registered children are collected, so that many can be
+  in flight at once. Job children [CINDER/TABCODE] run in
+  their own process group under the CPU/memory limits.
+  A task child runs a function of this program [startTask].
+*/
+
 class runProgs
 {
  private:
@@ -30,9 +46,24 @@ class runProgs
   std::string htapeCMD;             ///< HTape command/path
   std::string tabcodeCMD;           ///< tabcode command/path
 
+  double cpuLimit;                  ///< CPU limit of jobs [sec / 0 : none]
+  double memLimit;                  ///< Memory limit of jobs [MB / 0 : none]
+
+  std::map<std::string,std::string> envExtra;  ///< Environment of all children
+  std::set<pid_t> activePID;        ///< Running children
+  std::map<pid_t,int> donePID;      ///< Finished children : exit code
+
   runProgs();  
 
-  int runCode(const std::string&);
+  static std::string findExe(const std::string&);
+  std::vector<std::string>
+    buildEnv(const std::map<std::string,std::string>&) const;
+  pid_t forkExec(const std::string&,const std::string&,
+		 const std::string&,const std::string&,
+		 const std::string&,const std::map<std::string,std::string>&,
+		 int*,const int);
+  static int exitCode(const int);
+  bool pollChildren();
   
  public:
  
@@ -42,11 +73,37 @@ class runProgs
   void setHTapeEXE(const std::string&);
   void setCinderEXE(const std::string&);
   void setTabcodeEXE(const std::string&);
-  
-  int runHTape(const std::string&,const std::string&);
-  int runCinder(const std::string&,const std::string&);
-  int runTabCode(const std::string&,const std::string&);
-  
+  void setEnv(const std::string&,const std::string&);
+  void setLimits(const double,const double);
+  void catchSignals(const bool);
+  static int stopLevel();
+  /// Htape command
+  const std::string& getHTapeEXE() const { return htapeCMD; }
+  /// Cinder command
+  const std::string& getCinderEXE() const { return cinderCMD; }
+  /// Tabcode command
+  const std::string& getTabcodeEXE() const { return tabcodeCMD; }
+
+  pid_t startCode(const std::string&,const std::string&,
+		  const std::string&,const std::string&,const std::string&,
+		  const std::map<std::string,std::string>&);
+  pid_t startPipe(const std::string&,const std::string&,
+		  const std::string&,const std::string&,
+		  const std::map<std::string,std::string>&,int&);
+  pid_t startJob(const std::string&,const std::string&,
+		 const std::string&,const std::string&,const bool);
+  pid_t startTask(const std::function<int()>&);
+  pid_t startHTape(const std::string&,const std::string&,
+		   const std::string&);
+  pid_t startCinder(const std::string&,const std::string&);
+  pid_t startTabCode(const std::string&,const std::string&);
+
+  /// Number of running children
+  size_t nActive() const { return activePID.size(); }
+  bool reapChildren(const bool,const double);
+  void killChild(const pid_t,const int) const;
+  int checkChild(const pid_t,int&);
+
 };
  
 #endif
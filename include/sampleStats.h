@@ -0,0 +1,76 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/sampleStats.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef sampleStats_h
+#define sampleStats_h
+
+class pSquare;
+
+/*!
+  \class sampleStats
+  \brief Streaming statistics of the numbers in an output file
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  The first sample file is the template. Each number in it
+  [e.g. nuclide x time step of a TABCODE table] has a running
+  mean/variance and 5/50/95% quantile estimate, updated as
+  each sample file is added, so the samples need not be kept.
+  The results are written as copies of the template with
+  the numbers replaced [.mean/.std/.p05/.p50/.p95].
+*/
+
+class sampleStats
+{
+ private:
+
+  /// Spans of the numbers in a line [start,length]
+  typedef std::vector<std::pair<size_t,size_t>> STYPE;
+
+  std::vector<std::string> Lines;  ///< Template lines
+  std::vector<STYPE> Spans;        ///< Numbers in each line
+  size_t nSample;                  ///< Samples added
+
+  std::vector<double> Mean;        ///< Running mean
+  std::vector<double> M2;          ///< Running sum of square differences
+  std::vector<pSquare> QLow;       ///< 5% quantile
+  std::vector<pSquare> QMid;       ///< 50% quantile
+  std::vector<pSquare> QHigh;      ///< 95% quantile
+
+  static void splitLine(const std::string&,STYPE&,std::vector<double>&);
+  void writeFile(const std::string&,const std::vector<double>&) const;
+
+ public:
+
+  sampleStats();
+  sampleStats(const sampleStats&);
+  sampleStats& operator=(const sampleStats&);
+  ~sampleStats();
+
+  bool addFile(const std::string&);
+  /// Number of samples added
+  size_t getCount() const { return nSample; }
+  void write(const std::string&) const;
+
+};
+
+#endif
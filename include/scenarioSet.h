@@ -0,0 +1,65 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/scenarioSet.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef scenarioSet_h
+#define scenarioSet_h
+
+/*!
+  \class scenarioSet
+  \brief Main and named irradiation histories
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Each history is a group of cell jobs. The main history
+  is the empty group and runs in the main directories.
+  A named history [scenario] runs in its own subtree :
+  the scenario name is put before the last component of
+  the directory/journal paths.
+*/
+
+class scenarioSet
+{
+ private:
+
+  cinderHistory mainHistory;                      ///< Main history
+  std::map<std::string,cinderHistory> Scenarios;  ///< Named histories
+
+ public:
+
+  scenarioSet();
+  scenarioSet(const scenarioSet&);
+  scenarioSet& operator=(const scenarioSet&);
+  ~scenarioSet();
+
+  static std::string scenarioPath(const std::string&,const std::string&);
+
+  void addLine(const std::string&,const std::string&,std::string);
+  /// Main history
+  const cinderHistory& getMain() const { return mainHistory; }
+  /// Has named histories
+  bool hasScenarios() const { return !Scenarios.empty(); }
+  const cinderHistory& getHistory(const std::string&) const;
+  std::vector<std::string> getGroups() const;
+  std::string groupPath(const std::string&,const std::string&) const;
+};
+
+#endif
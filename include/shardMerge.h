@@ -0,0 +1,60 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/shardMerge.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef shardMerge_h
+#define shardMerge_h
+
+class Control;
+
+/*!
+  \class shardMerge
+  \brief Merge of the journals of a sharded run
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Checks that every cell planned for each shard has a
+  good record and appends the records to the journal of
+  the main history and of each named history.
+*/
+
+class shardMerge
+{
+ private:
+
+  const Control& Ctrl;          ///< Problem and run options
+
+  ///\cond SINGLETON
+  shardMerge(const shardMerge&);
+  shardMerge& operator=(const shardMerge&);
+  ///\endcond SINGLETON
+
+  size_t mergeGroup(const std::string&,const size_t) const;
+
+ public:
+
+  explicit shardMerge(const Control&);
+  ~shardMerge();
+
+  size_t merge(const size_t) const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/shardPlan.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef shardPlan_h
+#define shardPlan_h
+
+class Control;
+
+/*!
+  \class shardPlan
+  \brief Cost model and shard split of the cell runs
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  The relative cost of each cell run comes from its
+  features [nuclides, steps, flux] and is fitted to the
+  times of the last run in the journal. The cells are
+  split over the shards on the feature cost alone so
+  every node makes the same split.
+*/
+
+class shardPlan
+{
+ private:
+
+  const Control& Ctrl;          ///< Problem and run options
+
+  ///\cond SINGLETON
+  shardPlan(const shardPlan&);
+  shardPlan& operator=(const shardPlan&);
+  ///\endcond SINGLETON
+
+
+ public:
+
+  explicit shardPlan(const Control&);
+  ~shardPlan();
+
+  std::string shardJournal(const size_t) const;
+  std::map<int,double> featureCost() const;
+  std::map<int,double> predictRunTimes(const std::vector<int>&,
+				       const std::string&) const;
+  std::vector<int> shardCells() const;
+};
+
+#endif
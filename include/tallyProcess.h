@@ -42,16 +42,14 @@ class tallyProcess
   long int nps;                            ///< Current nps
   CTYPE cellFlux;                          ///< Fluxes
  
-  int find1Tally(std::istream&,int&,long int&);
-  void getFluxTally(std::istream&,const long int);
-  void readWorkEnergy(std::istream&,const long int,
+  int find1Tally(const char*&,const char*,int&,long int&);
+  void getFluxTally(const char*&,const char*,const long int);
+  void readWorkEnergy(const char*&,const char*,const long int,
 		      const std::vector<int>&);
 
   
   void addFlux(const int,const WorkData&);
 
-  void cinderRebin(std::vector<WorkData>&);
-  
  public:
  
   tallyProcess();
@@ -59,12 +57,22 @@ class tallyProcess
   tallyProcess& operator=(const tallyProcess&);
   virtual ~tallyProcess();
 
+  static void cinderRebin(std::vector<WorkData>&);
+
   const WorkData& getWorkData(const int) const;
+  /// Determine if a cell has a flux
+  bool hasFlux(const int cellN) const
+    { return cellFlux.find(cellN)!=cellFlux.end(); }
 
   void readMCNP(const std::string&);
 
+  double integralFlux(const int) const;
   bool isValid(const int,const double) const;
+  void mergeCells(const int,const std::vector<int>&,
+		  const std::vector<double>&);
   void writeFluxes(const std::string&,const int) const;
+  void writeFluxes(std::ostream&,const int) const;
+  static void writeFluxes(std::ostream&,const WorkData&);
   void write(std::ostream&) const;
   
 };
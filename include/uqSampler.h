@@ -0,0 +1,62 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   include/uqSampler.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef uqSampler_h
+#define uqSampler_h
+
+class Control;
+class cellRunner;
+struct cellJob;
+
+/*!
+  \class uqSampler
+  \brief Uncertainty sampling of the cell runs
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Runs decks with the fluxes and spallation products
+  sampled from their errors and reduces the outputs of
+  the samples of each cell to summary statistics.
+*/
+
+class uqSampler
+{
+ private:
+
+  const Control& Ctrl;          ///< Problem and run options
+
+  ///\cond SINGLETON
+  uqSampler(const uqSampler&);
+  uqSampler& operator=(const uqSampler&);
+  ///\endcond SINGLETON
+
+  void writeSampleInput(const cellJob&,const cellJob&,const size_t) const;
+
+ public:
+
+  explicit uqSampler(const Control&);
+  ~uqSampler();
+
+  size_t run(const cellRunner&) const;
+};
+
+#endif
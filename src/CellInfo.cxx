@@ -100,3 +100,16 @@ CellInfo::addCell(const int CN,const double CV)
   cellV.push_back(CV);
   return;
 }
+
+double
+CellInfo::totalVolume() const
+  /*!
+    Volume of all the cells
+    \return sum of cell volumes
+  */
+{
+  double sum(0.0);
+  for(const double V : cellV)
+    sum+=V;
+  return sum;
+}
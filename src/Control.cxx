@@ -24,15 +24,21 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <cstdlib>
 #include <climits>
+#include <cfloat>
 #include <string>
 #include <vector>
 #include <set>
 #include <map>
+#include <list>
+#include <deque>
 #include <algorithm>
 #include <functional>
 #include <iterator>
 #include <regex>
+#include <chrono>
+#include <sys/types.h>
 
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
@@ -47,6 +53,7 @@
 #include "RegMethod.h"
 #include "OutputLog.h"
 #include "support.h"
+#include "MD5hash.h"
 #include "regexBuild.h"
 #include "regexSupport.h"
 #include "stringCombine.h"
@@ -58,16 +65,37 @@
 #include "WorkData.h"
 #include "cinderOption.h"
 #include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "cellProduction.h"
 #include "htapeProcess.h"
 #include "tallyProcess.h"
 #include "materialProcess.h"
+#include "CellInfo.h"
 #include "runProgs.h"
+#include "cellJob.h"
+#include "resultCache.h"
+#include "runJournal.h"
+#include "cellRunner.h"
+#include "MersenneTwister.h"
+#include "pSquare.h"
+#include "sampleStats.h"
+#include "shardPlan.h"
+#include "cellDedup.h"
+#include "normSweep.h"
+#include "uqSampler.h"
 
 #include "Control.h"
 
 Control::Control() :
   libraryPath("/home/stuartansell/cinder-1.05/data/c90lib0742"),
-  outDirBase("Cell"),htapeNorm(-1.0)
+  outDirBase("Cell"),nWorkers(0),cacheSize(0),
+  journalFile("activation.journal"),
+  manifestFile("activation.manifest"),dedupFile("activation.dedup"),
+  scratchCells(0),wallLimit(0.0),cpuLimit(0.0),memLimit(0.0),
+  maxRetry(0),retryDelay(30.0),resumeFlag(0),dedupFlag(1),groupFlag(0),
+  groupFile("activation.groups"),fluxTol(1e-6),clusterTol(0.0),
+  burnXS(1e5),burnTol(1e-3),sweepCheck(3),uqSamples(0),uqSeed(12345),
+  uqFiles({"tabs"}),shardIndex(0),nShard(0),htapeNorm(-1.0)
   /*!
     Constructor
   */
@@ -76,10 +104,21 @@ Control::Control() :
 Control::Control(const Control& A) : 
   libraryPath(A.libraryPath),matFile(A.matFile),
   mcnpOFiles(A.mcnpOFiles),mcnpHFiles(A.mcnpHFiles),
-  outDirBase(A.outDirBase),COpt(A.COpt),
+  outDirBase(A.outDirBase),nWorkers(A.nWorkers),
+  cacheDir(A.cacheDir),cacheSize(A.cacheSize),
+  journalFile(A.journalFile),manifestFile(A.manifestFile),
+  dedupFile(A.dedupFile),scratchDir(A.scratchDir),
+  scratchCells(A.scratchCells),wallLimit(A.wallLimit),
+  cpuLimit(A.cpuLimit),memLimit(A.memLimit),maxRetry(A.maxRetry),
+  retryDelay(A.retryDelay),resumeFlag(A.resumeFlag),
+  dedupFlag(A.dedupFlag),groupFlag(A.groupFlag),groupFile(A.groupFile),
+  fluxTol(A.fluxTol),clusterTol(A.clusterTol),
+  sweepScale(A.sweepScale),burnXS(A.burnXS),burnTol(A.burnTol),
+  sweepCheck(A.sweepCheck),uqSamples(A.uqSamples),uqSeed(A.uqSeed),uqFiles(A.uqFiles),
+  shardIndex(A.shardIndex),nShard(A.nShard),COpt(A.COpt),
   htapeNorm(A.htapeNorm),srcNorm(A.srcNorm),
   VolName(A.VolName),Vols(A.Vols),MatNumber(A.MatNumber),
-  CellReMap(A.CellReMap),history(A.history),
+  CellReMap(A.CellReMap),Histories(A.Histories),
   HT(A.HT),fluxes(A.fluxes),matCards(A.matCards)
   /*!
     Copy constructor
@@ -102,13 +141,41 @@ Control::operator=(const Control& A)
       mcnpOFiles=A.mcnpOFiles;
       mcnpHFiles=A.mcnpHFiles;
       outDirBase=A.outDirBase;
+      nWorkers=A.nWorkers;
+      cacheDir=A.cacheDir;
+      cacheSize=A.cacheSize;
+      journalFile=A.journalFile;
+      manifestFile=A.manifestFile;
+      dedupFile=A.dedupFile;
+      scratchDir=A.scratchDir;
+      scratchCells=A.scratchCells;
+      wallLimit=A.wallLimit;
+      cpuLimit=A.cpuLimit;
+      memLimit=A.memLimit;
+      maxRetry=A.maxRetry;
+      retryDelay=A.retryDelay;
+      resumeFlag=A.resumeFlag;
+      dedupFlag=A.dedupFlag;
+      groupFlag=A.groupFlag;
+      groupFile=A.groupFile;
+      fluxTol=A.fluxTol;
+      clusterTol=A.clusterTol;
+      sweepScale=A.sweepScale;
+      burnXS=A.burnXS;
+      burnTol=A.burnTol;
+      sweepCheck=A.sweepCheck;
+      uqSamples=A.uqSamples;
+      uqSeed=A.uqSeed;
+      uqFiles=A.uqFiles;
+      shardIndex=A.shardIndex;
+      nShard=A.nShard;
       COpt=A.COpt;
       srcNorm=A.srcNorm;
       VolName=A.VolName;
       Vols=A.Vols;
       MatNumber=A.MatNumber;
       CellReMap=A.CellReMap;
-      history=A.history;
+      Histories=A.Histories;
       HT=A.HT;
       fluxes=A.fluxes;
       matCards=A.matCards;
@@ -158,12 +225,16 @@ Control::setBaseName(const std::string& baseN)
 void
 Control::writeInput(const std::string& FName,
                     const int cellN,
-                    const double vol) const
+                    const double vol,
+		    const double normScale,
+		    const std::string& group) const
   /*!
     Write the input file for cinder
     \param FName :: File to use 
     \param cellN :: Cell number
     \param vol :: Volume
+    \param normScale :: Factor on the source normalisation
+    \param group :: Named history [empty : main history]
    */
 {
   ELog::RegMethod RegA("Control","writeInput");
@@ -173,8 +244,8 @@ Control::writeInput(const std::string& FName,
       std::ofstream OX;
       OX.open(FName.c_str());  //+StrFunc::makeString(CV.first));
       OX<<"  Beamline"<<std::endl;
-      COpt.write(OX,getCellMat(cellN),vol,srcNorm);
-      history.write(OX);
+      COpt.write(OX,getCellMat(cellN),vol,srcNorm*normScale);
+      Histories.getHistory(group).write(OX);
       OX.close();
     }
   return;
@@ -409,6 +480,30 @@ Control::procFiles(const std::string& tag,
         RP.setHTapeEXE(component);
       else if (tag=="tabcode_exe")
 	RP.setTabcodeEXE(component);
+      else if (tag=="env")
+	{
+	  // env NAME value : set for every program run
+	  std::string value;
+	  StrFunc::section(line,value);
+	  RP.setEnv(component,value);
+	}
+      else if (tag=="cache_dir")
+	cacheDir=component;
+      else if (tag=="journal")
+	journalFile=component;
+      else if (tag=="manifest")
+	manifestFile=component;
+      else if (tag=="dedup")
+	dedupFile=component;
+      else if (tag=="groups")
+	groupFile=component;
+      else if (tag=="scratch_dir")
+	{
+	  // allow $TMPDIR etc
+	  const char* envPtr=(component[0]=='$') ?
+	    getenv(component.substr(1).c_str()) : 0;
+	  scratchDir=(envPtr) ? envPtr : component;
+	}
       else
 	throw ColErr::InContainerError<std::string>(tag,"Tag");
     }
@@ -439,6 +534,139 @@ Control::procNormalization(const std::string& tag,
   return;
 }
 
+void
+Control::procRunOptions(const std::string& tag,
+			std::string line)
+  /*!
+    Process the run_options lines
+    \param tag :: identifier
+    \param line :: extra line after the tag
+   */
+{
+  ELog::RegMethod RegA("Control","procRunOptions");
+
+  size_t N;
+  double V;
+  if (tag=="workers" && StrFunc::section(line,N))
+    setWorkers(N);
+  else if (tag=="htape_cells" && StrFunc::section(line,N))
+    HT.setMaxCells(N);
+  else if (tag=="htape_stream" && StrFunc::section(line,N))
+    HT.setStream(N!=0);
+  else if (tag=="cache_size" && StrFunc::section(line,N))
+    cacheSize=N;
+  else if (tag=="scratch_cells" && StrFunc::section(line,N))
+    scratchCells=N;
+  else if (tag=="dedup" && StrFunc::section(line,N))
+    dedupFlag=(N!=0);
+  else if (tag=="group_cells" && StrFunc::section(line,N))
+    groupFlag=(N!=0);
+  else if (tag=="flux_tol" && StrFunc::section(line,V))
+    {
+      if (V<0.0)
+	throw ColErr::RangeError<double>(V,0.0,DBL_MAX,"flux_tol");
+      fluxTol=V;
+    }
+  else if (tag=="time_limit" && StrFunc::section(line,V))
+    wallLimit=V;
+  else if (tag=="cpu_limit" && StrFunc::section(line,V))
+    cpuLimit=V;
+  else if (tag=="mem_limit" && StrFunc::section(line,V))
+    memLimit=V;
+  else if (tag=="retries" && StrFunc::section(line,N))
+    {
+      maxRetry=N;
+      if (StrFunc::section(line,V))
+	{
+	  if (V<0.0)
+	    throw ColErr::RangeError<double>(V,0.0,DBL_MAX,"retry delay");
+	  retryDelay=V;
+	}
+    }
+  else if (tag=="sweep")
+    {
+      while(StrFunc::section(line,V))
+	{
+	  if (V<=0.0)
+	    throw ColErr::RangeError<double>(V,0.0,DBL_MAX,"sweep factor");
+	  sweepScale.push_back(V);
+	}
+    }
+  else if (tag=="uq_samples" && StrFunc::section(line,N))
+    uqSamples=N;
+  else if (tag=="uq_seed" && StrFunc::section(line,N))
+    uqSeed=N;
+  else if (tag=="uq_files")
+    {
+      std::string FName;
+      uqFiles.clear();
+      while(StrFunc::section(line,FName))
+	uqFiles.push_back(FName);
+    }
+  else if (tag=="burn_xs" && StrFunc::section(line,V))
+    burnXS=V;
+  else if (tag=="burn_tol" && StrFunc::section(line,V))
+    burnTol=V;
+  else if (tag=="sweep_check" && StrFunc::section(line,N))
+    sweepCheck=N;
+  else if (tag=="cluster_tol" && StrFunc::section(line,V))
+    {
+      if (V<0.0)
+	throw ColErr::RangeError<double>(V,0.0,DBL_MAX,"cluster_tol");
+      clusterTol=V;
+    }
+  else
+    throw ColErr::InContainerError<std::string>(tag,"Tag");
+  return;
+}
+
+void
+Control::setWorkers(const size_t N)
+  /*!
+    Set the number of cells to run in parallel
+    \param N :: Number of workers [0 : number of cores]
+  */
+{
+  nWorkers=N;
+  return;
+}
+
+void
+Control::setResume(const bool R)
+  /*!
+    Set the resume flag : cells completed in the journal
+    of a previous run are not re-run
+    \param R :: Resume flag
+  */
+{
+  resumeFlag=R;
+  return;
+}
+
+void
+Control::setShard(const std::string& Spec)
+  /*!
+    Set the shard of the cells to run
+    \param Spec :: Shard spec i/N [i : 0 to N-1]
+  */
+{
+  ELog::RegMethod RegA("Control","setShard");
+
+  const std::string::size_type pos=Spec.find('/');
+  int I,N;
+  if (pos==std::string::npos ||
+      !StrFunc::convert(Spec.substr(0,pos),I) ||
+      !StrFunc::convert(Spec.substr(pos+1),N) ||
+      I<0 || N<=I)
+    throw ColErr::InvalidLine(Spec,"Shard spec [i/N]");
+
+  shardIndex=static_cast<size_t>(I);
+  nShard=static_cast<size_t>(N);
+  // shards may share a working directory
+  HT.setScratch("htapeScratch"+StrFunc::makeString(I));
+  return;
+}
+
 void
 Control::readControlFile(const std::string& FName) 
   /*!
@@ -462,6 +690,7 @@ Control::readControlFile(const std::string& FName)
 
   std::string key;
   std::string AWord;
+  std::string histName;      // named history [empty : main history]
   size_t keyIndex(0);
   while(IX.good())
     {
@@ -473,6 +702,14 @@ Control::readControlFile(const std::string& FName)
             {
               key=AWord;
 	      keyIndex++;
+	      if (key=="history")
+		{
+		  histName.clear();
+		  if (StrFunc::section(line,histName) &&
+		      (histName.find('/')!=std::string::npos ||
+		       histName[0]=='.'))
+		    throw ColErr::InvalidLine(histName,"history name");
+		}
             }
           else if (key=="title_lines")
             {
@@ -483,6 +720,7 @@ Control::readControlFile(const std::string& FName)
             }
           else if (key=="run_options")
             {
+	      procRunOptions(AWord,line);
             }
           else if (key=="cinder_options")
             {
@@ -494,7 +732,7 @@ Control::readControlFile(const std::string& FName)
             }
           else if (key=="history")
             {
-              history.addLine(AWord,line);
+	      Histories.addLine(histName,AWord,line);
             }
           else if (key=="cell_remap")
             {
@@ -524,6 +762,7 @@ Control::runHTape()
 {
   ELog::RegMethod RegA("Control","runHTape");
 
+  HT.setWorkers((nWorkers) ? nWorkers : cellRunner::defaultWorkers());
   for(const std::string& hFile : mcnpHFiles)
     {
       glob::Glob htapeFiles(hFile);
@@ -566,6 +805,65 @@ Control::readFluxes()
   return;
 }
 
+void
+Control::pruneCells()
+  /*!
+    Remove the cells with an integral flux below fluxTol [or
+    no flux tally] before the spallation tallies are processed,
+    so htape passes and storage are only spent on cells that
+    are run. If the cells are grouped a group is kept whole
+    if any of its cells has flux.
+  */
+{
+  ELog::RegMethod RegA("Control","pruneCells");
+
+  std::map<int,double> Flux;
+  std::map<std::string,double> GroupFlux;
+  for(const std::map<int,double>::value_type& CV : Vols)
+    {
+      const double F=(fluxes.hasFlux(CV.first)) ?
+	fluxes.integralFlux(CV.first) : -1.0;
+      Flux.emplace(CV.first,F);
+      if (groupFlag)
+	{
+	  std::map<int,std::string>::const_iterator vc=VolName.find(CV.first);
+	  const std::string Name=(vc!=VolName.end()) ?
+	    vc->second : StrFunc::makeString(CV.first);
+	  std::map<std::string,double>::iterator mc=GroupFlux.find(Name);
+	  if (mc==GroupFlux.end())
+	    GroupFlux.emplace(Name,F);
+	  else
+	    mc->second=std::max(mc->second,F);
+	}
+    }
+
+  size_t outCnt(0);
+  for(const std::map<int,double>::value_type& FV : Flux)
+    {
+      double F(FV.second);
+      if (groupFlag)
+	{
+	  std::map<int,std::string>::const_iterator vc=VolName.find(FV.first);
+	  F=GroupFlux.find((vc!=VolName.end()) ?
+			   vc->second : StrFunc::makeString(FV.first))->second;
+	}
+      if (F<fluxTol)
+	{
+	  if (!outCnt)
+	    ELog::EM<<"Cells below flux "<<fluxTol<<" [flux / -1 : no tally]:"
+		    <<ELog::endDiag;
+	  ELog::EM<<"  "<<FV.first<<" ("<<FV.second<<")";
+	  if (!(++outCnt % 8)) ELog::EM<<ELog::endDiag;
+	  Vols.erase(FV.first);
+	  VolName.erase(FV.first);
+	}
+    }
+  if (outCnt % 8) ELog::EM<<ELog::endDiag;
+  ELog::EM<<"Flux pruning : "<<outCnt<<" of "<<Flux.size()
+	  <<" cells not processed"<<ELog::endDiag;
+  return;
+}
+
 void
 Control::readMaterials()
   /*!
@@ -585,6 +883,76 @@ Control::readMaterials()
   return;
 }
 
+void
+Control::groupCells()
+  /*!
+    Combine the cells of each cell_list name [CellInfo] into
+    one CINDER problem if groupFlag is set. A group is run as
+    its lowest cell with the total volume, the volume weighted
+    mean flux, the summed spallation production and the volume
+    weighted mixture of the cell materials. The groups are
+    written to groupFile.
+  */
+{
+  ELog::RegMethod RegA("Control","groupCells");
+
+  if (!groupFlag) return;
+
+  std::map<std::string,CellInfo> Groups;
+  for(const std::map<int,double>::value_type& VT : Vols)
+    {
+      std::map<int,std::string>::const_iterator vc=VolName.find(VT.first);
+      const std::string Name=(vc!=VolName.end()) ?
+	vc->second : StrFunc::makeString(VT.first);
+      std::map<std::string,CellInfo>::iterator mc=Groups.find(Name);
+      if (mc==Groups.end())
+	mc=Groups.emplace(Name,CellInfo(Name)).first;
+      mc->second.addCell(VT.first,VT.second);
+    }
+
+  std::ofstream OX;
+  if (!nShard || !shardIndex)
+    {
+      OX.open(groupFile.c_str());
+      OX<<"# name cell volume material : cells"<<std::endl;
+    }
+  const size_t nCells(Vols.size());
+  for(const std::map<std::string,CellInfo>::value_type& GV : Groups)
+    {
+      const CellInfo& CI(GV.second);
+      const int cellN=CI.cellN.front();
+      if (CI.cellN.size()>1)
+	{
+	  std::vector<int> Mats;
+	  for(const int CN : CI.cellN)
+	    Mats.push_back(getCellMat(CN));
+	  const int matN=matCards.mixMaterials(Mats,CI.cellV);
+	  fluxes.mergeCells(cellN,CI.cellN,CI.cellV);
+	  HT.mergeCells(cellN,CI.cellN);
+	  for(const int CN : CI.cellN)
+	    {
+	      Vols.erase(CN);
+	      MatNumber.erase(CN);
+	      VolName.erase(CN);
+	    }
+	  Vols.emplace(cellN,CI.totalVolume());
+	  MatNumber.emplace(cellN,matN);
+	  VolName.emplace(cellN,CI.VolName);
+	}
+      if (OX.is_open())
+	{
+	  OX<<CI.VolName<<" "<<cellN<<" "<<CI.totalVolume()<<" "
+	    <<getCellMat(cellN)<<" :";
+	  for(const int CN : CI.cellN)
+	    OX<<" "<<CN;
+	  OX<<std::endl;
+	}
+    }
+  ELog::EM<<"Cell groups : "<<nCells<<" cells in "<<Groups.size()
+	  <<" problems"<<ELog::endDiag;
+  return;
+}
+
 int
 Control::getCellMat(const int cellN) const
   /*!
@@ -618,48 +986,265 @@ Control::getOutDir(const int cN) const
 }
 
 void
+Control::setRunner(cellRunner& CR) const
+  /*!
+    Set the run options of the cell runner
+    \param CR :: Cell runner
+  */
+{
+  if (!scratchDir.empty())
+    CR.setScratch(scratchDir,scratchCells);
+  CR.setTimeLimit(wallLimit);
+  CR.setRetry(maxRetry,retryDelay);
+  runProgs::Instance().setLimits(cpuLimit,memLimit);
+  return;
+}
+
+std::string
+Control::writeCellInput(const int cellN,const double Vol) const
+  /*!
+    Write the CINDER input files for a cell into its directory
+    \param cellN :: Cell number
+    \param Vol :: Cell volume
+    \return directory name
+  */
+{
+  const std::string dirName=getOutDir(cellN);
+  writeCellInput(dirName,cellN,Vol,1.0,"");
+  return dirName;
+}
+
+void
+Control::writeDeckBase(const std::string& dirName,const int cellN,
+		       const double Vol) const
+  /*!
+    Write the input files of a cell that do not depend on
+    the history or the normalisation [all but input]
+    \param dirName :: Directory
+    \param cellN :: Cell number
+    \param Vol :: Cell volume
+  */
+{
+  ELog::RegMethod RegA("Control","writeDeckBase");
+
+  const boost::filesystem::path BDir(dirName);
+  if(boost::filesystem::create_directories(BDir))
+    ELog::EM<<"Create DIR:"<<dirName<<ELog::endWarn;
+
+  writeLibrary((BDir / "locate").string());
+  HT.writeSprods((BDir / "splprods").string(),cellN,Vol);
+  matCards.writeMaterials((BDir / "material").string());
+  fluxes.writeFluxes((BDir / "fluxes").string(),cellN);
+  return;
+}
+
+void
+Control::writeDecks(const std::vector<int>& Cells) const
+  /*!
+    Write the shared input files of the cells into their
+    main directories before the jobs of the named histories
+    link to them
+    \param Cells :: Cells to run
+  */
+{
+  ELog::RegMethod RegA("Control","writeDecks");
+
+  for(const int cellN : Cells)
+    {
+      std::map<int,double>::const_iterator vc=Vols.find(cellN);
+      if (vc!=Vols.end() && fluxes.isValid(cellN,fluxTol))
+	writeDeckBase(getOutDir(cellN),cellN,vc->second);
+    }
+  return;
+}
+
+void
+Control::writeCellInput(const std::string& dirName,const int cellN,
+			const double Vol,const double normScale,
+			const std::string& group) const
+  /*!
+    Write the CINDER input files for a cell into a directory.
+    Only input depends on the history and the normalisation :
+    a directory other than the main directory of the cell
+    [named history / sweep] gets hard links to the other
+    files of the main directory [copies if a link fails].
+    With named histories the main directory files are
+    written first [writeDecks] and are not rewritten here,
+    as other jobs may be reading them.
+    \param dirName :: Directory
+    \param cellN :: Cell number
+    \param Vol :: Cell volume
+    \param normScale :: Factor on the source normalisation
+    \param group :: Named history [empty : main history]
+  */
+{
+  ELog::RegMethod RegA("Control","writeCellInput");
+
+  namespace BF=boost::filesystem;
+
+  const BF::path BDir(dirName);
+  const BF::path DDir(getOutDir(cellN));
+  if(BF::create_directories(BDir))
+    ELog::EM<<"Create DIR:"<<dirName<<ELog::endWarn;
+
+  bool baseFlag(1);
+  for(const std::string& FName : resultCache::inputFiles())
+    if (FName!="input" && !BF::exists(DDir / FName))
+      baseFlag=0;
+
+  if (dirName==DDir.string())
+    {
+      if (!baseFlag || !Histories.hasScenarios())
+	writeDeckBase(dirName,cellN,Vol);
+    }
+  else if (!baseFlag)
+    writeDeckBase(dirName,cellN,Vol);
+  else
+    {
+      for(const std::string& FName : resultCache::inputFiles())
+	if (FName!="input")
+	  {
+	    boost::system::error_code EC;
+	    BF::remove(BDir / FName);
+	    BF::create_hard_link(DDir / FName,BDir / FName,EC);
+	    if (EC)
+	      resultCache::copyFile(DDir / FName,BDir / FName);
+	  }
+    }
+  writeInput((BDir / "input").string(),cellN,Vol,normScale,group);
+  return;
+}
+
+int
 Control::writeCinderInput() const
   /*!
-    Write the cinder input deck
+    Write the cinder input deck for each cell and run
+    CINDER/TABCODE in the cell directories on nWorkers
+    processes
+    \return 0 : all jobs good / 1 : failed jobs / 2 : stopped by a signal
   */
 {
   ELog::RegMethod RegA("Control","writeCinderInput");
 
-  const boost::filesystem::path topDir(boost::filesystem::current_path());
-  int index(1);
-  for(const std::map<int,double>::value_type& CV : Vols)
+  const shardPlan SP(*this);
+  const std::vector<int> Cells=SP.shardCells();
+  const std::set<int> runCells(Cells.begin(),Cells.end());
+  const std::string JName=(nShard) ? SP.shardJournal(shardIndex) : journalFile;
+  // Read before the journal is truncated
+  const std::map<int,double> runTime=SP.predictRunTimes(Cells,JName);
+  // The problems of a cell differ between groups only by the history
+  const cellDedup CD(*this);
+  std::map<int,int> Source=CD.dedupCells(Cells);
+  const std::map<int,std::pair<double,double>> Scale=
+    CD.clusterCells(Cells,Source);
+  CD.writeSourceMap(Cells.size(),Source,Scale);
+
+  // Groups : main history [if set] and each named history
+  const std::vector<std::string> Groups=Histories.getGroups();
+
+  resultCache RC(cacheDir,cacheSize*1024*1024);
+  std::list<runJournal> JR;
+  cellRunner CR(nWorkers);
+  if (!cacheDir.empty())
+    CR.setCache(&RC);
+  setRunner(CR);
+  CR.setWriter([this](const cellJob& CJ)
+	       { writeCellInput(CJ.dirName,CJ.cellN,CJ.volume,1.0,CJ.group); });
+  if (Histories.hasScenarios())
+    writeDecks(Cells);
+
+  const double mainSteps=
+    static_cast<double>(Histories.getMain().nSteps()+1);
+  std::vector<std::pair<double,cellJob>> Jobs;
+  for(const std::string& G : Groups)
     {
-      // If work to do
-      if (fluxes.isValid(CV.first,1e-6))
+      const std::string GJName=Histories.groupPath(G,JName);
+      if (!G.empty())
 	{
-	  const std::string dirName=getOutDir(CV.first);
-	  const boost::filesystem::path BDir(dirName);
-	  
-	  if(boost::filesystem::create_directories(BDir))
-	    ELog::EM<<"Create DIR:"<<dirName<<ELog::endWarn;
-	  boost::filesystem::current_path(BDir);
-	  
-	  writeLibrary("locate");
-	  writeInput("input",CV.first,CV.second);
-	  HT.writeSprods("splprods",CV.first,CV.second);
-	  matCards.writeMaterials("material");
-	  fluxes.writeFluxes("fluxes",CV.first);
-
-	  const std::string cinderTXT=(index) ?
-	    "cinderTXT"+StrFunc::makeString(index)+".log" : "";
-	  const std::string tabcodeTXT=(index) ?
-	    "tabcodeTXT"+StrFunc::makeString(index)+".log" : "";
-	  if (runProgs::Instance().runCinder("",cinderTXT))
-	    ELog::EM<<"Failed on CINDER "<<ELog::endErr;
-	  if (runProgs::Instance().runTabCode("",tabcodeTXT))
-	    ELog::EM<<"Failed on TABCODE "<<ELog::endErr;
-
-	  index++;
-	  boost::filesystem::current_path(topDir);
+	  boost::filesystem::create_directories
+	    (boost::filesystem::path(GJName).parent_path());
+	  ELog::EM<<"Scenario "<<G<<" : "<<Histories.getHistory(G).nSteps()
+		  <<" steps : journal "<<GJName<<ELog::endDiag;
+	}
+      JR.emplace_back(GJName,resumeFlag);
+      CR.setJournal(G,&JR.back());
+      if (resumeFlag)
+	ELog::EM<<"Resume : "<<JR.back().nDone()<<" cells in "
+		<<GJName<<ELog::endDiag;
+      if (nShard)
+	JR.back().writeShard(shardIndex,nShard,Cells);
+
+      // predicted times scale with the number of steps
+      const double stepScale=
+	static_cast<double>(Histories.getHistory(G).nSteps()+1)/mainSteps;
+      // Log index is the position in the full cell list
+      size_t index(1);
+      for(const std::map<int,double>::value_type& CV : Vols)
+	{
+	  // If work to do
+	  if (fluxes.isValid(CV.first,fluxTol))
+	    {
+	      if (runCells.count(CV.first))
+		{
+		  cellJob CJ(CV.first,
+			     Histories.groupPath(G,getOutDir(CV.first)),
+			     CV.second,index);
+		  CJ.group=G;
+		  std::map<int,int>::const_iterator mc=Source.find(CV.first);
+		  if (mc!=Source.end())
+		    {
+		      std::map<int,std::pair<double,double>>::const_iterator
+			sc=Scale.find(CV.first);
+		      if (sc!=Scale.end())
+			{
+			  CJ.fluxScale=sc->second.first;
+			  CJ.errorBound=sc->second.second;
+			}
+		      CR.addCopy(CJ,mc->second);
+		    }
+		  else
+		    Jobs.push_back(std::pair<double,cellJob>
+				   (stepScale*runTime.find(CV.first)->second,
+				    CJ));
+		}
+	      index++;
+	    }
+	  else if (G.empty())
+	    ELog::EM<<"Cell "<<CV.first<<" has zero flux"<<ELog::endDiag;
 	}
-      else
-	ELog::EM<<"Cell "<<CV.first<<" has zero flux"<<ELog::endDiag;
     }
+  
+  std::stable_sort(Jobs.begin(),Jobs.end(),
+		   [](const std::pair<double,cellJob>& A,
+		      const std::pair<double,cellJob>& B)
+		   { return A.first>B.first; });
+  for(const std::pair<double,cellJob>& JItem : Jobs)
+    CR.addJob(JItem.second);
+  CR.waitAll();
 
-  return;
+  std::ostringstream cx;
+  CR.writeStatus(cx);
+  if (!cacheDir.empty())
+    {
+      RC.flush();
+      RC.write(cx);
+      cx<<std::endl;
+    }
+  ELog::EM<<"Cell run status:\n"<<cx.str()<<ELog::endDiag;
+  if (CR.nFailed())
+    ELog::EM<<"Failed cells : "<<CR.nFailed()<<ELog::endCrit;
+  if (runProgs::stopLevel())
+    return 2;
+
+  size_t nFail(CR.nFailed());
+  if (!sweepScale.empty())
+    {
+      nFail+=normSweep(*this).run(CR,(cacheDir.empty()) ? 0 : &RC);
+      RC.flush();
+    }
+  if (!runProgs::stopLevel())
+    nFail+=uqSampler(*this).run(CR);
+  if (runProgs::stopLevel())
+    return 2;
+  return (nFail) ? 1 : 0;
 }
@@ -0,0 +1,302 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/cellDedup.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cfloat>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "MD5hash.h"
+#include "stringCombine.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "Control.h"
+#include "cellDedup.h"
+
+cellDedup::cellDedup(const Control& C) :
+  Ctrl(C)
+  /*!
+    Constructor
+    \param C :: Control [problem and run options]
+  */
+{}
+
+cellDedup::~cellDedup()
+  /*!
+    Destructor
+  */
+{}
+
+std::string
+cellDedup::problemString(const int cellN,const double Vol) const
+  /*!
+    Canonical form of the CINDER problem of a cell : the
+    input, fluxes and spallation products as they are
+    written to the deck, less the cell number. The deck
+    is formatted at tally precision so cells that agree
+    to that precision have the same problem. The volume
+    is written into the input and scales the totals of
+    the results, so it is kept as part of the problem.
+    [material/locate are the same for all cells]
+    \param cellN :: Cell number
+    \param Vol :: Cell volume
+    \return problem string
+  */
+{
+  ELog::RegMethod RegA("cellDedup","problemString");
+
+  std::ostringstream cx;
+  Ctrl.COpt.write(cx,Ctrl.getCellMat(cellN),Vol,Ctrl.srcNorm);
+  Ctrl.Histories.getMain().write(cx);
+  Ctrl.fluxes.writeFluxes(cx,cellN);
+
+  std::ostringstream sx;
+  Ctrl.HT.writeSprods(sx,cellN,Vol);
+  // drop the "in cells N" line
+  const std::string SP=sx.str();
+  const std::string::size_type posA=SP.find('\n');
+  const std::string::size_type posB=
+    (posA==std::string::npos) ? posA : SP.find('\n',posA+1);
+  if (posB==std::string::npos)
+    throw ColErr::InvalidLine(SP,"splprods header");
+  cx<<SP.substr(0,posA+1)<<SP.substr(posB+1);
+  return cx.str();
+}
+
+std::map<int,int>
+cellDedup::dedupCells(const std::vector<int>& Cells) const
+  /*!
+    Group the cells with identical CINDER problems. The
+    first [lowest number] cell of each group is run and
+    the others take its results.
+    \param Cells :: Cells to run
+    \return map of cell : cell run in its place [copies only]
+  */
+{
+  ELog::RegMethod RegA("cellDedup","dedupCells");
+
+  std::map<int,int> Out;
+  if (!Ctrl.dedupFlag) return Out;
+
+  std::map<std::string,int> Source;    // problem hash : first cell
+  for(const int cellN : Cells)
+    {
+      const std::map<int,double>::const_iterator vc=Ctrl.Vols.find(cellN);
+      if (vc==Ctrl.Vols.end())
+	throw ColErr::InContainerError<int>(cellN,"cellN in Vols");
+
+      MD5hash MH;
+      const std::string Key=MH.processMessage(problemString(cellN,vc->second));
+      std::map<std::string,int>::const_iterator mc=Source.find(Key);
+      if (mc==Source.end())
+	Source.emplace(Key,cellN);
+      else
+	Out.emplace(cellN,mc->second);
+    }
+
+  return Out;
+}
+
+double
+cellDedup::spectralBound(const int cellA,const int cellB,
+			 const double scale) const
+  /*!
+    Bound on the relative difference of the problem of cellA
+    and scale times the problem of cellB : the largest
+    relative difference of any group flux or spallation
+    production density. Any reaction rate [non-negative
+    cross sections] of cellA is within this fraction of
+    scale times that of cellB.
+    \param cellA :: Cell number
+    \param cellB :: Cell number of reference cell
+    \param scale :: Flux of cellA / flux of cellB
+    \return relative error bound [DBL_MAX if not comparable]
+  */
+{
+  ELog::RegMethod RegA("cellDedup","spectralBound");
+
+  const std::vector<DError::doubleErr>& FA=
+    Ctrl.fluxes.getWorkData(cellA).getYdata();
+  const std::vector<DError::doubleErr>& FB=
+    Ctrl.fluxes.getWorkData(cellB).getYdata();
+  if (FA.size()!=FB.size() || scale<=0.0)
+    return DBL_MAX;
+
+  double err(0.0);
+  for(size_t i=0;i<FA.size();i++)
+    {
+      const double A=FA[i].getVal();
+      const double B=scale*FB[i].getVal();
+      if (B>0.0)
+	err=std::max(err,std::abs(A/B-1.0));
+      else if (A>0.0)
+	return DBL_MAX;
+    }
+
+  // spallation products per unit volume
+  const double VA=Ctrl.Vols.find(cellA)->second;
+  const double VB=Ctrl.Vols.find(cellB)->second;
+  const std::map<int,double> PA=Ctrl.HT.getSprods(cellA);
+  const std::map<int,double> PB=Ctrl.HT.getSprods(cellB);
+  if (PA.size()!=PB.size())
+    return DBL_MAX;
+  for(const std::map<int,double>::value_type& PV : PA)
+    {
+      std::map<int,double>::const_iterator mc=PB.find(PV.first);
+      if (mc==PB.end())
+	return DBL_MAX;
+      err=std::max(err,std::abs((PV.second*VB)/(scale*mc->second*VA)-1.0));
+    }
+  return err;
+}
+
+std::map<int,std::pair<double,double>>
+cellDedup::clusterCells(const std::vector<int>& Cells,
+			std::map<int,int>& Source) const
+  /*!
+    Approximate reuse : cells of the same material whose
+    flux spectrum and spallation production match a run
+    cell to within clusterTol [after scaling by the
+    integrated flux] take the results of that cell.
+    The cells are taken highest flux first and each is
+    matched to the closest representative or becomes one.
+    \param Cells :: Cells to run
+    \param Source :: Map of copies : source cell [updated]
+    \return map of copies : (flux scale, error bound) [scaled only]
+  */
+{
+  ELog::RegMethod RegA("cellDedup","clusterCells");
+
+  std::map<int,std::pair<double,double>> Out;
+  if (Ctrl.clusterTol<=0.0) return Out;
+
+  std::vector<std::pair<double,int>> Order;
+  for(const int cellN : Cells)
+    if (Source.find(cellN)==Source.end())
+      Order.push_back(std::pair<double,int>
+		      (Ctrl.fluxes.integralFlux(cellN),cellN));
+  std::sort(Order.begin(),Order.end(),
+	    [](const std::pair<double,int>& A,const std::pair<double,int>& B)
+	    {
+	      return (A.first>B.first) ||
+		(A.first==B.first && A.second<B.second);
+	    });
+
+  std::map<int,std::vector<int>> Reps;     // material : representatives
+  for(const std::pair<double,int>& OP : Order)
+    {
+      std::vector<int>& RVec=Reps[Ctrl.getCellMat(OP.second)];
+      bool found(0);
+      std::pair<int,std::pair<double,double>> Best;
+      for(const int R : RVec)
+	{
+	  const double scale=OP.first/Ctrl.fluxes.integralFlux(R);
+	  const double err=spectralBound(OP.second,R,scale);
+	  if (err<=Ctrl.clusterTol && (!found || err<Best.second.second))
+	    {
+	      found=1;
+	      Best=std::pair<int,std::pair<double,double>>
+		(R,std::pair<double,double>(scale,err));
+	    }
+	}
+      if (found)
+	{
+	  Source[OP.second]=Best.first;
+	  Out.emplace(OP.second,Best.second);
+	}
+      else
+	RVec.push_back(OP.second);
+    }
+
+  // exact copies of a clustered cell follow it
+  for(std::map<int,int>::value_type& SV : Source)
+    {
+      std::map<int,std::pair<double,double>>::const_iterator
+	mc=Out.find(SV.second);
+      if (mc!=Out.end() && Out.find(SV.first)==Out.end())
+	{
+	  Out.emplace(SV.first,mc->second);
+	  SV.second=Source.find(SV.second)->second;
+	}
+    }
+  return Out;
+}
+
+void
+cellDedup::writeSourceMap(const size_t nCells,
+			  const std::map<int,int>& Source,
+			  const std::map<int,std::pair<double,double>>& Scale)
+  const
+  /*!
+    Write the map of the cells that are not run to the
+    cell that is run in their place [dedupFile]
+    \param nCells :: Number of cells
+    \param Source :: Map of copies : source cell
+    \param Scale :: Map of copies : (flux scale, error bound)
+  */
+{
+  ELog::RegMethod RegA("cellDedup","writeSourceMap");
+
+  const std::string FName=(Ctrl.nShard) ?
+    Ctrl.dedupFile+"."+StrFunc::makeString(Ctrl.shardIndex) : Ctrl.dedupFile;
+
+  double maxErr(0.0);
+  std::ofstream OX(FName.c_str());
+  OX<<"# cell source flux_scale volume_ratio error_bound : "
+    <<Source.size()<<" of "<<nCells<<" cells not run"<<std::endl;
+  for(const std::map<int,int>::value_type& MV : Source)
+    {
+      std::map<int,std::pair<double,double>>::const_iterator
+	mc=Scale.find(MV.first);
+      const std::pair<double,double> SE=(mc!=Scale.end()) ?
+	mc->second : std::pair<double,double>(1.0,0.0);
+      maxErr=std::max(maxErr,SE.second);
+      OX<<MV.first<<" "<<MV.second<<" "<<SE.first<<" "
+	<<Ctrl.Vols.find(MV.first)->second/Ctrl.Vols.find(MV.second)->second
+	<<" "<<SE.second<<std::endl;
+    }
+  OX.close();
+  if (!Source.empty())
+    ELog::EM<<"Reused problems : "<<Source.size()<<" of "<<nCells
+	    <<" cells not run [approximate "<<Scale.size()
+	    <<" max error bound "<<maxErr<<"] map in "
+	    <<FName<<ELog::endDiag;
+  return;
+}
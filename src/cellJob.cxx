@@ -0,0 +1,188 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/cellJob.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <sys/types.h>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "stringCombine.h"
+#include "cellJob.h"
+
+cellJob::cellJob(const int CN,const std::string& DName,
+		 const double V,const size_t LI) :
+  cellN(CN),dirName(DName),runDir(DName),volume(V),logIndex(LI),
+  stage(0),pid(0),status(-1),nTry(0),cinderExit(-1),tabcodeExit(-1),
+  startTime(0.0),endTime(0.0),cacheHit(0),resumed(0),sourceCell(0),
+  fluxScale(1.0),errorBound(0.0)
+  /*!
+    Constructor
+    \param CN :: Cell number
+    \param DName :: Directory for run
+    \param V :: Volume of cell
+    \param LI :: Log index
+  */
+{}
+
+cellJob::cellJob(const cellJob& A) :
+  cellN(A.cellN),group(A.group),dirName(A.dirName),runDir(A.runDir),
+  volume(A.volume),logIndex(A.logIndex),stage(A.stage),pid(A.pid),
+  status(A.status),nTry(A.nTry),cinderExit(A.cinderExit),
+  tabcodeExit(A.tabcodeExit),startTime(A.startTime),endTime(A.endTime),
+  hashKey(A.hashKey),cacheHit(A.cacheHit),resumed(A.resumed),
+  sourceCell(A.sourceCell),fluxScale(A.fluxScale),errorBound(A.errorBound)
+  /*!
+    Copy constructor
+    \param A :: cellJob to copy
+  */
+{}
+
+cellJob&
+cellJob::operator=(const cellJob& A)
+  /*!
+    Assignment operator
+    \param A :: cellJob to copy
+    \return *this
+  */
+{
+  if (this!=&A)
+    {
+      cellN=A.cellN;
+      group=A.group;
+      dirName=A.dirName;
+      runDir=A.runDir;
+      volume=A.volume;
+      logIndex=A.logIndex;
+      stage=A.stage;
+      pid=A.pid;
+      status=A.status;
+      nTry=A.nTry;
+      cinderExit=A.cinderExit;
+      tabcodeExit=A.tabcodeExit;
+      startTime=A.startTime;
+      endTime=A.endTime;
+      hashKey=A.hashKey;
+      cacheHit=A.cacheHit;
+      resumed=A.resumed;
+      sourceCell=A.sourceCell;
+      fluxScale=A.fluxScale;
+      errorBound=A.errorBound;
+    }
+  return *this;
+}
+
+cellJob::~cellJob()
+  /*!
+    Destructor
+  */
+{}
+
+const std::vector<std::string>&
+cellJob::expectedOutputs()
+  /*!
+    Files a good CINDER/TABCODE run leaves in the cell
+    directory [besides the logs]
+    \return output file names
+  */
+{
+  static const std::vector<std::string> OFiles={"outp","tabs"};
+  return OFiles;
+}
+
+std::string
+cellJob::cinderLog() const
+  /*!
+    Name of the CINDER log file [in the run directory]
+    \return log file name
+  */
+{
+  return "cinderTXT"+StrFunc::makeString(logIndex)+".log";
+}
+
+std::string
+cellJob::tabcodeLog() const
+  /*!
+    Name of the TABCODE log file [in the run directory]
+    \return log file name
+  */
+{
+  return "tabcodeTXT"+StrFunc::makeString(logIndex)+".log";
+}
+
+bool
+cellJob::isScaled() const
+  /*!
+    Determine if the results are an approximate copy
+    that needs scaling by fluxScale
+    \return true if scaled
+  */
+{
+  return (sourceCell && (errorBound>0.0 || fluxScale!=1.0));
+}
+
+std::string
+cellJob::statusString() const
+  /*!
+    Convert the status flag into a readable form
+    \return status string
+  */
+{
+  if (status<0) return "NOT RUN";
+  if (!status)
+    {
+      if (sourceCell && isScaled())
+	return "OK [~"+StrFunc::makeString(sourceCell)+" x"+
+	  StrFunc::makeString(fluxScale)+" err "+
+	  StrFunc::makeString(errorBound)+"]";
+      if (sourceCell)
+	return "OK [same as "+StrFunc::makeString(sourceCell)+"]";
+      if (resumed) return "OK [resumed]";
+      if (cacheHit) return "OK [cached]";
+      return (nTry>1) ? "OK [try "+StrFunc::makeString(nTry)+"]" : "OK";
+    }
+
+  if (status==64) return "STOPPED [not run]";
+
+  std::string Out;
+  if (status & 64) Out+="STOPPED ";
+  if (status & 32) Out+="TIMEOUT ";
+  if (status & 1) Out+="CINDER [exit "+StrFunc::makeString(cinderExit)+"] ";
+  if (status & 2) Out+="TABCODE [exit "+StrFunc::makeString(tabcodeExit)+"] ";
+  if (status & 4) Out+="DIRECTORY ";
+  if (status & 8) Out+="OUTPUT ";
+  if (status & 16) Out+="COPY ";
+  if (nTry>1) Out+="[try "+StrFunc::makeString(nTry)+"] ";
+  return Out+"FAILED";
+}
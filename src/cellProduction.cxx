@@ -48,6 +48,7 @@
 #include "regexSupport.h"
 #include "doubleErr.h"
 #include "mathSupport.h"
+#include "MersenneTwister.h"
 #include "cellProduction.h"
 
 
@@ -251,6 +252,36 @@ cellProduction::getTotal() const
   return Out;
 }
 
+std::map<int,double>
+cellProduction::getSprods() const
+  /*!
+    Get the production as written to the splprods file
+    \return map of zaid : value
+  */
+{
+  std::map<int,double> Out;
+  for(const CTYPE::value_type& CV : elmTotal)
+    if (CV.second>1e-20)
+      Out.emplace(CV.first,CV.second.getVal());
+  return Out;
+}
+
+cellProduction&
+cellProduction::operator+=(const cellProduction& A)
+  /*!
+    Add the production of another cell [errors in quadrature]
+    \param A :: Production to add
+    \return *this
+   */
+{
+  for(const CTYPE::value_type& CV : A.elmProd)
+    elmProd[CV.first]+=CV.second;
+  for(const CTYPE::value_type& CV : A.elmLoss)
+    elmLoss[CV.first]+=CV.second;
+  for(const CTYPE::value_type& CV : A.elmTotal)
+    elmTotal[CV.first]+=CV.second;
+  return *this;
+}
 
 cellProduction&
 cellProduction::scale(const double V)
@@ -271,6 +302,28 @@ cellProduction::scale(const double V)
   return *this;
 }
 
+cellProduction&
+cellProduction::sample(MTRand& RNG)
+  /*!
+    Replace the total of each nuclide by a normal sample
+    about the value with its error [uncorrelated]. The
+    sample keeps the sign of the value.
+    \param RNG :: Random number generator
+    \return *this
+   */
+{
+  ELog::RegMethod RegA("cellProduction","sample");
+
+  for(CTYPE::value_type& CV : elmTotal)
+    {
+      const double V=CV.second.getVal();
+      double S=V+CV.second.getErr()*RNG.randNorm(0.0,1.0);
+      if (S*V<0.0) S=0.0;
+      CV.second=DError::doubleErr(S,CV.second.getErr());
+    }
+  return *this;
+}
+
 void
 cellProduction::scaleSum(CTYPE& AUnit,const CTYPE& BUnit,
                          const long int oldNPS,
@@ -0,0 +1,1310 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/cellRunner.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <functional>
+#include <chrono>
+#include <set>
+#include <algorithm>
+#include <cctype>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "stringCombine.h"
+#include "runProgs.h"
+#include "cellJob.h"
+#include "resultCache.h"
+#include "runJournal.h"
+#include "cellRunner.h"
+
+cellRunner::cellRunner(const size_t NW) :
+  nWorkers((NW) ? NW : defaultWorkers()),
+  startClock(std::chrono::steady_clock::now()),nCopy(0),nDeck(0),
+  wallLimit(0.0),maxRetry(0),retryDelay(0.0),stopLevel(0),killTime(0.0),
+  Cache(0),maxStaged(0),nStaged(0)
+  /*!
+    Constructor
+    \param NW :: Number of workers [0 for number of cores]
+  */
+{}
+
+cellRunner::~cellRunner()
+  /*!
+    Destructor : Does not leave children behind
+  */
+{
+  while(!Active.empty())
+    reapJob(1,0.0);
+  if (!scratchRoot.empty())
+    {
+      boost::system::error_code errCode;
+      boost::filesystem::remove_all(scratchRoot,errCode);
+    }
+}
+
+void
+cellRunner::setScratch(const std::string& SRoot,const size_t NS)
+  /*!
+    Run the cells in a node local scratch directory
+    \param SRoot :: Scratch root [e.g. /dev/shm]
+    \param NS :: Max cells on scratch [0 : twice the workers]
+  */
+{
+  ELog::RegMethod RegA("cellRunner","setScratch");
+
+  // One directory per process : several runs may share the root
+  scratchRoot=(boost::filesystem::path(SRoot) /
+	       ("activation_"+StrFunc::makeString(getpid()))).string();
+  maxStaged=(NS) ? NS : 2*nWorkers;
+  boost::filesystem::create_directories(scratchRoot);
+  return;
+}
+
+void
+cellRunner::setRetry(const size_t NR,const double D)
+  /*!
+    Set the re-runs of failed jobs
+    \param NR :: Max number of re-runs of a job
+    \param D :: Delay before the first re-run [sec : doubles each time]
+  */
+{
+  maxRetry=NR;
+  retryDelay=D;
+  return;
+}
+
+bool
+cellRunner::canLaunch(const cellJob& CJ) const
+  /*!
+    Determine if a worker [and scratch space] is free
+    \param CJ :: Job to launch [staged in by prepare or not]
+    \return true if the job can be launched
+  */
+{
+  return (Active.size()-nCopy-nDeck<nWorkers &&
+	  (scratchRoot.empty() || CJ.runDir!=CJ.dirName ||
+	   nStaged<maxStaged));
+}
+
+std::string
+cellRunner::scratchDir(const cellJob& CJ) const
+  /*!
+    Scratch directory of a cell
+    \param CJ :: Job
+    \return directory under the scratch root
+  */
+{
+  std::string SName(CJ.dirName);
+  std::replace(SName.begin(),SName.end(),'/','_');
+  return (boost::filesystem::path(scratchRoot) / SName).string();
+}
+
+bool
+cellRunner::stageIn(cellJob& CJ)
+  /*!
+    Copy the inputs of a cell to its scratch directory
+    \param CJ :: Job [runDir set on success]
+    \return true on success
+  */
+{
+  ELog::RegMethod RegA("cellRunner","stageIn");
+
+  namespace BF=boost::filesystem;
+
+  const BF::path SDir=scratchDir(CJ);
+  try
+    {
+      BF::remove_all(SDir);
+      BF::create_directories(SDir);
+      for(const std::string& IName : resultCache::inputFiles())
+	resultCache::copyFile(BF::path(CJ.dirName) / IName,SDir / IName);
+    }
+  catch (BF::filesystem_error& EX)
+    {
+      ELog::EM<<"Failed to stage "<<CJ.dirName<<" : "
+	      <<EX.what()<<ELog::endCrit;
+      boost::system::error_code errCode;
+      BF::remove_all(SDir,errCode);
+      return 0;
+    }
+  CJ.runDir=SDir.string();
+  nStaged++;
+  return 1;
+}
+
+void
+cellRunner::unStage(cellJob& CJ)
+  /*!
+    Remove the scratch directory of a job that is not run
+    \param CJ :: Job
+  */
+{
+  if (CJ.runDir!=CJ.dirName)
+    {
+      boost::system::error_code errCode;
+      boost::filesystem::remove_all(CJ.runDir,errCode);
+      CJ.runDir=CJ.dirName;
+      nStaged--;
+    }
+  return;
+}
+
+void
+cellRunner::prepare(const size_t index)
+  /*!
+    Start a child that writes the input deck of job index
+    [and stages it in] while the main process goes on
+    launching and collecting. The child runs Writer on its
+    own copy of the data, so nothing is shared.
+    \param index :: Index in Jobs
+  */
+{
+  ELog::RegMethod RegA("cellRunner","prepare");
+
+  cellJob& CJ(Jobs[index]);
+  const bool stageFlag(!scratchRoot.empty() && nStaged<maxStaged);
+  CJ.stage=0;
+  CJ.pid=runProgs::Instance().startTask
+    ([this,index,stageFlag]() -> int
+     {
+       Writer(Jobs[index]);
+       return (!stageFlag || stageIn(Jobs[index])) ? 0 : 1;
+     });
+  nDeck++;
+  if (stageFlag)
+    {
+      CJ.runDir=scratchDir(CJ);
+      nStaged++;
+    }
+  if (CJ.pid<0)
+    advance(index,-1);
+  else
+    Active.emplace(CJ.pid,index);
+  return;
+}
+
+void
+cellRunner::copyBack(const size_t index)
+  /*!
+    Start the copy of the result files and the logs of
+    job index from scratch to the cell directory. Anything
+    else the codes leave on scratch is not copied.
+    \param index :: Index in Jobs
+  */
+{
+  ELog::RegMethod RegA("cellRunner","copyBack");
+
+  namespace BF=boost::filesystem;
+
+  cellJob& CJ(Jobs[index]);
+  std::string Files;
+  boost::system::error_code errCode;
+  for(BF::directory_iterator di(CJ.runDir,errCode);
+      di!=BF::directory_iterator();di++)
+    {
+      const std::string FName=di->path().filename().string();
+      if (BF::is_regular_file(di->status()) &&
+	  (resultCache::isResult(FName) ||
+	   FName==CJ.cinderLog() || FName==CJ.tabcodeLog()))
+	Files+=FName+" ";
+    }
+
+  CJ.stage=3;
+  CJ.pid=(Files.empty()) ? -1 :
+    runProgs::Instance().startJob
+    ("cp","-p "+Files+BF::absolute(CJ.dirName).string(),CJ.runDir,"",0);
+  nCopy++;
+  if (CJ.pid<0)
+    advance(index,-1);
+  else
+    Active.emplace(CJ.pid,index);
+  return;
+}
+
+size_t
+cellRunner::defaultWorkers()
+  /*!
+    Determine the number of cores on the machine
+    \return number of online processors [min 1]
+  */
+{
+  const long int NCPU=sysconf(_SC_NPROCESSORS_ONLN);
+  return (NCPU>0) ? static_cast<size_t>(NCPU) : 1;
+}
+
+double
+cellRunner::getTime() const
+  /*!
+    Time since the runner was started
+    \return time [sec]
+  */
+{
+  const std::chrono::duration<double> D=
+    std::chrono::steady_clock::now()-startClock;
+  return D.count();
+}
+
+runJournal*
+cellRunner::getJournal(const cellJob& CJ) const
+  /*!
+    Journal of the group of a job
+    \param CJ :: Job
+    \return journal [0 : none]
+  */
+{
+  std::map<std::string,runJournal*>::const_iterator mc=
+    Journals.find(CJ.group);
+  return (mc==Journals.end()) ? 0 : mc->second;
+}
+
+void
+cellRunner::launch(const size_t index)
+  /*!
+    Start the CINDER stage of job index
+    \param index :: Index in Jobs
+  */
+{
+  ELog::RegMethod RegA("cellRunner","launch");
+
+  cellJob& CJ(Jobs[index]);
+  CJ.startTime=getTime();
+  CJ.status=0;
+  CJ.nTry++;
+  if (!boost::filesystem::is_directory(CJ.dirName))
+    {
+      CJ.status=4;
+      unStage(CJ);
+      finish(index);
+      return;
+    }
+
+  runJournal* Journal=getJournal(CJ);
+  if (Cache || Journal)
+    CJ.hashKey=resultCache::problemKey(CJ.dirName);
+
+  if (Journal && Journal->isComplete(CJ))
+    {
+      CJ.resumed=1;
+      unStage(CJ);
+      finish(index);
+      return;
+    }
+
+  if (Cache)
+    {
+      if (Cache->restore(CJ.hashKey,CJ.dirName))
+	{
+	  std::ofstream OX((boost::filesystem::path(CJ.dirName) /
+			    CJ.cinderLog()).string().c_str());
+	  OX<<"Results restored from cache entry "<<CJ.hashKey<<std::endl;
+	  CJ.cacheHit=1;
+	  unStage(CJ);
+	  finish(index);
+	  return;
+	}
+    }
+
+  if (!scratchRoot.empty() && CJ.runDir==CJ.dirName && !stageIn(CJ))
+    {
+      CJ.status=4;
+      finish(index);
+      return;
+    }
+  
+  CJ.stage=1;
+  CJ.pid=runProgs::Instance().startCinder(CJ.runDir,CJ.cinderLog());
+  if (CJ.pid<0)
+    advance(index,-1);
+  else
+    Active.emplace(CJ.pid,index);
+  return;
+}
+
+void
+cellRunner::advance(const size_t index,const int exitCode)
+  /*!
+    Move job index on to its next stage
+    \param index :: Index in Jobs
+    \param exitCode :: Exit code of the finished stage
+  */
+{
+  ELog::RegMethod RegA("cellRunner","advance");
+
+  cellJob& CJ(Jobs[index]);
+  CJ.pid=0;
+  if (CJ.stage==0)
+    {
+      // deck written : not run if stopped
+      nDeck--;
+      if (stopLevel || exitCode)
+	{
+	  if (!stopLevel)
+	    ELog::EM<<"Failed to write deck "<<CJ.dirName<<ELog::endCrit;
+	  CJ.status=(stopLevel) ? 64 : 4;
+	  CJ.startTime=getTime();
+	  unStage(CJ);
+	  finish(index);
+	}
+      else
+	Ready.push_back(index);
+      return;
+    }
+  // SIGXCPU : over the CPU limit
+  if (CJ.stage<3 && exitCode==128+SIGXCPU)
+    CJ.status|=32;
+  if (CJ.stage==1)
+    {
+      CJ.cinderExit=exitCode;
+      if (exitCode)
+	CJ.status|=1;
+      CJ.stage=2;
+      // timed out / killed : no TABCODE
+      if (!(CJ.status & (32 | 64)))
+	{
+	  CJ.pid=runProgs::Instance().
+	    startTabCode(CJ.runDir,CJ.tabcodeLog());
+	  if (CJ.pid<0)
+	    advance(index,-1);
+	  else
+	    Active.emplace(CJ.pid,index);
+	  return;
+	}
+    }
+  else if (CJ.stage==2)
+    {
+      CJ.tabcodeExit=exitCode;
+      if (exitCode)
+	CJ.status|=2;
+    }
+
+  if (CJ.stage==2)
+    {
+      if (CJ.runDir!=CJ.dirName)
+	{
+	  copyBack(index);
+	  return;
+	}
+    }
+  else if (CJ.stage==3)
+    {
+      if (exitCode)
+	{
+	  ELog::EM<<"Failed to copy back "<<CJ.runDir<<ELog::endCrit;
+	  CJ.status|=16;
+	}
+      nCopy--;
+      boost::system::error_code errCode;
+      boost::filesystem::remove_all(CJ.runDir,errCode);
+      nStaged--;
+    }
+  finish(index);
+  return;
+}
+
+void
+cellRunner::finish(const size_t index)
+  /*!
+    Record the end of the run of job index and queue
+    it for collection
+    \param index :: Index in Jobs
+  */
+{
+  ELog::RegMethod RegA("cellRunner","finish");
+
+  cellJob& CJ(Jobs[index]);
+  CJ.stage=4;
+  CJ.pid=0;
+  CJ.endTime=getTime();
+  Collect.push_back(index);
+  return;
+}
+
+void
+cellRunner::collect(const size_t index)
+  /*!
+    Verify the outputs of job index and record it
+    in the cache and journal
+    \param index :: Index in Jobs
+  */
+{
+  ELog::RegMethod RegA("cellRunner","collect");
+
+  cellJob& CJ(Jobs[index]);
+  CJ.stage=5;
+
+  if (!CJ.status)
+    {
+      const boost::filesystem::path BDir(CJ.dirName);
+      for(const std::string& OName : cellJob::expectedOutputs())
+	if (!boost::filesystem::exists(BDir / OName))
+	  {
+	    ELog::EM<<"Missing output "<<OName<<" : cell "
+		    <<CJ.cellN<<ELog::endCrit;
+	    CJ.status|=8;
+	  }
+    }
+  
+  if (retryJob(index))
+    return;
+
+  if (CJ.status & 32)
+    ELog::EM<<"Over the time limit : cell "<<CJ.cellN<<ELog::endCrit;
+  if (CJ.status & 1)
+    ELog::EM<<"Failed on CINDER : cell "<<CJ.cellN<<ELog::endCrit;
+  if (CJ.status & 2)
+    ELog::EM<<"Failed on TABCODE : cell "<<CJ.cellN<<ELog::endCrit;
+  if (CJ.status & 4)
+    ELog::EM<<"Failed on directory : "<<CJ.dirName<<ELog::endCrit;
+
+  if (Cache && !CJ.status && !CJ.cacheHit &&
+      !CJ.resumed && !CJ.sourceCell)
+    Cache->store(CJ.hashKey,CJ.dirName);
+  runJournal* Journal=getJournal(CJ);
+  if (Journal && !CJ.resumed && !(CJ.status & 64))
+    Journal->record(CJ);
+  if (Collector)
+    Collector(CJ);
+  if (!CJ.sourceCell)
+    fanOut(index);
+  return;
+}
+
+bool
+cellRunner::isTable(const std::string& FName)
+  /*!
+    Determine if a result file is a table of nuclide
+    densities/activities/doses [tabs, TABCODE tabN]
+    \param FName :: File name [no directory]
+    \return true if a table
+  */
+{
+  return (FName=="tabs" ||
+	  (FName.size()>3 && FName.compare(0,3,"tab")==0 &&
+	   std::isdigit(FName[3])));
+}
+
+bool
+cellRunner::tableNumber(const std::string& Item,double& V,
+			size_t& prec)
+  /*!
+    Determine if an item of a table line is a tabulated
+    value : a number in exponent form [e.g. 1.234E+05].
+    Integers and fixed point numbers [nuclide ids, step
+    numbers] are not values.
+    \param Item :: Item
+    \param V :: Value
+    \param prec :: Digits after the decimal point
+    \return true if a value
+  */
+{
+  const std::string::size_type ePos=Item.find_first_of("eE");
+  const std::string::size_type dPos=Item.find('.');
+  if (ePos==std::string::npos || ePos==0 ||
+      !std::isdigit(Item[ePos-1]) || !StrFunc::convert(Item,V))
+    return 0;
+  prec=(dPos!=std::string::npos && dPos<ePos) ? ePos-dPos-1 : 0;
+  return 1;
+}
+
+bool
+cellRunner::timeColumns(const std::string& Line,std::vector<size_t>& Cols)
+  /*!
+    Determine if a table line is a time header. The value
+    columns of the rows below it are the columns that end
+    where the times of the header end [fixed format].
+    \param Line :: Line of a table
+    \param Cols :: End positions of the times [set if a header]
+    \return true if a time header
+  */
+{
+  std::string Lower(Line);
+  std::transform(Lower.begin(),Lower.end(),Lower.begin(),::tolower);
+  if (Lower.find("time")==std::string::npos)
+    return 0;
+
+  Cols.clear();
+  size_t pos(0);
+  while(pos<Line.size())
+    {
+      while(pos<Line.size() && std::isspace(Line[pos])) pos++;
+      const size_t iStart(pos);
+      while(pos<Line.size() && !std::isspace(Line[pos])) pos++;
+      double V;
+      if (pos>iStart && StrFunc::convert(Line.substr(iStart,pos-iStart),V))
+	Cols.push_back(pos);
+    }
+  return 1;
+}
+
+std::string
+cellRunner::scaleItem(const std::string& Item,const double F,
+		      const size_t width)
+  /*!
+    Multiply a number in exponent form by F keeping its
+    precision, exponent case and [if possible] width
+    \param Item :: Number [tableNumber]
+    \param F :: Factor
+    \param width :: Width to right align to
+    \return scaled number [Item if not a number]
+  */
+{
+  double V;
+  size_t prec;
+  if (!tableNumber(Item,V,prec))
+    return Item;
+  const bool upper(Item.find('E')!=std::string::npos);
+  boost::format FMT("%."+StrFunc::makeString(prec)+
+		    ((upper) ? "E" : "e"));
+  const std::string NItem=(FMT % (V*F)).str();
+  return (NItem.size()<width) ?
+    std::string(width-NItem.size(),' ')+NItem : " "+NItem;
+}
+
+std::string
+cellRunner::scaleLine(const std::string& Line,const double F,
+		      const std::vector<size_t>& Cols)
+  /*!
+    Multiply the values of a table row by F. Only numbers in
+    exponent form that end in a time column are values :
+    nuclide ids, half-lives and other leading columns are
+    not altered. Each value keeps its precision, exponent
+    case and [if possible] width so the layout of the table
+    is unchanged.
+    \param Line :: Row of a table
+    \param F :: Factor
+    \param Cols :: End positions of the time columns
+    \return scaled line
+  */
+{
+  std::string Out;
+  size_t pos(0);
+  while(pos<Line.size())
+    {
+      const size_t start(pos);
+      while(pos<Line.size() && std::isspace(Line[pos])) pos++;
+      const size_t iStart(pos);
+      while(pos<Line.size() && !std::isspace(Line[pos])) pos++;
+      const std::string Item=Line.substr(iStart,pos-iStart);
+
+      double V;
+      size_t prec;
+      if (Item.empty() || !tableNumber(Item,V,prec) ||
+	  std::find(Cols.begin(),Cols.end(),pos)==Cols.end())
+	Out+=Line.substr(start,pos-start);
+      else
+	// keep the right edge of the column
+	Out+=scaleItem(Item,F,pos-start);
+    }
+  return Out;
+}
+
+void
+cellRunner::scaleTable(const boost::filesystem::path& Src,
+		       const boost::filesystem::path& Dest,
+		       const double F)
+  /*!
+    Write a copy of a table with the values in the time
+    columns multiplied by F. A table with values but no
+    time header cannot be scaled and is an error.
+    \param Src :: Table to copy
+    \param Dest :: New table
+    \param F :: Factor
+  */
+{
+  std::ifstream IX(Src.string().c_str());
+  std::ofstream OX(Dest.string().c_str(),std::ios::trunc);
+  bool good(IX.is_open() && OX.is_open());
+  int errNum((errno) ? errno : EIO);
+  if (good)
+    {
+      std::vector<size_t> Cols;
+      bool header(0);
+      bool values(0);
+      std::string Line;
+      while(std::getline(IX,Line))
+	{
+	  if (timeColumns(Line,Cols))
+	    {
+	      header=1;
+	      OX<<Line<<"\n";
+	      continue;
+	    }
+	  if (!header)
+	    {
+	      std::istringstream cx(Line);
+	      std::string Item;
+	      double V;
+	      size_t prec;
+	      while(!values && cx>>Item)
+		values=tableNumber(Item,V,prec);
+	    }
+	  OX<<scaleLine(Line,F,Cols)<<"\n";
+	}
+      OX.close();
+      good=!OX.fail() && !IX.bad() && (header || !values);
+      if (!header && values)
+	errNum=EINVAL;
+    }
+  if (!good)
+    throw boost::filesystem::filesystem_error
+      ("scaleTable",Src,Dest,boost::system::error_code
+       (errNum,boost::system::generic_category()));
+  return;
+}
+
+void
+cellRunner::scaleStats(const boost::filesystem::path& Table,
+		       const boost::filesystem::path& Src,
+		       const boost::filesystem::path& Dest,
+		       const double F)
+  /*!
+    Write a copy of a statistics file of a table [sampleStats :
+    the numbers of each line are those of the table, in
+    order, rewritten] with the numbers that are values in
+    the time columns of the table multiplied by F [as
+    scaleTable]. The columns are found from the table as
+    the statistics are not in its layout.
+    \param Table :: Table the statistics are of
+    \param Src :: Statistics file to copy
+    \param Dest :: New statistics file
+    \param F :: Factor
+  */
+{
+  std::ifstream TX(Table.string().c_str());
+  std::ifstream IX(Src.string().c_str());
+  std::ofstream OX(Dest.string().c_str(),std::ios::trunc);
+  bool good(TX.is_open() && IX.is_open() && OX.is_open());
+  int errNum((errno) ? errno : EIO);
+  if (good)
+    {
+      std::vector<size_t> Cols;
+      bool header(0);
+      bool values(0);
+      bool layout(1);
+      std::string Line,TLine;
+      while(std::getline(IX,Line))
+	{
+	  if (!std::getline(TX,TLine))
+	    {
+	      layout=0;
+	      break;
+	    }
+	  if (timeColumns(TLine,Cols))
+	    {
+	      header=1;
+	      OX<<Line<<"\n";
+	      continue;
+	    }
+	  // numbers of the table line : scaled or not
+	  std::vector<bool> Scale;
+	  size_t pos(0);
+	  while(pos<TLine.size())
+	    {
+	      while(pos<TLine.size() && std::isspace(TLine[pos])) pos++;
+	      const size_t iStart(pos);
+	      while(pos<TLine.size() && !std::isspace(TLine[pos])) pos++;
+	      const std::string Item=TLine.substr(iStart,pos-iStart);
+	      double V;
+	      size_t prec;
+	      if (Item.empty() || !StrFunc::convert(Item,V))
+		continue;
+	      const bool tFlag(tableNumber(Item,V,prec));
+	      values|=(tFlag && !header);
+	      Scale.push_back
+		(tFlag && std::find(Cols.begin(),Cols.end(),pos)!=Cols.end());
+	    }
+
+	  std::string Out;
+	  size_t index(0);
+	  pos=0;
+	  while(pos<Line.size())
+	    {
+	      const size_t start(pos);
+	      while(pos<Line.size() && std::isspace(Line[pos])) pos++;
+	      const size_t iStart(pos);
+	      while(pos<Line.size() && !std::isspace(Line[pos])) pos++;
+	      const std::string Item=Line.substr(iStart,pos-iStart);
+	      double V;
+	      if (Item.empty() || !StrFunc::convert(Item,V))
+		Out+=Line.substr(start,pos-start);
+	      else if (index>=Scale.size())
+		{
+		  layout=0;
+		  Out+=Line.substr(start,pos-start);
+		}
+	      else
+		Out+=(Scale[index++]) ? scaleItem(Item,F,pos-start) :
+		  Line.substr(start,pos-start);
+	    }
+	  layout&=(index==Scale.size());
+	  OX<<Out<<"\n";
+	}
+      OX.close();
+      good=!OX.fail() && !IX.bad() && layout && (header || !values);
+      if (!layout || (!header && values))
+	errNum=EINVAL;
+    }
+  if (!good)
+    throw boost::filesystem::filesystem_error
+      ("scaleStats",Src,Dest,boost::system::error_code
+       (errNum,boost::system::generic_category()));
+  return;
+}
+
+bool
+cellRunner::tableValues(const boost::filesystem::path& FName,
+			std::vector<double>& Values)
+  /*!
+    Read the values in the time columns of a table [as
+    scaleTable]
+    \param FName :: Table
+    \param Values :: Values in file order
+    \return true if the table was read
+  */
+{
+  Values.clear();
+  std::ifstream IX(FName.string().c_str());
+  if (!IX.good()) return 0;
+
+  std::vector<size_t> Cols;
+  std::string Line;
+  while(std::getline(IX,Line))
+    {
+      if (timeColumns(Line,Cols))
+	continue;
+      size_t pos(0);
+      while(pos<Line.size())
+	{
+	  while(pos<Line.size() && std::isspace(Line[pos])) pos++;
+	  const size_t iStart(pos);
+	  while(pos<Line.size() && !std::isspace(Line[pos])) pos++;
+	  double V;
+	  size_t prec;
+	  if (pos>iStart &&
+	      std::find(Cols.begin(),Cols.end(),pos)!=Cols.end() &&
+	      tableNumber(Line.substr(iStart,pos-iStart),V,prec))
+	    Values.push_back(V);
+	}
+    }
+  return 1;
+}
+
+double
+cellRunner::tableDeviation(const std::string& ADir,const std::string& BDir,
+			   const double F)
+  /*!
+    Largest relative difference between the tables of a
+    run [BDir] and the tables of another run [ADir] times F.
+    Values below 1e-6 of the largest value of a table are
+    not compared [rounding].
+    \param ADir :: Directory of the run to scale
+    \param BDir :: Directory of the run to compare
+    \param F :: Factor on the values of ADir
+    \return max relative difference [-1 : tables differ in layout]
+  */
+{
+  namespace BF=boost::filesystem;
+
+  double Out(0.0);
+  boost::system::error_code EC;
+  for(BF::directory_iterator di(ADir,EC);di!=BF::directory_iterator();di++)
+    {
+      const std::string FName=di->path().filename().string();
+      if (!isTable(FName)) continue;
+
+      std::vector<double> AV,BV;
+      if (!tableValues(di->path(),AV) ||
+	  !tableValues(BF::path(BDir) / FName,BV) ||
+	  AV.size()!=BV.size())
+	return -1.0;
+
+      double maxV(0.0);
+      for(const double V : BV)
+	maxV=std::max(maxV,std::abs(V));
+      for(size_t i=0;i<AV.size();i++)
+	{
+	  const double A(F*AV[i]);
+	  const double D=std::max(std::abs(A),std::abs(BV[i]));
+	  if (D>1e-6*maxV)
+	    Out=std::max(Out,std::abs(A-BV[i])/D);
+	}
+    }
+  return Out;
+}
+
+double
+cellRunner::tableScale(const cellJob& SJ,const cellJob& CJ)
+  /*!
+    Factor on the table values of SJ for a copy CJ : the
+    flux scale times the volume ratio [tables are cell totals]
+    \param SJ :: Source job
+    \param CJ :: Copy
+    \return factor
+  */
+{
+  return (SJ.volume>0.0) ?
+    CJ.fluxScale*CJ.volume/SJ.volume : CJ.fluxScale;
+}
+
+bool
+cellRunner::copyResults(const cellJob& SJ,const cellJob& CJ)
+  /*!
+    Copy the result files of job SJ into the directory of
+    job CJ. The tables [tabs/tabN] hold cell totals, so for
+    a scaled copy or a copy of a cell of another volume they
+    are written with the values multiplied by the flux scale
+    times the volume ratio. The other results are those of
+    SJ. The factors are recorded in a scale file.
+    \param SJ :: Source job
+    \param CJ :: Job to receive the results
+    \return true on success
+  */
+{
+  ELog::RegMethod RegA("cellRunner","copyResults");
+
+  namespace BF=boost::filesystem;
+
+  const double F=tableScale(SJ,CJ);
+  const bool scaleFlag(CJ.sourceCell && F!=1.0);
+  try
+    {
+      for(BF::directory_iterator di(SJ.dirName);
+	  di!=BF::directory_iterator();di++)
+	{
+	  const std::string FName=di->path().filename().string();
+	  if (!BF::is_regular_file(di->status()) ||
+	      !resultCache::isResult(FName))
+	    continue;
+	  if (scaleFlag && isTable(FName))
+	    scaleTable(di->path(),BF::path(CJ.dirName) / FName,F);
+	  else
+	    resultCache::copyFile(di->path(),BF::path(CJ.dirName) / FName);
+	}
+      std::ofstream OX((BF::path(CJ.dirName) /
+			CJ.cinderLog()).string().c_str());
+      if (!CJ.isScaled() && !scaleFlag)
+	OX<<"Results copied from cell "<<SJ.cellN
+	  <<" [same problem]"<<std::endl;
+      else
+	{
+	  OX<<"Results copied from cell "<<SJ.cellN
+	    <<" [scaled : see scale]"<<std::endl;
+	  std::ofstream SX((BF::path(CJ.dirName) / "scale").string().c_str());
+	  SX<<"# time columns of the tables [tabs/tabN] are those of "
+	    "the source cell multiplied by table_scale [flux_scale x "
+	    "volume_ratio] : other results are unscaled"<<std::endl;
+	  SX<<"source "<<SJ.cellN<<std::endl;
+	  SX<<"flux_scale "<<CJ.fluxScale<<std::endl;
+	  SX<<"volume_ratio "<<CJ.volume/SJ.volume<<std::endl;
+	  SX<<"table_scale "<<F<<std::endl;
+	  SX<<"error_bound "<<CJ.errorBound<<std::endl;
+	  SX.close();
+	  if (SX.fail())
+	    throw BF::filesystem_error
+	      ("scale",BF::path(CJ.dirName),boost::system::error_code
+	       (EIO,boost::system::generic_category()));
+	}
+    }
+  catch (BF::filesystem_error& EX)
+    {
+      ELog::EM<<"Failed to copy results of cell "<<SJ.cellN
+	      <<" : "<<EX.what()<<ELog::endCrit;
+      return 0;
+    }
+  return 1;
+}
+
+void
+cellRunner::fanOut(const size_t index)
+  /*!
+    Give the copies of job index its result files. The
+    copies take the status of the source cell. Approximate
+    copies get the tables scaled by their flux scale.
+    \param index :: Index in Jobs of the source cell
+  */
+{
+  ELog::RegMethod RegA("cellRunner","fanOut");
+
+  namespace BF=boost::filesystem;
+
+  typedef std::multimap<std::pair<std::string,int>,size_t>::const_iterator
+    MTYPE;
+  const std::pair<MTYPE,MTYPE> Range=Copies.equal_range
+    (std::pair<std::string,int>(Jobs[index].group,Jobs[index].cellN));
+  for(MTYPE mc=Range.first;mc!=Range.second;mc++)
+    {
+      const cellJob& SJ(Jobs[index]);
+      cellJob& CJ(Jobs[mc->second]);
+      CJ.startTime=SJ.endTime;
+      CJ.status=SJ.status;
+      CJ.cinderExit=SJ.cinderExit;
+      CJ.tabcodeExit=SJ.tabcodeExit;
+      if (Writer)
+	Writer(CJ);
+      if (!BF::is_directory(CJ.dirName))
+	CJ.status|=4;
+
+      if (!CJ.status && !copyResults(SJ,CJ))
+	CJ.status|=16;
+      if (Cache || getJournal(CJ))
+	CJ.hashKey=resultCache::problemKey(CJ.dirName);
+      CJ.endTime=getTime();
+      collect(mc->second);
+    }
+  return;
+}
+
+bool
+cellRunner::retryJob(const size_t index)
+  /*!
+    Queue a failed job to be run again after a delay.
+    Only run failures are re-run [not directory/copy back
+    failures, copies or stopped jobs].
+    \param index :: Index in Jobs
+    \return true if the job is to be re-run
+  */
+{
+  ELog::RegMethod RegA("cellRunner","retryJob");
+
+  cellJob& CJ(Jobs[index]);
+  if (CJ.nTry>maxRetry || stopLevel || CJ.sourceCell ||
+      !(CJ.status & (1 | 2 | 8 | 32)) || (CJ.status & (4 | 16 | 64)))
+    return 0;
+
+  const double delay=retryDelay*std::pow(2.0,static_cast<double>(CJ.nTry-1));
+  ELog::EM<<"Cell "<<CJ.cellN<<" "<<CJ.statusString()<<" : re-run "
+	  <<CJ.nTry<<" of "<<maxRetry<<" in "<<delay<<" s"<<ELog::endWarn;
+
+  // outputs of the failed run must not pass for a good run
+  const boost::filesystem::path BDir(CJ.dirName);
+  for(const std::string& OName : cellJob::expectedOutputs())
+    {
+      boost::system::error_code errCode;
+      boost::filesystem::remove(BDir / OName,errCode);
+    }
+  CJ.stage=0;
+  CJ.status= -1;
+  CJ.cinderExit= -1;
+  CJ.tabcodeExit= -1;
+  CJ.runDir=CJ.dirName;
+  Delayed.emplace(getTime()+delay,index);
+  return 1;
+}
+
+void
+cellRunner::checkStop()
+  /*!
+    Act on a stop signal : jobs not started are not run
+    [status 64] and at level 2 the running jobs are killed
+  */
+{
+  ELog::RegMethod RegA("cellRunner","checkStop");
+
+  const int level=runProgs::stopLevel();
+  if (level<=stopLevel) return;
+  stopLevel=level;
+
+  std::vector<size_t> notRun(Pending.begin(),Pending.end());
+  notRun.insert(notRun.end(),Ready.begin(),Ready.end());
+  for(const std::pair<const double,size_t>& DI : Delayed)
+    notRun.push_back(DI.second);
+  Pending.clear();
+  Ready.clear();
+  Delayed.clear();
+  for(const size_t index : notRun)
+    {
+      Jobs[index].status=64;
+      Jobs[index].startTime=getTime();
+      finish(index);
+    }
+
+  if (stopLevel==1)
+    {
+      ELog::EM<<"Stop : "<<notRun.size()<<" cells not started, "
+	      <<Active.size()<<" running cells finish "
+	      <<"[signal again to kill]"<<ELog::endWarn;
+      return;
+    }
+
+  runProgs& RP=runProgs::Instance();
+  size_t cnt(0);
+  for(const std::pair<const pid_t,size_t>& AI : Active)
+    if (Jobs[AI.second].stage<3)
+      {
+	Jobs[AI.second].status|=64;
+	RP.killChild(AI.first,SIGTERM);
+	cnt++;
+      }
+  killTime=getTime();
+  ELog::EM<<"Stop : "<<notRun.size()<<" cells not started, "
+	  <<cnt<<" running cells killed"<<ELog::endWarn;
+  return;
+}
+
+void
+cellRunner::checkLimits()
+  /*!
+    Kill the runs over the wall time limit and the killed
+    runs that ignore SIGTERM
+  */
+{
+  ELog::RegMethod RegA("cellRunner","checkLimits");
+
+  const double killGrace(10.0);
+  const double T=getTime();
+  runProgs& RP=runProgs::Instance();
+  for(const std::pair<const pid_t,size_t>& AI : Active)
+    {
+      cellJob& CJ(Jobs[AI.second]);
+      if (!CJ.stage || CJ.stage>2) continue;
+      if (wallLimit>0.0 && !(CJ.status & 32) &&
+	  T-CJ.startTime>wallLimit)
+	{
+	  ELog::EM<<"Cell "<<CJ.cellN<<" over the time limit of "
+		  <<wallLimit<<" s : killed"<<ELog::endWarn;
+	  CJ.status|=32;
+	  RP.killChild(AI.first,SIGKILL);
+	}
+      else if (stopLevel>1 && T-killTime>killGrace)
+	RP.killChild(AI.first,SIGKILL);
+    }
+  return;
+}
+
+double
+cellRunner::nextEvent() const
+  /*!
+    Time to the next time limit, kill or re-run
+    \return time [sec / 0 : none]
+  */
+{
+  const double T=getTime();
+  double Out(-1.0);
+  if (!Delayed.empty())
+    Out=Delayed.begin()->first;
+  for(const std::pair<const pid_t,size_t>& AI : Active)
+    {
+      const cellJob& CJ(Jobs[AI.second]);
+      if (!CJ.stage || CJ.stage>2) continue;
+      if (wallLimit>0.0 && !(CJ.status & 32) &&
+	  (Out<0.0 || CJ.startTime+wallLimit<Out))
+	Out=CJ.startTime+wallLimit;
+      if (stopLevel>1 && (Out<0.0 || killTime+10.0<Out))
+	Out=killTime+10.0;
+    }
+  if (Out<0.0) return 0.0;
+  return std::max(Out-T,1e-3);
+}
+
+bool
+cellRunner::reapJob(const bool blockFlag,const double maxWait)
+  /*!
+    Collect finished stages and start the next stage
+    \param blockFlag :: wait for a stage to finish
+    \param maxWait :: Longest wait [sec / 0 : no limit]
+    \return true if a stage finished
+  */
+{
+  ELog::RegMethod RegA("cellRunner","reapJob");
+
+  if (Active.empty()) return 0;
+
+  runProgs& RP=runProgs::Instance();
+  RP.reapChildren(blockFlag,maxWait);
+
+  std::vector<std::pair<size_t,int>> doneItems;
+  std::map<pid_t,size_t>::iterator mc=Active.begin();
+  while(mc!=Active.end())
+    {
+      int exitCode;
+      if (RP.checkChild(mc->first,exitCode))
+	{
+	  doneItems.push_back(std::pair<size_t,int>(mc->second,exitCode));
+	  mc=Active.erase(mc);
+	}
+      else
+	mc++;
+    }
+  for(const std::pair<size_t,int>& DI : doneItems)
+    advance(DI.first,DI.second);
+  
+  return !doneItems.empty();
+}
+
+void
+cellRunner::addJob(const cellJob& CJ)
+  /*!
+    Queue a job : it is run by waitAll
+    \param CJ :: Job [input deck written by Writer if set]
+  */
+{
+  ELog::RegMethod RegA("cellRunner","addJob");
+
+  Jobs.push_back(CJ);
+  if (Writer)
+    Pending.push_back(Jobs.size()-1);
+  else
+    Ready.push_back(Jobs.size()-1);
+  return;
+}
+
+void
+cellRunner::addCopy(const cellJob& CJ,const int srcCell)
+  /*!
+    Queue a job that is not run but takes the results
+    of another job of the same group [with the same problem]
+    \param CJ :: Job [input deck written by Writer if set]
+    \param srcCell :: Cell number of the job to copy
+  */
+{
+  ELog::RegMethod RegA("cellRunner","addCopy");
+
+  Jobs.push_back(CJ);
+  Jobs.back().sourceCell=srcCell;
+  Copies.emplace(std::pair<std::string,int>(CJ.group,srcCell),
+		 Jobs.size()-1);
+  return;
+}
+
+void
+cellRunner::waitAll()
+  /*!
+    Run the queued jobs through the stages until all are
+    collected. Free workers are filled first, then one
+    job is collected and one deck started per pass. Decks
+    are written by child processes [prepare], so the main
+    process works while the children run. It only
+    blocks when there is nothing else to do [until the
+    next time limit or re-run]. SIGINT/SIGTERM must be
+    caught by the caller [runProgs::catchSignals] for the
+    runner to stop cleanly.
+  */
+{
+  ELog::RegMethod RegA("cellRunner","waitAll");
+
+  while(!Pending.empty() || !Ready.empty() || !Delayed.empty() ||
+	!Active.empty() || !Collect.empty())
+    {
+      checkStop();
+      bool work=reapJob(0,0.0);
+      checkLimits();
+      while(!Delayed.empty() && Delayed.begin()->first<=getTime())
+	{
+	  Ready.push_back(Delayed.begin()->second);
+	  Delayed.erase(Delayed.begin());
+	}
+      // staged jobs can pass one waiting for scratch space
+      std::deque<size_t>::iterator rc=Ready.begin();
+      while(rc!=Ready.end())
+	{
+	  const size_t index= *rc;
+	  if (canLaunch(Jobs[index]))
+	    {
+	      rc=Ready.erase(rc);
+	      launch(index);
+	      work=1;
+	    }
+	  else
+	    rc++;
+	}
+      if (!Collect.empty())
+	{
+	  const size_t index=Collect.front();
+	  Collect.pop_front();
+	  collect(index);
+	  work=1;
+	}
+      if (!Pending.empty() && Ready.size()+nDeck<nWorkers)
+	{
+	  const size_t index=Pending.front();
+	  Pending.pop_front();
+	  prepare(index);
+	  work=1;
+	}
+      if (!work && !Active.empty())
+	reapJob(1,nextEvent());
+      else if (!work && !Delayed.empty())
+	{
+	  // only re-runs waiting : a signal ends the sleep
+	  const double W=nextEvent();
+	  struct timespec TS;
+	  TS.tv_sec=static_cast<time_t>(W);
+	  TS.tv_nsec=static_cast<long int>
+	    (1e9*(W-static_cast<double>(TS.tv_sec)));
+	  nanosleep(&TS,0);
+	}
+    }
+  return;
+}
+
+size_t
+cellRunner::nFailed() const
+  /*!
+    Count the failed jobs
+    \return number of failed jobs
+  */
+{
+  size_t cnt(0);
+  for(const cellJob& CJ : Jobs)
+    if (CJ.status) cnt++;
+  return cnt;
+}
+
+void
+cellRunner::writeStatus(std::ostream& OX) const
+  /*!
+    Write the per-cell status table
+    \param OX :: Output stream
+  */
+{
+  boost::format FMT("%8d %|10t|%-16s %8.2f  %s");
+
+  OX<<"    Cell   Directory          Time(s)  Status"<<std::endl;
+  for(const cellJob& CJ : Jobs)
+    OX<<(FMT % CJ.cellN % CJ.dirName % CJ.runTime()
+	 % CJ.statusString())<<std::endl;
+  OX<<"Jobs: "<<Jobs.size()<<" Failed: "<<nFailed()
+    <<" Workers: "<<nWorkers<<std::endl;
+  return;
+}
@@ -167,6 +167,19 @@ cinderHistory::addLine(const std::string& AItem,
 }
 
 
+double
+cinderHistory::irradiation() const
+  /*!
+    Integral of the current over the history
+    \return sum of current * time [seconds]
+  */
+{
+  double sum(0.0);
+  for(size_t i=0;i<current.size();i++)
+    sum+=current[i]*std::abs(time[i])*
+      convertTime(std::string(1,timeUnit[i]));
+  return sum;
+}
 
 void
 cinderHistory::write(std::ostream& OX) const
@@ -33,6 +33,14 @@
 #include <functional>
 #include <iterator>
 #include <regex>
+#include <chrono>
+#include <thread>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
 
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
@@ -55,6 +63,9 @@
 #include "cinderHistory.h"
 #include "runProgs.h"
 #include "cellProduction.h"
+#include "htapeScan.h"
+#include "htapeSection.h"
+#include "htapeStream.h"
 #include "htapeProcess.h"
 
 
@@ -73,14 +84,18 @@ operator<<(std::ostream& OX,const htapeProcess& HT)
 
 
 htapeProcess::htapeProcess() :
-  nps(0)
+  nps(0),nWorkers(1),scratchDir("htapeScratch"),
+  maxCells(50),scanRate(1e8),cellTime(0.01),streamFlag(0)
   /*!
     Constructor
   */
 {}
 
 htapeProcess::htapeProcess(const htapeProcess& A) : 
-  nps(A.nps),cellProd(A.cellProd)
+  nps(A.nps),cellProd(A.cellProd),
+  nWorkers(A.nWorkers),scratchDir(A.scratchDir),
+  maxCells(A.maxCells),scanRate(A.scanRate),cellTime(A.cellTime),
+  streamFlag(A.streamFlag)
   /*!
     Copy constructor
     \param A :: htapeProcess to copy
@@ -99,6 +114,12 @@ htapeProcess::operator=(const htapeProcess& A)
     {
       nps=A.nps;
       cellProd=A.cellProd;
+      nWorkers=A.nWorkers;
+      scratchDir=A.scratchDir;
+      maxCells=A.maxCells;
+      scanRate=A.scanRate;
+      cellTime=A.cellTime;
+      streamFlag=A.streamFlag;
     }
   return *this;
 }
@@ -111,23 +132,180 @@ htapeProcess::~htapeProcess()
 
 
 void
-htapeProcess::processHTape(const std::map<int,double>& cellVols)
+htapeProcess::setWorkers(const size_t N)
   /*!
-    Process the htape
+    Set the number of htape passes to run at once
+    \param N :: Number of passes [min 1]
+  */
+{
+  nWorkers=(N) ? N : 1;
+  return;
+}
+
+void
+htapeProcess::setMaxCells(const size_t N)
+  /*!
+    Set the htape limit on cells per run
+    \param N :: Max cells [0 : no limit - all cells in one run]
+  */
+{
+  maxCells=N;
+  return;
+}
+
+void
+htapeProcess::setStream(const bool F)
+  /*!
+    Read the htape tables through a fifo while htape runs
+    \param F :: Stream flag
+  */
+{
+  streamFlag=F;
+  return;
+}
+
+void
+htapeProcess::setScratch(const std::string& SDir)
+  /*!
+    Set the scratch directory for the htape runs
+    \param SDir :: Directory [must not be shared by another run]
+  */
+{
+  scratchDir=SDir;
+  return;
+}
+
+double
+htapeProcess::predictTime(const size_t nBatch,const size_t nCells,
+			  const double fileSize) const
+  /*!
+    Predicted wall time to process nCells in nBatch batches.
+    Each pass reads the whole histp file and then does work
+    for each cell in the batch. 3*nBatch passes are shared
+    over nWorkers.
+    \param nBatch :: Number of batches
+    \param nCells :: Number of cells
+    \param fileSize :: Size of histp file [bytes]
+    \return time [sec]
+  */
+{
+  if (!nBatch) return 0.0;
+  const size_t batchCells((nCells+nBatch-1)/nBatch);
+  const size_t rounds((3*nBatch+nWorkers-1)/nWorkers);
+  return static_cast<double>(rounds)*
+    (fileSize/scanRate+static_cast<double>(batchCells)*cellTime);
+}
+
+size_t
+htapeProcess::planBatches(const size_t nCells,const double fileSize) const
+  /*!
+    Choose the number of batches. The minimum is set by the
+    htape cell limit (one scan of each tape for each batch). More
+    batches are only used if idle workers make it faster.
+    \param nCells :: Number of cells
+    \param fileSize :: Size of histp file [bytes]
+    \return number of batches
+  */
+{
+  if (!nCells) return 0;
+  const size_t minBatch=(maxCells) ?
+    (nCells+maxCells-1)/maxCells : 1;
+  
+  size_t bestBatch(minBatch);
+  double bestTime=predictTime(minBatch,nCells,fileSize);
+  for(size_t nB=minBatch+1;nB<=nCells && 3*nB<=3*minBatch+nWorkers;nB++)
+    {
+      const double T=predictTime(nB,nCells,fileSize);
+      // require a real gain since every batch rescans histp
+      if (T<0.95*bestTime)
+	{
+	  bestTime=T;
+	  bestBatch=nB;
+	}
+    }
+  return bestBatch;
+}
+
+void
+htapeProcess::updateModel(const std::vector<double>& passTime,
+			  const std::vector<size_t>& passCells,
+			  const double fileSize)
+  /*!
+    Update the scan rate / cell time from measured passes
+    using a least squares fit of T = fileSize/scanRate + N*cellTime
+    \param passTime :: Measured time of each pass
+    \param passCells :: Cells in each pass
+    \param fileSize :: Size of histp file [bytes]
+  */
+{
+  ELog::RegMethod RegA("htapeProcess","updateModel");
+
+  const size_t NP(passTime.size());
+  if (!NP || fileSize<=0.0) return;
+
+  double sumN(0.0),sumT(0.0),sumNN(0.0),sumNT(0.0);
+  for(size_t i=0;i<NP;i++)
+    {
+      const double N(static_cast<double>(passCells[i]));
+      sumN+=N;
+      sumT+=passTime[i];
+      sumNN+=N*N;
+      sumNT+=N*passTime[i];
+    }
+  const double NPD(static_cast<double>(NP));
+  const double det(NPD*sumNN-sumN*sumN);
+  double scanTime((sumT-cellTime*sumN)/NPD);
+  if (std::abs(det)>1e-6)
+    {
+      const double slope((NPD*sumNT-sumN*sumT)/det);
+      if (slope>0.0)
+	{
+	  cellTime=slope;
+	  scanTime=(sumT-slope*sumN)/NPD;
+	}
+    }
+  if (scanTime>1e-3)
+    scanRate=fileSize/scanTime;
+  return;
+}
+
+std::string
+htapeProcess::passDir(const std::string& batchDir,const size_t passIndex)
+  /*!
+    Directory used by one htape pass of a batch
+    \param batchDir :: Batch directory
+    \param passIndex :: pass [0-2 : int08/int14/int15]
+    \return directory name
+  */
+{
+  static const char* passName[]={"p08","p14","p15"};
+  return batchDir+"/"+passName[passIndex % 3];
+}
+
+void
+htapeProcess::processHTape(const std::string& batchDir,
+			   const std::map<int,double>& cellVols)
+  /*!
+    Write the htape input files for a batch. Each pass
+    has its own directory so the three can run at once
+    \param batchDir :: Directory for the batch
     \param cellVols :: Cell volumes
   */
 {
   ELog::RegMethod RegA("htapProcess","processHTape");
 
   typedef std::map<int,double> MTYPE;
+
+  for(size_t i=0;i<3;i++)
+    boost::filesystem::create_directories(passDir(batchDir,i));
   
   std::ofstream H8;
   std::ofstream H14;
   std::ofstream H15;
 
-  H8.open("int08");
-  H14.open("int14");
-  H15.open("int15");
+  H8.open((passDir(batchDir,0)+"/int08").c_str());
+  H14.open((passDir(batchDir,1)+"/int14").c_str());
+  H15.open((passDir(batchDir,2)+"/int15").c_str());
 
   std::string extra;
   H8<<"AUTOMATED ACTIVATION SCRIPT FOR ISOTOPE PRODUCTION DATA"<<std::endl;
@@ -153,254 +331,251 @@ htapeProcess::processHTape(const std::map<int,double>& cellVols)
   return;
 }
 
-void
-htapeProcess::readZaid(const size_t prodType,
-		       cellProduction& CProd,
-		       std::istream& IX)
-  /*!
-    Read production part of an htape output file
-    \param prodType :: Type of produciton [0-2]
-    \param CProd :: Cell production unit
-    \param IX :: Input stream
+std::vector<htapeSection>
+htapeProcess::findSections(std::istream& IX,const bool prodFlag,
+			   long int& npsFile)
+  /*!
+    First pass of an htape output file : find the byte range
+    of each cell section. Only the headers are tested so this
+    is fast compared to reading the rows.
+    Production/destruction sections end on the "complete" line
+    and the gas sections on the next case header.
+    Thread function : must not use ELog.
+    \param IX :: input stream
+    \param prodFlag :: production table [outt08/outt15]
+    \param npsFile :: number of histories [if found]
+    \return sections in file order
   */
 {
-  ELog::RegMethod RegA("htapeProcess","readZaid");
-
-  // find : z = 12 n = 12  1.4d-4 0.3 
-  std::regex zaidSearch("z =\\s*(\\d+)\\s*n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)");
-  std::regex midSearch("n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)");
-  std::string SLine=StrFunc::getLine(IX,512);
-
-  int z(0);
-  int n;
-  double frac,errFrac;
-  while(IX.good())
-    {
-      std::vector<std::string> Comp;
-      if (SLine.find("complete")!=std::string::npos)
-	return;
-      
-      if (StrFunc::StrSingleSplit(SLine,zaidSearch,Comp))
-	{
-	  if (StrFunc::section(Comp[0],z) &&
-	      StrFunc::section(Comp[1],n) &&
-	      StrFunc::sectionMCNPX(Comp[2],frac) &&
-	      StrFunc::sectionMCNPX(Comp[3],errFrac) )
-	    {
-	      CProd.cellIndexProd(prodType,z,n,0,frac,errFrac);
-	    }	  
-	}
-      else if (StrFunc::StrSingleSplit(SLine,midSearch,Comp))
-        {
-	  if (StrFunc::section(Comp[0],n) &&
-	      StrFunc::sectionMCNPX(Comp[1],frac) &&
-	      StrFunc::sectionMCNPX(Comp[2],errFrac) )
-	    {
-	      CProd.cellIndexProd(prodType,z,n,0,frac,errFrac);
-	    }	  
-        }
-      SLine=StrFunc::getLine(IX,512);
-    }
-      
-  ELog::EM<<"Returning on empty file"<<ELog::endDiag;
-  return;
-}
-
-long int 
-htapeProcess::readHeader(const size_t prodType,std::istream& IX,
-                         CTYPE& fileProd)  const
-   /*!
-     Read the header of a production type from the htape output
-     file
-     \param prodType :: type number 0-2
-     \param IX :: input stream
-   */
-{
-  ELog::RegMethod RegA("htapeProcess","readHeader");
-
-  
-  //  std::regex npsSearch("statistical degrees of freedom.*=\\s+(\\d+)");
-  //  std::regex caseSearch("^1\\s+case no.\\s+(\\d+)");
-  //  std::regex cellSearch("for cell:\\s*(\\d+)");
-
-  std::string npsSearch("statistical degrees of freedom.*=\\s+(\\d+)");
-  std::string caseSearch("^1\\s+case no.\\s+(\\d+)");
-  std::string cellSearch("for cell:\\s*(\\d+)");
-
-  long int npsFile(0);
-  int caseNum,cellNum;  
-  std::string SLine=StrFunc::getLine(IX,512);
-  size_t statusFlag(0);
-  cellProduction* CellPtr(0);     // cell point to use later:
-  size_t outCnt(0);
-  ELog::EM<<"htapeCells: "<<ELog::endDiag;
-  while (IX.good())
+  std::vector<htapeSection> Sect;
+  std::string SLine;
+  std::streamoff pos(0);
+  std::streamoff lineStart(0);
+  int caseNum,cellNum;
+  size_t statusFlag(prodFlag ? 0 : 1);
+  while(htapeSection::readLine(IX,pos,SLine))
     {
-
       switch (statusFlag)
 	{
         case 0:
-          if (StrFunc::StrComp(SLine,npsSearch,npsFile,0))
-            {
-              ELog::EM<<"NPS == "<<npsFile<<ELog::endDiag;
-              statusFlag=1;
-            }
+          if (StrFunc::StrComp(SLine,htapeScan::npsRegex(),npsFile,0))
+	    statusFlag=1;
+	  // FALLTHRU
 	case 1:
-	  if (StrFunc::StrComp(SLine,caseSearch,caseNum,0))
+	  if (htapeScan::caseLine(SLine,caseNum))
 	    {
+	      if (!Sect.empty() && !Sect.back().hasEnd())
+		Sect.back().setEnd(lineStart);
 	      statusFlag=2;
 	    }
 	  break;
 	case 2:  // cell number
-	  if (StrFunc::StrComp(SLine,cellSearch,cellNum,0))
+	  if (htapeScan::cellLine(SLine,cellNum))
 	    {
-	      CellPtr=findCellProd(fileProd,cellNum);
-	      statusFlag=3;
-	      ELog::EM<<"  "<<cellNum;
-	      if (!(++outCnt % 12)) ELog::EM<<ELog::endDiag;
-		      
+	      Sect.push_back(htapeSection(cellNum,pos));
+	      statusFlag=(prodFlag) ? 3 : 1;
 	    }
 	  break;
-
-	case 3: // production:
-	  readZaid(prodType,*CellPtr,IX);
-	  statusFlag=1;
+	case 3:  // table title
+	  statusFlag=4;
+	  break;
+	case 4:  // production rows
+	  if (SLine.find("complete")!=std::string::npos)
+	    {
+	      Sect.back().setEnd(pos);
+	      statusFlag=1;
+	    }
 	  break;
 	}
-      SLine=StrFunc::getLine(IX);
+      lineStart=pos;
     }
-  if (outCnt % 12) ELog::EM<<ELog::endDiag;
-  ELog::EM<<"CELL Total == "<<outCnt<<" "<<npsFile<<ELog::endDiag; 
-  return npsFile;
+  return Sect;
 }
 
-long int
-htapeProcess::procProduction(CTYPE& prodMap)
+void
+htapeProcess::scanTape(const std::string* FName,const bool prodFlag,
+		       std::vector<htapeSection>* Sect,long int* npsFile)
   /*!
-    Process the outt08 isotope production tape
-    \param prodMap :: production map to add results too
-    \return number of points
+    Find the sections of one htape output file.
+    Thread function : must not use ELog.
+    \param FName :: htape output file
+    \param prodFlag :: production table [outt08/outt15]
+    \param Sect :: Sections found
+    \param npsFile :: number of histories [if found]
   */
 {
-  ELog::RegMethod RegA("htapeProcess","procProduction");
-  std::ifstream IX;
-  IX.open("outt08");
-  
-  if (!IX.good())
-    throw ColErr::FileError(8,"outt08","File no open");
-  return readHeader(0,IX,prodMap);
+  std::ifstream IX(FName->c_str());
+  *Sect=findSections(IX,prodFlag,*npsFile);
+  return;
 }
 
 void
-htapeProcess::procGas(CTYPE& prodMap)
+htapeProcess::readBlock(const std::vector<std::string>* FNames,
+			std::vector<std::vector<htapeSection>>* Sect,
+			const size_t startIndex,const size_t step)
   /*!
-    Process the outt14 isotope gas production tape
-    \param prodMap :: production map to add results too
+    Read every step'th section from startIndex, counting the
+    sections of all the tapes in turn. Tape 1 [outt14] is the
+    gas table.
+    Thread function : must not use ELog.
+    \param FNames :: htape output file of each tape
+    \param Sect :: Sections to read [for each tape]
+    \param startIndex :: First section
+    \param step :: Section step
+  */
+{
+  size_t index(0);
+  for(size_t tIndex=0;tIndex<FNames->size();tIndex++)
+    {
+      std::vector<htapeSection>& TSect=(*Sect)[tIndex];
+      if (TSect.empty()) continue;
+      
+      std::ifstream IX((*FNames)[tIndex].c_str());
+      for(htapeSection& HS : TSect)
+	{
+	  if ((index++ % step)==startIndex)
+	    {
+	      if (tIndex==1)
+		HS.readGas(IX);
+	      else
+		HS.readZaid(IX);
+	    }
+	}
+    }
+  return;
+}
+
+void
+htapeProcess::readTapes(const std::vector<std::string>& FNames,
+			std::vector<std::vector<htapeSection>>& Sect,
+			std::vector<long int>& npsFile) const
+  /*!
+    Read the htape output files together. The sections of
+    each file are found on their own thread and then all the
+    sections are shared between up to nWorkers threads, so
+    reading three tapes costs little more than reading one.
+    Each section keeps its own rows so the order of the
+    results does not depend on the threads.
+    \param FNames :: htape output file of each tape [empty : skip]
+    \param Sect :: Sections read [for each tape]
+    \param npsFile :: number of histories [for each tape]
   */
 {
-  ELog::RegMethod RegA("htapeProcess","procGas");
-  std::ifstream IX;
-  IX.open("outt14");
+  ELog::RegMethod RegA("htapeProcess","readTapes");
 
-  const size_t prodType(0);   // PRODUCTION
-  if (!IX.good())
-    throw ColErr::FileError(14,"outt14","File no open");
+  Sect.clear();
+  Sect.resize(FNames.size());
+  npsFile.clear();
+  npsFile.resize(FNames.size(),0);
 
-  // lines are:
-  //     (hydrogen  deuterium  tritium   total h)
-  //     (helium-3  helium-4   total he  gas(h&he)
-  // followed by values + error
-  //
+  std::vector<std::thread> Pool;
+  for(size_t i=0;i<FNames.size();i++)
+    if (!FNames[i].empty())
+      Pool.push_back(std::thread(&htapeProcess::scanTape,&FNames[i],
+				 i!=1,&Sect[i],&npsFile[i]));
+  for(std::thread& T : Pool)
+    T.join();
+  Pool.clear();
 
-  std::string caseSearch("^1\\s+case no.\\s+(\\d+)");
-  std::string cellSearch("for cell:\\s*(\\d+)");
+  size_t nSect(0);
+  for(const std::vector<htapeSection>& TSect : Sect)
+    nSect+=TSect.size();
 
-  std::regex hydrogenSearch("^\\s+hydrogen\\s+deuterium");
-  std::regex heliumSearch("^\\s+helium-3\\s+helium-4");
-  
-  std::string SLine=StrFunc::getLine(IX,512);
-  size_t statusFlag(0);
-  cellProduction* CellPtr(0);     // cell point to use later:
+  const size_t NT=std::max<size_t>(1,std::min(nWorkers,nSect));
+  for(size_t i=1;i<NT;i++)
+    Pool.push_back(std::thread(&htapeProcess::readBlock,
+			       &FNames,&Sect,i,NT));
+  readBlock(&FNames,&Sect,0,NT);
+  for(std::thread& T : Pool)
+    T.join();
+  return;
+}
 
-  int caseNum,cellNum;
-  double A,B,C;
-  double AErr,BErr,CErr;
-  while (IX.good())
-    {
-      switch (statusFlag)
-	{
-	case 0:
-	  if (StrFunc::StrComp(SLine,caseSearch,caseNum,0))
-	    {
-	      statusFlag=1;
-	    }
-	  break;
-	case 1:  // cell number
-	  if (StrFunc::StrComp(SLine,cellSearch,cellNum,0))
-	    {
-	      CellPtr=findCellProd(prodMap,cellNum);
-	      statusFlag=2;
-	    }
-	  break;
-	case 2: // production:
-	  if (StrFunc::StrLook(SLine,hydrogenSearch))
-	    statusFlag=3;
-	  break;
-	case 3:  // read line
-	  if (StrFunc::sectionMCNPX(SLine,A) &&
-	      StrFunc::sectionMCNPX(SLine,AErr) &&
-	      StrFunc::sectionMCNPX(SLine,B) &&
-	      StrFunc::sectionMCNPX(SLine,BErr) &&
-	      StrFunc::sectionMCNPX(SLine,C) &&
-	      StrFunc::sectionMCNPX(SLine,CErr))
-	    {
-              // CHANGE HERE
-	      CellPtr->cellIndexProd(prodType,1,0,0,A,AErr);  // hydrogen
-	      CellPtr->cellIndexProd(prodType,1,1,0,B,BErr);  // deuterium
-	      CellPtr->cellIndexProd(prodType,1,2,0,C,CErr);  // tritium
-	      statusFlag=4;
-	    }
-	  break;
-	case 4: // production:
-	  if (StrFunc::StrLook(SLine,heliumSearch))
-	    statusFlag=5;
-	  else if (!StrFunc::isEmpty(SLine))
-	    ELog::EM<<"Failed line "<<SLine<<ELog::endDiag;
+void
+htapeProcess::addSections(const size_t prodType,
+			  const std::vector<htapeSection>& Sect,
+			  const long int npsFile,CTYPE& fileProd) const
+  /*!
+    Add the rows of the sections [in file order] to the cells
+    \param prodType :: type number 0-2
+    \param Sect :: Sections read
+    \param npsFile :: number of points [for the log]
+    \param fileProd :: production map to add results too
+   */
+{
+  ELog::RegMethod RegA("htapeProcess","addSections");
 
-	  break;
-	case 5:  // read line
-	  if (StrFunc::sectionMCNPX(SLine,A) &&
-	      StrFunc::sectionMCNPX(SLine,AErr) &&
-	      StrFunc::sectionMCNPX(SLine,B) &&
-	      StrFunc::sectionMCNPX(SLine,BErr) )
-	    {
-	      CellPtr->cellIndexProd(prodType,2,1,0,A,AErr);  // he-3
-	      CellPtr->cellIndexProd(prodType,2,2,0,B,BErr);  // he-4
-	    }
-	  statusFlag=0;
-	}
-      SLine=StrFunc::getLine(IX);
+  size_t outCnt(0);
+  size_t statusFlag(0);
+  ELog::EM<<"htapeCells: "<<ELog::endDiag;
+  for(const htapeSection& HS : Sect)
+    {
+      HS.addProd(prodType,*findCellProd(fileProd,HS.getCell()));
+      if (HS.getStatus())
+	statusFlag=HS.getStatus();
+      ELog::EM<<"  "<<HS.getCell();
+      if (!(++outCnt % 12)) ELog::EM<<ELog::endDiag;
     }
+  if (outCnt % 12) ELog::EM<<ELog::endDiag;
+  for(const htapeSection& HS : Sect)
+    for(const std::string& Line : HS.getBadLines())
+      ELog::EM<<"Failed line "<<Line<<ELog::endDiag;
   if (statusFlag!=0)
     ELog::EM<<"Failed to read gas production file statusFlag="
 	    <<statusFlag<<ELog::endErr;
+  ELog::EM<<"CELL Total == "<<outCnt<<" "<<npsFile<<ELog::endDiag; 
   return;
 }
 
-void
-htapeProcess::procDestruction(CTYPE& prodMap)
+long int
+htapeProcess::procTapes(const std::string& batchDir,const size_t bIndex,
+			const std::map<size_t,htapeStream>& Streams,
+			CTYPE& prodMap) const
   /*!
-    Process the outt15 isotope destruction tape
+    Process the outt08 production, outt14 gas and outt15
+    destruction tapes of a batch. Tapes that were streamed
+    are already read, the rest are read from file together.
+    The results are added in tape order [cellIndexProd 0/1/2].
+    \param batchDir :: Directory of the htape batch
+    \param bIndex :: Batch index [stream key : 3*bIndex+tape]
+    \param Streams :: Stream readers
+    \param prodMap :: production map to add results too
+    \return number of points [from the production tape]
   */
 {
-  ELog::RegMethod RegA("htapeProcess","procDestruction");
-  std::ifstream IX;
-  IX.open("outt15");
-  
-  if (!IX.good())
-    throw ColErr::FileError(15,"outt15","File no open");
-  readHeader(2,IX,prodMap);
-  return;
+  ELog::RegMethod RegA("htapeProcess","procTapes");
+
+  static const char* intNum[]={"08","14","15"};
+  static const int tapeNum[]={8,14,15};
+
+  std::vector<std::string> FNames(3);
+  for(size_t i=0;i<3;i++)
+    if (Streams.find(3*bIndex+i)==Streams.end())
+      {
+	FNames[i]=passDir(batchDir,i)+"/outt"+intNum[i];
+	if (!std::ifstream(FNames[i].c_str()).good())
+	  throw ColErr::FileError(tapeNum[i],"outt"+std::string(intNum[i]),
+				  "File no open");
+      }
+
+  std::vector<std::vector<htapeSection>> Sect;
+  std::vector<long int> npsFile;
+  readTapes(FNames,Sect,npsFile);
+
+  for(size_t i=0;i<3;i++)
+    {
+      std::map<size_t,htapeStream>::const_iterator mc=
+	Streams.find(3*bIndex+i);
+      if (mc!=Streams.end())
+	{
+	  npsFile[i]=mc->second.getNPS();
+	  Sect[i]=mc->second.getSections();
+	}
+      if (!i && npsFile[i])
+	ELog::EM<<"NPS == "<<npsFile[i]<<ELog::endDiag;
+      addSections(i,Sect[i],npsFile[i],prodMap);
+    }
+  return npsFile[0];
 }
 
 cellProduction*
@@ -496,11 +671,112 @@ htapeProcess::addCells(const long int newNPS,
   return;
 }
 		       
+int
+htapeProcess::openStream(const std::string& FName)
+  /*!
+    Make a fifo for an htape output table and open it for
+    reading [non-blocking, so that htape can open it at once]
+    \param FName :: Output table name
+    \return file descriptor / -1 if a normal file must be used
+  */
+{
+  ELog::RegMethod RegA("htapeProcess","openStream");
+
+  ::unlink(FName.c_str());
+  if (::mkfifo(FName.c_str(),0600))
+    {
+      ELog::EM<<"No fifo for "<<FName<<" : using file"<<ELog::endWarn;
+      return -1;
+    }
+  const int fd=::open(FName.c_str(),O_RDONLY | O_NONBLOCK);
+  if (fd<0)
+    {
+      ELog::EM<<"Failed to open fifo "<<FName<<" : using file"
+	      <<ELog::endWarn;
+      ::unlink(FName.c_str());
+    }
+  return fd;
+}
+
+int
+htapeProcess::readStream(const int fd,htapeStream& HS)
+  /*!
+    Read the data waiting on a fifo. At most 1MB is read
+    so that one busy pass does not hold up the others.
+    \param fd :: File descriptor
+    \param HS :: Stream reader
+    \return 0 at end of file / 1 data read / 2 nothing waiting
+  */
+{
+  char Buffer[65536];
+  int flag(2);
+  for(size_t i=0;i<16;i++)
+    {
+      const ssize_t N=::read(fd,Buffer,sizeof(Buffer));
+      if (N>0)
+	{
+	  HS.addData(Buffer,static_cast<size_t>(N));
+	  flag=1;
+	}
+      else if (!N)
+	return 0;
+      else if (errno!=EINTR)
+	return flag;
+    }
+  return flag;
+}
+
+bool
+htapeProcess::pollStreams(std::map<size_t,int>& streamFD,
+			  std::map<size_t,htapeStream>& Streams)
+  /*!
+    Wait [up to 0.1 sec] for htape output on the fifos and
+    read what has arrived. A fifo at end of file is kept open
+    [fd set negative] until its htape pass is collected.
+    \param streamFD :: File descriptor of each pass
+    \param Streams :: Stream reader of each pass
+    \return true if any fifo is still open [not at end of file]
+  */
+{
+  std::vector<struct pollfd> PFD;
+  std::vector<size_t> passIndex;
+  for(const std::map<size_t,int>::value_type& SF : streamFD)
+    if (SF.second>=0)
+      {
+	struct pollfd P;
+	P.fd=SF.second;
+	P.events=POLLIN;
+	P.revents=0;
+	PFD.push_back(P);
+	passIndex.push_back(SF.first);
+      }
+  if (PFD.empty())
+    return 0;
+  if (::poll(&PFD[0],PFD.size(),100)<=0)
+    return 1;
+
+  bool liveFlag(0);
+  for(size_t i=0;i<PFD.size();i++)
+    if (PFD[i].revents &&
+	!readStream(PFD[i].fd,Streams.at(passIndex[i])))
+      streamFD[passIndex[i]]= -PFD[i].fd-1;
+    else
+      liveFlag=1;
+  return liveFlag;
+}
+
 void
 htapeProcess::addSProdFile(const std::string& htapeFile,
                            const std::map<int,double>& cellVols)
   /*!
-    Add the sprod file 
+    Add the sprod file. The cells are split into batches
+    and each htape pass of each batch runs in its own scratch
+    directory, so up to nWorkers passes run at once. A batch
+    is read as soon as its three passes are complete.
+    The number of batches comes from the cost model so that the
+    histp file is scanned as few times as possible.
+    With streamFlag the tables are fifos that are read while
+    htape runs, falling back to the file if that fails.
     \param htapeFile :: MCNPX htape output file
     \param cellVols :: Cell volumes file
    */ 
@@ -510,52 +786,250 @@ htapeProcess::addSProdFile(const std::string& htapeFile,
   // Check file:
   if (!boost::filesystem::exists(htapeFile))
     throw ColErr::FileError(0,"htape File:",htapeFile);
-  
+
+  typedef std::chrono::steady_clock CLOCK;
+
+  const std::string histpFile=
+    boost::filesystem::absolute(htapeFile).string();
+  const boost::filesystem::path topDir=
+    boost::filesystem::absolute(boost::filesystem::current_path());
+  const double fileSize=
+    static_cast<double>(boost::filesystem::file_size(histpFile));
+
+  static const char* intNum[]={"08","14","15"};
+  static const char* logNum[]={"8","14","15"};
   runProgs& RP=runProgs::Instance();
 
+  // Batches of cells [spread evenly]
+  const size_t nCells(cellVols.size());
+  const size_t nBatch=planBatches(nCells,fileSize);
+  const double predTime=predictTime(nBatch,nCells,fileSize);
+  ELog::EM<<"HTape plan: "<<nCells<<" cells in "<<nBatch
+	  <<" batches [limit "<<maxCells<<"] : histp "<<fileSize
+	  <<" bytes : predicted "<<predTime<<" sec"<<ELog::endDiag;
+
+  std::vector<std::string> batchDir;
+  std::vector<size_t> batchCells;
   std::map<int,double>::const_iterator mc=cellVols.begin();
+  while(mc!=cellVols.end())
+    {
+      const size_t bIndex(batchDir.size());
+      const size_t NC((nCells*(bIndex+1))/nBatch-(nCells*bIndex)/nBatch);
+      std::map<int,double> cellCut;
+      for(size_t i=0;i<NC && mc!=cellVols.end();i++)
+	cellCut.insert(*mc++);
+
+      batchDir.push_back(scratchDir+"/Batch"+
+			 StrFunc::makeString(bIndex+1));
+      batchCells.push_back(cellCut.size());
+      if (boost::filesystem::exists(batchDir.back()))
+	boost::filesystem::remove_all(batchDir.back());
+      processHTape(batchDir.back(),cellCut);
+    }
+
+  // Pending passes : [batch*3+pass]
+  const CLOCK::time_point startClock(CLOCK::now());
+  const size_t nPass(3*batchDir.size());
+  std::vector<size_t> passLeft(batchDir.size(),3);
+  std::map<pid_t,std::pair<size_t,CLOCK::time_point>> activeRun;
+  std::vector<double> passTime;
+  std::vector<size_t> passCells;
+  
+  std::map<size_t,int> streamFD;            // open fifos [-fd-1 : EOF]
+  std::map<size_t,htapeStream> Streams;      // readers of the fifos
 
-  long int npts;
-  size_t index(1);
+  long int npts(0);
   CTYPE fileProd;
-  while(mc!=cellVols.end())
+  size_t passIndex(0);
+  // no pass is started after a stop signal
+  while((passIndex<nPass && !runProgs::stopLevel()) || !activeRun.empty())
     {
-      for(const std::string& outName : {"outt08","outt14","outt15"})
+      while(passIndex<nPass && activeRun.size()<nWorkers &&
+	    !runProgs::stopLevel())
 	{
-	  if (boost::filesystem::exists(outName))
-	    boost::filesystem::remove(outName);
+	  const size_t bIndex(passIndex/3);
+	  const size_t pIndex(passIndex % 3);
+	  const std::string tape(intNum[pIndex]);
+	  const std::string logFile=(topDir /
+	    ("Out"+std::string(logNum[pIndex])+"_"+
+	     StrFunc::makeString(bIndex+1)+".log")).string();
+	  const int fd=(streamFlag) ?
+	    openStream(passDir(batchDir[bIndex],pIndex)+"/outt"+tape) : -1;
+	  const pid_t pid=
+	    RP.startHTape("int=int"+tape+" outt=outt"+tape+
+			  " histp="+histpFile,
+			  passDir(batchDir[bIndex],pIndex),logFile);
+	  if (pid<0)
+	    {
+	      ELog::EM<<"Failed on HTAPE int"<<tape<<ELog::endErr;
+	      passLeft[bIndex]--;
+	      if (fd>=0) ::close(fd);
+	    }
+	  else
+	    {
+	      activeRun.emplace(pid,std::make_pair(passIndex,CLOCK::now()));
+	      if (fd>=0)
+		{
+		  streamFD.emplace(passIndex,fd);
+		  Streams.emplace(passIndex,htapeStream(pIndex!=1));
+		}
+	    }
+	  passIndex++;
 	}
-      
-      std::map<int,double> cellCut;
-      for(size_t i=0;i<50 && mc!=cellVols.end();i++)
-	cellCut.insert(*mc++);
-	  
-      processHTape(cellCut);
-      std::string Out08,Out14,Out15;
-      if (index)
-        {
-          Out08="Out8_"+StrFunc::makeString(index)+".log";
-          Out14="Out14_"+StrFunc::makeString(index)+".log";
-          Out15="Out15_"+StrFunc::makeString(index)+".log";
-        }
-      if (RP.runHTape("int=int08 outt=outt08 histp="+htapeFile,Out08))
-	ELog::EM<<"Failed on HTAPE int08 "<<ELog::endErr;
-      if (RP.runHTape("int=int14 outt=outt14 histp="+htapeFile,Out14))
-        ELog::EM<<"Failed on HTAPE int14 "<<ELog::endErr;
-      if (RP.runHTape("int=int15 outt=outt15 histp="+htapeFile,Out15))
-        ELog::EM<<"Failed on HTAPE int15 "<<ELog::endErr;
-
-      npts=procProduction(fileProd);
-      //      procGas(fileProd);
-      //      procDestruction(fileProd);
-      index++;
+
+      // no fifo open : only the end of a pass can change anything
+      if (!pollStreams(streamFD,Streams))
+	RP.reapChildren(1,0.0);
+      else
+	RP.reapChildren(0,0.0);
+      std::map<pid_t,std::pair<size_t,CLOCK::time_point>>::iterator
+	ac=activeRun.begin();
+      while(ac!=activeRun.end())
+	{
+	  int exitCode;
+	  if (RP.checkChild(ac->first,exitCode))
+	    {
+	      const size_t bIndex(ac->second.first/3);
+	      const std::chrono::duration<double> DT=
+		CLOCK::now()-ac->second.second;
+	      std::map<size_t,int>::iterator sc=
+		streamFD.find(ac->second.first);
+	      if (sc!=streamFD.end())
+		{
+		  const int fd((sc->second<0) ? -sc->second-1 : sc->second);
+		  htapeStream& HS=Streams.at(sc->first);
+		  while(sc->second>=0 && readStream(fd,HS)==1) ;
+		  ::close(fd);
+		  HS.finish();
+		  // htape replaced the fifo with a file : read that
+		  const std::string outFile=
+		    passDir(batchDir[bIndex],sc->first % 3)+"/outt"+
+		    intNum[sc->first % 3];
+		  if (!HS.getNByte())
+		    {
+		      if (!boost::filesystem::is_regular_file(outFile))
+			{
+			  // procTapes fails on the missing file
+			  ELog::EM<<"No output from HTAPE int"
+				  <<intNum[sc->first % 3]<<" batch "
+				  <<bIndex+1<<" on "<<outFile<<ELog::endErr;
+			  boost::system::error_code errCode;
+			  boost::filesystem::remove(outFile,errCode);
+			}
+		      Streams.erase(sc->first);
+		    }
+		  streamFD.erase(sc);
+		}
+	      if (exitCode)
+		ELog::EM<<"Failed on HTAPE int"<<intNum[ac->second.first % 3]
+			<<" batch "<<bIndex+1<<ELog::endErr;
+	      else
+		{
+		  passTime.push_back(DT.count());
+		  passCells.push_back(batchCells[bIndex]);
+		}
+	      if (!--passLeft[bIndex])
+		{
+		  npts=procTapes(batchDir[bIndex],bIndex,Streams,fileProd);
+		  for(size_t i=0;i<3;i++)
+		    Streams.erase(3*bIndex+i);
+		  boost::filesystem::remove_all(batchDir[bIndex]);
+		}
+	      ac=activeRun.erase(ac);
+	    }
+	  else
+	    ac++;
+	}
+    }
+  boost::system::error_code errCode;
+  if (runProgs::stopLevel())
+    {
+      ELog::EM<<"HTape stopped by signal : "<<passIndex<<" of "
+	      <<nPass<<" passes started"<<ELog::endErr;
+      return;
     }
+  boost::filesystem::remove(scratchDir,errCode);
+
+  const std::chrono::duration<double> totalTime=CLOCK::now()-startClock;
+  updateModel(passTime,passCells,fileSize);
+  ELog::EM<<"HTape time: predicted "<<predTime<<" sec : actual "
+	  <<totalTime.count()<<" sec [scan rate "<<scanRate
+	  <<" bytes/sec : cell time "<<cellTime<<" sec]"<<ELog::endDiag;
+
   ELog::EM<<"Npts == "<<npts<<ELog::endDiag;
   addCells(npts,fileProd);
       
   return;
 }
 
+void
+htapeProcess::mergeCells(const int cellN,const std::vector<int>& Cells)
+  /*!
+    Replace the production of a set of cells by their sum
+    held under one cell [the others are removed]. The
+    production is per cell, not per volume, so it adds.
+    \param cellN :: Cell to hold the sum
+    \param Cells :: Cells to sum [cells with no production skipped]
+   */
+{
+  ELog::RegMethod RegA("htapeProcess","mergeCells");
+
+  cellProduction Sum;
+  bool found(0);
+  for(const int CN : Cells)
+    {
+      CTYPE::iterator mc=cellProd.find(CN);
+      if (mc!=cellProd.end())
+	{
+	  Sum+=mc->second;
+	  cellProd.erase(mc);
+	  found=1;
+	}
+    }
+  if (found)
+    cellProd.emplace(cellN,Sum);
+  return;
+}
+
+size_t
+htapeProcess::nProducts(const int cellN) const
+  /*!
+    Number of spallation product nuclides in a cell
+    \param cellN :: cell number
+    \return number of nuclides [0 if cell not found]
+   */
+{
+  CTYPE::const_iterator mc=cellProd.find(cellN);
+  return (mc==cellProd.end()) ? 0 : mc->second.nNuclide();
+}
+
+const cellProduction&
+htapeProcess::getCellProd(const int cellN) const
+  /*!
+    Get the production of a cell
+    \param cellN :: cell number
+    \return cell production
+   */
+{
+  ELog::RegMethod RegA("htapeProcess","getCellProd");
+
+  CTYPE::const_iterator mc=cellProd.find(cellN);
+  if (mc==cellProd.end())
+    throw ColErr::InContainerError<int>(cellN,"cellN in cellProd");
+  return mc->second;
+}
+
+std::map<int,double>
+htapeProcess::getSprods(const int cellN) const
+  /*!
+    Get the spallation products of a cell
+    \param cellN :: cell number
+    \return map of zaid : production
+   */
+{
+  return getCellProd(cellN).getSprods();
+}
+
 void
 htapeProcess::writeSprods(const std::string& FName,
                           const int cellN,
@@ -569,30 +1043,58 @@ htapeProcess::writeSprods(const std::string& FName,
 {
   ELog::RegMethod RegA("htapeProcess","writeSprods");
 
-  boost::format FMT("%s%|69t|V= %9.3e");
-  boost::format CellFMT("%s%d%|70t|%9.3e %9.3e");
-
-  CTYPE::const_iterator mc=cellProd.find(cellN);
-  if (mc==cellProd.end())
+  if (cellProd.find(cellN)==cellProd.end())
     throw ColErr::InContainerError<int>(cellN,"cellN in cellProd");
   
-  const DError::doubleErr Total=mc->second.getTotal();
-  
   if (FName.empty()) return;
   std::ofstream OX(FName.c_str());
+  writeSprods(OX,cellN,Vol);
+  OX.close();
+  return;
+}
+
+void
+htapeProcess::writeSprods(std::ostream& OX,
+                          const int cellN,
+			  const double Vol) const
+  /*!
+    Write out the production
+    \param OX :: Output stream
+    \param cellN :: cell number
+    \param Vol :: Volume
+   */
+{
+  ELog::RegMethod RegA("htapeProcess","writeSprods(ostream)");
+
+  writeSprods(OX,cellN,Vol,getCellProd(cellN));
+  return;
+}
+
+void
+htapeProcess::writeSprods(std::ostream& OX,const int cellN,
+			  const double Vol,const cellProduction& CP)
+  /*!
+    Write out a production
+    \param OX :: Output stream
+    \param cellN :: cell number
+    \param Vol :: Volume
+    \param CP :: Production of the cell
+   */
+{
+  boost::format FMT("%s%|69t|V= %9.3e");
+  boost::format CellFMT("%s%d%|70t|%9.3e %9.3e");
+
+  const DError::doubleErr Total=CP.getTotal();
   
   OX<<(FMT % "distribution of residual nuclei" % Vol)
     <<std::endl;
   OX<<(CellFMT % "in cells " % cellN % Total.getVal() % Total.getErr())
     <<std::endl;
   
-  mc->second.writeSprods(OX);
-  OX.close();
+  CP.writeSprods(OX);
   return;
 }
 
-
-
 void
 htapeProcess::write(std::ostream& OX) const
   /*!
@@ -0,0 +1,235 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/htapeScan.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <cctype>
+#include <climits>
+#include <string>
+#include <regex>
+
+#include "htapeScan.h"
+
+namespace htapeScan
+{
+
+static size_t
+skipSpace(const std::string& Line,size_t pos)
+  /*!
+    Move past white space [\\s]
+    \param Line :: Line to scan
+    \param pos :: Start position
+    \return first non-space position
+  */
+{
+  while(pos<Line.size() &&
+	std::isspace(static_cast<unsigned char>(Line[pos])))
+    pos++;
+  return pos;
+}
+
+static size_t
+readInt(const std::string& Line,size_t pos,int& Out)
+  /*!
+    Read an unsigned integer [\\d+]
+    \param Line :: Line to scan
+    \param pos :: Start position
+    \param Out :: Value found
+    \return position after the number / npos on failure
+  */
+{
+  long int V(0);
+  const size_t start(pos);
+  while(pos<Line.size() &&
+	std::isdigit(static_cast<unsigned char>(Line[pos])))
+    {
+      V=10*V+(Line[pos]-'0');
+      if (V>INT_MAX) return std::string::npos;
+      pos++;
+    }
+  if (pos==start) return std::string::npos;
+  Out=static_cast<int>(V);
+  return pos;
+}
+
+static size_t
+readToken(const std::string& Line,size_t pos,std::string& Out)
+  /*!
+    Read a non-space token [\\S+]
+    \param Line :: Line to scan
+    \param pos :: Start position
+    \param Out :: Token found
+    \return position after the token / npos on failure
+  */
+{
+  const size_t start(pos);
+  while(pos<Line.size() &&
+	!std::isspace(static_cast<unsigned char>(Line[pos])))
+    pos++;
+  if (pos==start) return std::string::npos;
+  Out=Line.substr(start,pos-start);
+  return pos;
+}
+
+static int
+nRow(const std::string& Line,size_t pos,int& N,
+     std::string& Frac,std::string& Err)
+  /*!
+    Match a production row from its "n =" part
+    [n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)]
+    \param Line :: Line to scan
+    \param pos :: Position of "n ="
+    \param N :: Neutron number
+    \param Frac :: Production
+    \param Err :: Relative error
+    \return 1 on match
+  */
+{
+  pos=skipSpace(Line,pos+3);
+  pos=readInt(Line,pos,N);
+  if (pos==std::string::npos) return 0;
+  size_t next=skipSpace(Line,pos);
+  if (next==pos) return 0;
+  pos=readToken(Line,next,Frac);
+  if (pos==std::string::npos) return 0;
+  next=skipSpace(Line,pos);
+  if (next==pos) return 0;
+  return (readToken(Line,next,Err)==std::string::npos) ? 0 : 1;
+}
+
+const std::regex&
+npsRegex()
+  /*!
+    Statistical degrees of freedom line
+    \return compiled regex
+  */
+{
+  static const std::regex Re("statistical degrees of freedom.*=\\s+(\\d+)");
+  return Re;
+}
+
+const std::regex&
+hydrogenRegex()
+  /*!
+    Hydrogen header of the gas table
+    \return compiled regex
+  */
+{
+  static const std::regex Re("^\\s+hydrogen\\s+deuterium");
+  return Re;
+}
+
+const std::regex&
+heliumRegex()
+  /*!
+    Helium header of the gas table
+    \return compiled regex
+  */
+{
+  static const std::regex Re("^\\s+helium-3\\s+helium-4");
+  return Re;
+}
+
+int
+caseLine(const std::string& Line,int& caseNum)
+  /*!
+    Match a case header [^1\\s+case no.\\s+(\\d+)]
+    \param Line :: Line to scan
+    \param caseNum :: Case number
+    \return 1 on match
+  */
+{
+  if (Line.empty() || Line[0]!='1') return 0;
+  size_t pos=skipSpace(Line,1);
+  if (pos==1 || Line.compare(pos,7,"case no")) return 0;
+  pos+=7;
+  // any character except a line end
+  if (pos>=Line.size() || Line[pos]=='\n' || Line[pos]=='\r')
+    return 0;
+  pos++;
+  const size_t next=skipSpace(Line,pos);
+  if (next==pos) return 0;
+  return (readInt(Line,next,caseNum)==std::string::npos) ? 0 : 1;
+}
+
+int
+cellLine(const std::string& Line,int& cellNum)
+  /*!
+    Match a cell header [for cell:\\s*(\\d+)]
+    \param Line :: Line to scan
+    \param cellNum :: Cell number
+    \return 1 on match
+  */
+{
+  size_t pos=Line.find("for cell:");
+  while(pos!=std::string::npos)
+    {
+      const size_t next=skipSpace(Line,pos+9);
+      if (next<Line.size() &&
+	  std::isdigit(static_cast<unsigned char>(Line[next])))
+	return (readInt(Line,next,cellNum)==std::string::npos) ? 0 : 1;
+      pos=Line.find("for cell:",pos+1);
+    }
+  return 0;
+}
+
+int
+zaidLine(const std::string& Line,int& Z,int& N,
+	 std::string& Frac,std::string& Err)
+  /*!
+    Match a production row. The first row of an element is
+    [z =\\s*(\\d+)\\s*n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)]
+    and the following rows only have the n part.
+    \param Line :: Line to scan
+    \param Z :: Atomic number [only set on a z row]
+    \param N :: Neutron number
+    \param Frac :: Production
+    \param Err :: Relative error
+    \return 2 on a z row / 1 on an n row / 0 no match
+  */
+{
+  size_t pos=Line.find("z =");
+  while(pos!=std::string::npos)
+    {
+      int zNum;
+      size_t next=readInt(Line,skipSpace(Line,pos+3),zNum);
+      if (next!=std::string::npos)
+	{
+	  next=skipSpace(Line,next);
+	  if (!Line.compare(next,3,"n =") &&
+	      nRow(Line,next,N,Frac,Err))
+	    {
+	      Z=zNum;
+	      return 2;
+	    }
+	}
+      pos=Line.find("z =",pos+1);
+    }
+
+  pos=Line.find("n =");
+  while(pos!=std::string::npos)
+    {
+      if (nRow(Line,pos,N,Frac,Err))
+	return 1;
+      pos=Line.find("n =",pos+1);
+    }
+  return 0;
+}
+
+} // NAMESPACE htapeScan
@@ -0,0 +1,262 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/htapeSection.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <regex>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "regexSupport.h"
+#include "doubleErr.h"
+#include "cellProduction.h"
+#include "htapeScan.h"
+#include "htapeSection.h"
+
+htapeSection::htapeSection(const int CN,const std::streamoff SP) :
+  cellNum(CN),startPos(SP),endPos(-1),status(0),zNum(0)
+  /*!
+    Constructor
+    \param CN :: Cell number
+    \param SP :: Position of the line after the cell header
+  */
+{}
+
+htapeSection::htapeSection(const htapeSection& A) :
+  cellNum(A.cellNum),startPos(A.startPos),endPos(A.endPos),
+  status(A.status),zNum(A.zNum),Items(A.Items),BadLines(A.BadLines)
+  /*!
+    Copy constructor
+    \param A :: htapeSection to copy
+  */
+{}
+
+htapeSection&
+htapeSection::operator=(const htapeSection& A)
+  /*!
+    Assignment operator
+    \param A :: htapeSection to copy
+    \return *this
+  */
+{
+  if (this!=&A)
+    {
+      cellNum=A.cellNum;
+      startPos=A.startPos;
+      endPos=A.endPos;
+      status=A.status;
+      zNum=A.zNum;
+      Items=A.Items;
+      BadLines=A.BadLines;
+    }
+  return *this;
+}
+
+htapeSection::~htapeSection()
+  /*!
+    Destructor
+  */
+{}
+
+int
+htapeSection::readLine(std::istream& IX,std::streamoff& pos,
+		       std::string& Line)
+  /*!
+    Read a line and remove trailing comments [as StrFunc::getLine]
+    but without the shared buffer so it can be used on any thread.
+    \param IX :: Input stream
+    \param pos :: Byte position [updated to the next line]
+    \param Line :: Line read
+    \return 1 on success / 0 at end of file
+  */
+{
+  if (!std::getline(IX,Line))
+    return 0;
+  pos+=static_cast<std::streamoff>(Line.size());
+  if (!IX.eof()) pos++;
+
+  const std::string::size_type cPos=Line.find_first_of("#!");
+  if (cPos!=std::string::npos)
+    Line.erase(cPos);
+  return 1;
+}
+
+void
+htapeSection::addItem(const int z,const int n,
+		      const double frac,const double fracErr)
+  /*!
+    Store a production row
+    \param z :: Atomic number
+    \param n :: Neutron number
+    \param frac :: Production
+    \param fracErr :: Relative error
+  */
+{
+  prodItem PI;
+  PI.z=z;
+  PI.n=n;
+  PI.frac=frac;
+  PI.fracErr=fracErr;
+  Items.push_back(PI);
+  return;
+}
+
+int
+htapeSection::zaidLine(const std::string& SLine)
+  /*!
+    Process a line of an outt08/outt15 table
+    \param SLine :: Line of the table
+    \return 1 on the "complete" line [end of table]
+  */
+{
+  // find : z = 12 n = 12  1.4d-4 0.3 
+  //      or :        n = 13  1.4d-4 0.3 
+  if (SLine.find("complete")!=std::string::npos)
+    return 1;
+
+  int n;
+  double frac,errFrac;
+  std::string fracStr,errStr;
+  if (htapeScan::zaidLine(SLine,zNum,n,fracStr,errStr) &&
+      StrFunc::sectionMCNPX(fracStr,frac) &&
+      StrFunc::sectionMCNPX(errStr,errFrac) )
+    addItem(zNum,n,frac,errFrac);
+  return 0;
+}
+
+int
+htapeSection::gasLine(std::string SLine)
+  /*!
+    Process a line of an outt14 table. The lines are:
+    -    (hydrogen  deuterium  tritium   total h)
+    -    (helium-3  helium-4   total he  gas(h&he)
+    each followed by values + error
+    \param SLine :: Line of the table
+    \return 1 when the table is complete
+  */
+{
+  double A,B,C;
+  double AErr,BErr,CErr;
+  switch (status)
+    {
+    case 2: // production:
+      if (StrFunc::StrLook(SLine,htapeScan::hydrogenRegex()))
+	status=3;
+      break;
+    case 3:  // read line
+      if (StrFunc::sectionMCNPX(SLine,A) &&
+	  StrFunc::sectionMCNPX(SLine,AErr) &&
+	  StrFunc::sectionMCNPX(SLine,B) &&
+	  StrFunc::sectionMCNPX(SLine,BErr) &&
+	  StrFunc::sectionMCNPX(SLine,C) &&
+	  StrFunc::sectionMCNPX(SLine,CErr))
+	{
+	  addItem(1,0,A,AErr);  // hydrogen
+	  addItem(1,1,B,BErr);  // deuterium
+	  addItem(1,2,C,CErr);  // tritium
+	  status=4;
+	}
+      break;
+    case 4: // production:
+      if (StrFunc::StrLook(SLine,htapeScan::heliumRegex()))
+	status=5;
+      else if (!StrFunc::isEmpty(SLine))
+	BadLines.push_back(SLine);
+      break;
+    case 5:  // read line
+      if (StrFunc::sectionMCNPX(SLine,A) &&
+	  StrFunc::sectionMCNPX(SLine,AErr) &&
+	  StrFunc::sectionMCNPX(SLine,B) &&
+	  StrFunc::sectionMCNPX(SLine,BErr) )
+	{
+	  addItem(2,1,A,AErr);  // he-3
+	  addItem(2,2,B,BErr);  // he-4
+	}
+      status=0;
+    }
+  return (status) ? 0 : 1;
+}
+
+void
+htapeSection::readZaid(std::istream& IX)
+  /*!
+    Read the production rows of an outt08/outt15 section.
+    The line after the cell header is the table title and
+    is skipped. The table ends on the "complete" line.
+    \param IX :: Input stream [positioned by this method]
+  */
+{
+  IX.clear();
+  IX.seekg(startPos);
+  std::streamoff pos(startPos);
+  std::string SLine;
+  if (!readLine(IX,pos,SLine)) return;
+
+  zNum=0;
+  while((endPos<0 || pos<endPos) && readLine(IX,pos,SLine))
+    if (zaidLine(SLine))
+      return;
+  return;
+}
+
+void
+htapeSection::readGas(std::istream& IX)
+  /*!
+    Read the gas rows of an outt14 section.
+    \param IX :: Input stream [positioned by this method]
+  */
+{
+  IX.clear();
+  IX.seekg(startPos);
+  std::streamoff pos(startPos);
+  std::string SLine;
+
+  status=2;
+  while((endPos<0 || pos<endPos) && readLine(IX,pos,SLine))
+    if (gasLine(SLine))
+      return;
+  return;
+}
+
+void
+htapeSection::addProd(const size_t prodType,cellProduction& CProd) const
+  /*!
+    Add the rows to the cell production [in file order]
+    \param prodType :: Type of production [0-2]
+    \param CProd :: Cell production unit
+  */
+{
+  for(const prodItem& PI : Items)
+    CProd.cellIndexProd(prodType,PI.z,PI.n,0,PI.frac,PI.fracErr);
+  return;
+}
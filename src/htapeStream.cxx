@@ -0,0 +1,181 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/htapeStream.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <regex>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "regexSupport.h"
+#include "htapeScan.h"
+#include "htapeSection.h"
+#include "htapeStream.h"
+
+htapeStream::htapeStream(const bool PF) :
+  prodFlag(PF),statusFlag(PF ? 0 : 1),npsFile(0),nByte(0)
+  /*!
+    Constructor
+    \param PF :: Production table [outt08/outt15] / gas [outt14]
+  */
+{}
+
+htapeStream::htapeStream(const htapeStream& A) :
+  prodFlag(A.prodFlag),statusFlag(A.statusFlag),npsFile(A.npsFile),
+  nByte(A.nByte),Partial(A.Partial),Sect(A.Sect)
+  /*!
+    Copy constructor
+    \param A :: htapeStream to copy
+  */
+{}
+
+htapeStream&
+htapeStream::operator=(const htapeStream& A)
+  /*!
+    Assignment operator
+    \param A :: htapeStream to copy
+    \return *this
+  */
+{
+  if (this!=&A)
+    {
+      prodFlag=A.prodFlag;
+      statusFlag=A.statusFlag;
+      npsFile=A.npsFile;
+      nByte=A.nByte;
+      Partial=A.Partial;
+      Sect=A.Sect;
+    }
+  return *this;
+}
+
+htapeStream::~htapeStream()
+  /*!
+    Destructor
+  */
+{}
+
+void
+htapeStream::addLine(std::string SLine)
+  /*!
+    Process a complete line
+    \param SLine :: Line [without new line]
+  */
+{
+  // remove trailing comments [as StrFunc::getLine]
+  const std::string::size_type cPos=SLine.find_first_of("#!");
+  if (cPos!=std::string::npos)
+    SLine.erase(cPos);
+
+  int caseNum,cellNum;
+  switch (statusFlag)
+    {
+    case 0:
+      if (StrFunc::StrComp(SLine,htapeScan::npsRegex(),npsFile,0))
+	statusFlag=1;
+      // FALLTHRU
+    case 1:
+      if (htapeScan::caseLine(SLine,caseNum))
+	statusFlag=2;
+      break;
+    case 2:  // cell number
+      if (htapeScan::cellLine(SLine,cellNum))
+	{
+	  Sect.push_back(htapeSection(cellNum,0));
+	  if (prodFlag)
+	    statusFlag=3;
+	  else
+	    {
+	      Sect.back().startGas();
+	      statusFlag=5;
+	    }
+	}
+      break;
+    case 3:  // table title
+      statusFlag=4;
+      break;
+    case 4:  // production rows
+      if (Sect.back().zaidLine(SLine))
+	statusFlag=1;
+      break;
+    case 5:  // gas rows [incomplete table ends on the next case]
+      if (htapeScan::caseLine(SLine,caseNum))
+	statusFlag=2;
+      else if (Sect.back().gasLine(SLine))
+	statusFlag=1;
+      break;
+    }
+  return;
+}
+
+void
+htapeStream::addData(const char* Buffer,const size_t N)
+  /*!
+    Add a block of output. Complete lines are processed
+    and the remainder kept until the next block.
+    \param Buffer :: Data
+    \param N :: Number of bytes
+  */
+{
+  nByte+=N;
+  size_t start(0);
+  for(size_t i=0;i<N;i++)
+    if (Buffer[i]=='\n')
+      {
+	if (Partial.empty())
+	  addLine(std::string(Buffer+start,i-start));
+	else
+	  {
+	    Partial.append(Buffer+start,i-start);
+	    addLine(Partial);
+	    Partial.clear();
+	  }
+	start=i+1;
+      }
+  Partial.append(Buffer+start,N-start);
+  return;
+}
+
+void
+htapeStream::finish()
+  /*!
+    End of the output : process any unterminated last line
+  */
+{
+  if (!Partial.empty())
+    {
+      addLine(Partial);
+      Partial.clear();
+    }
+  return;
+}
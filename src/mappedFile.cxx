@@ -0,0 +1,164 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/mappedFile.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "mappedFile.h"
+
+mappedFile::mappedFile(const std::string& FN) :
+  FName(FN),dataPtr(0),dataSize(0),mapFlag(0)
+  /*!
+    Constructor : map the file [or read it if it cannot
+    be mapped]
+    \param FN :: File name
+  */
+{
+  ELog::RegMethod RegA("mappedFile","constructor");
+
+  const int fd=(FName.empty()) ? -1 : ::open(FName.c_str(),O_RDONLY);
+  if (fd<0)
+    throw ColErr::FileError(0,FName,"File not opened");
+
+  struct stat SBuf;
+  if (!::fstat(fd,&SBuf) && S_ISREG(SBuf.st_mode) && SBuf.st_size>0)
+    {
+      void* MPtr=::mmap(0,static_cast<size_t>(SBuf.st_size),
+			PROT_READ,MAP_PRIVATE,fd,0);
+      if (MPtr!=MAP_FAILED)
+	{
+	  ::madvise(MPtr,static_cast<size_t>(SBuf.st_size),
+		    MADV_SEQUENTIAL);
+	  dataPtr=static_cast<const char*>(MPtr);
+	  dataSize=static_cast<size_t>(SBuf.st_size);
+	  mapFlag=1;
+	}
+    }
+  ::close(fd);
+
+  if (!mapFlag)
+    {
+      std::ifstream IX(FName.c_str(),std::ios::binary);
+      Buffer.assign(std::istreambuf_iterator<char>(IX),
+		    std::istreambuf_iterator<char>());
+      dataSize=Buffer.size();
+      dataPtr=(dataSize) ? &Buffer[0] : 0;
+    }
+}
+
+mappedFile::~mappedFile()
+  /*!
+    Destructor : remove the map
+  */
+{
+  if (mapFlag)
+    ::munmap(const_cast<char*>(dataPtr),dataSize);
+}
+
+const char*
+mappedFile::lineEnd(const char* pos,const char* endPtr)
+  /*!
+    Find the end of the line
+    \param pos :: Position in the line
+    \param endPtr :: End of data
+    \return position of the new line / endPtr
+  */
+{
+  if (pos>=endPtr) return endPtr;
+  const void* NL=
+    std::memchr(pos,'\n',static_cast<size_t>(endPtr-pos));
+  return (NL) ? static_cast<const char*>(NL) : endPtr;
+}
+
+const char*
+mappedFile::nextLine(const char* pos,const char* endPtr)
+  /*!
+    Find the start of the next line
+    \param pos :: Position in the line
+    \param endPtr :: End of data
+    \return start of the next line / endPtr
+  */
+{
+  const char* NL=lineEnd(pos,endPtr);
+  return (NL==endPtr) ? endPtr : NL+1;
+}
+
+const char*
+mappedFile::findLine(const char* pos,const char* endPtr,
+		     const char* key,const size_t keyLen)
+  /*!
+    Find the next line that starts with key. The text is
+    searched for key as a whole [memmem] rather than line
+    by line, so the lines between are never split.
+    \param pos :: Start of a line
+    \param endPtr :: End of data
+    \param key :: Text at the start of the line
+    \param keyLen :: Length of key
+    \return start of the line found / endPtr
+  */
+{
+  while(pos<endPtr && static_cast<size_t>(endPtr-pos)>=keyLen)
+    {
+      const void* KPtr=
+	::memmem(pos,static_cast<size_t>(endPtr-pos),key,keyLen);
+      if (!KPtr) break;
+      const char* P=static_cast<const char*>(KPtr);
+      if (P==pos || P[-1]=='\n')
+	return P;
+      pos=P+1;
+    }
+  return endPtr;
+}
+
+bool
+mappedFile::hasText(const char* pos,const char* endPtr,
+		    const char* key,const size_t keyLen)
+  /*!
+    Determine if key is in the range
+    \param pos :: Start of range
+    \param endPtr :: End of range
+    \param key :: Text to find
+    \param keyLen :: Length of key
+    \return true if found
+  */
+{
+  return (pos<endPtr &&
+	  ::memmem(pos,static_cast<size_t>(endPtr-pos),key,keyLen));
+}
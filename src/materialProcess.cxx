@@ -326,6 +326,71 @@ materialProcess::readMCNP(const std::string& FName,
   return;
 }
 
+size_t
+materialProcess::nComponents(const int matN) const
+  /*!
+    Number of nuclides in a material
+    \param matN :: Material number
+    \return number of zaids [0 if not found]
+   */
+{
+  MTYPE::const_iterator mc=matStore.find(matN);
+  return (mc==matStore.end()) ? 0 : mc->second.nZaid();
+}
+
+int
+materialProcess::mixMaterials(const std::vector<int>& Mats,
+			      const std::vector<double>& Vols)
+  /*!
+    Make the volume weighted mixture of materials : the atom
+    density of each nuclide is the volume mean of its atom
+    density in the materials. Materials not found [void]
+    add volume but no atoms.
+    \param Mats :: Material numbers
+    \param Vols :: Volume of each material
+    \return number of mixture [the material if all the same / 0 : void]
+   */
+{
+  ELog::RegMethod RegA("materialProcess","mixMaterials");
+
+  if (Mats.empty() || Mats.size()!=Vols.size())
+    throw ColErr::MisMatch<size_t>(Mats.size(),Vols.size(),"Mats/Vols");
+  if (std::find_if(Mats.begin(),Mats.end(),
+		   [&Mats](const int M) { return M!=Mats.front(); })==
+      Mats.end())
+    return Mats.front();
+
+  double VSum(0.0);
+  for(const double V : Vols)
+    VSum+=V;
+
+  MonteCarlo::Material Mix;
+  double density(0.0);
+  bool found(0);
+  for(size_t i=0;i<Mats.size();i++)
+    {
+      MTYPE::const_iterator mc=matStore.find(Mats[i]);
+      if (mc==matStore.end() || !mc->second.nZaid()) continue;
+      // zaid densities to atom/A^3 then to the volume fraction
+      MonteCarlo::Material A(mc->second);
+      A.setDensity(A.getAtomDensity());
+      A*=Vols[i]/VSum;
+      density+=A.getAtomDensity()*Vols[i]/VSum;
+      if (found)
+	Mix+=A;
+      else
+	Mix=A;
+      found=1;
+    }
+  if (!found) return 0;
+
+  const int matN=(matStore.empty()) ? 1 : matStore.rbegin()->first+1;
+  Mix.setDensity(density);
+  Mix.setNumber(matN);
+  matStore.emplace(matN,Mix);
+  return matN;
+}
+
 void
 materialProcess::writeMaterials(const std::string& FName) const
   /*!
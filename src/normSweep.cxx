@@ -0,0 +1,274 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/normSweep.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "runProgs.h"
+#include "cellJob.h"
+#include "cellRunner.h"
+#include "Control.h"
+#include "normSweep.h"
+
+normSweep::normSweep(const Control& C) :
+  Ctrl(C)
+  /*!
+    Constructor
+    \param C :: Control [problem and run options]
+  */
+{}
+
+normSweep::~normSweep()
+  /*!
+    Destructor
+  */
+{}
+
+double
+normSweep::burnupBound(const int cellN,const double normScale,
+		       const std::string& group) const
+  /*!
+    Upper bound on the fraction of any nuclide of a cell
+    burnt up in the history : the fluence times a bounding
+    cross section [burnXS]. Below burnTol the inventory
+    is linear in the source strength.
+    \param cellN :: Cell number
+    \param normScale :: Factor on the source normalisation
+    \param group :: Named history [empty : main history]
+    \return burn-up fraction bound
+  */
+{
+  return Ctrl.burnXS*1e-24*Ctrl.fluxes.integralFlux(cellN)*
+    Ctrl.srcNorm*normScale*Ctrl.Histories.getHistory(group).irradiation();
+}
+
+size_t
+normSweep::runFactor(const size_t j,const JMAP& BaseJob,const JMAP& Cells,
+		     const std::map<GCell,double>& Linear,
+		     resultCache* RC,std::vector<cellJob>& Done) const
+  /*!
+    Put the results of the cells at factor j of sweepScale in
+    [cell directory]/sweep[j] : linear cells are scaled from
+    the base run, the others are run.
+    \param j :: Index of the factor
+    \param BaseJob :: Jobs of the base run
+    \param Cells :: Base jobs of the cells to sweep
+    \param Linear :: Linear cells : error bound of scaling
+    \param RC :: Result cache [0 : none]
+    \param Done :: Jobs that were run [appended]
+    \return number of failed runs
+  */
+{
+  ELog::RegMethod RegA("normSweep","runFactor");
+
+  const double F=Ctrl.sweepScale[j];
+  const std::string SName="sweep"+StrFunc::makeString(j);
+
+  cellRunner CR(Ctrl.nWorkers);
+  CR.setCache(RC);
+  Ctrl.setRunner(CR);
+  CR.setWriter([this,F](const cellJob& CJ)
+	       {
+		 Ctrl.writeCellInput(CJ.dirName,CJ.cellN,
+				     CJ.volume,F,CJ.group);
+	       });
+
+  size_t nScaled(0);
+  for(const JMAP::value_type& BV : Cells)
+    {
+      const cellJob& BJ(*BV.second);
+      cellJob CJ(BJ.cellN,
+		 (boost::filesystem::path(BJ.dirName) / SName).string(),
+		 BJ.volume,BJ.logIndex);
+      CJ.group=BJ.group;
+      std::map<GCell,double>::const_iterator mc=Linear.find(BV.first);
+      if (mc==Linear.end())
+	{
+	  CR.addJob(CJ);
+	  continue;
+	}
+      // scaled copy of the cell that was run
+      const cellJob& SJ((BJ.isScaled()) ?
+			*BaseJob.find(GCell(BJ.group,BJ.sourceCell))->second :
+			BJ);
+      CJ.sourceCell=SJ.cellN;
+      CJ.fluxScale=F*BJ.fluxScale;
+      CJ.errorBound=BJ.errorBound+mc->second;
+      CJ.status=0;
+      Ctrl.writeCellInput(CJ.dirName,CJ.cellN,CJ.volume,F,CJ.group);
+      if (!cellRunner::copyResults(SJ,CJ))
+	ELog::EM<<"Sweep "<<j<<" : failed to scale cell "
+		<<CJ.cellN<<ELog::endCrit;
+      else
+	nScaled++;
+    }
+
+  CR.waitAll();
+  if (CR.nFailed())
+    {
+      std::ostringstream sx;
+      CR.writeStatus(sx);
+      ELog::EM<<"Sweep "<<j<<" run status:\n"<<sx.str()<<ELog::endCrit;
+    }
+  ELog::EM<<"Sweep "<<j<<" [x "<<F<<"] : "<<nScaled<<" cells scaled : "
+	  <<CR.getJobs().size()<<" run"<<ELog::endDiag;
+  Done.insert(Done.end(),CR.getJobs().begin(),CR.getJobs().end());
+  return CR.nFailed();
+}
+
+size_t
+normSweep::run(const cellRunner& Base,resultCache* RC) const
+  /*!
+    Normalisation sweep : for each factor in sweepScale the
+    results of each good cell of the base run are put in
+    [cell directory]/sweep[j]. The burn-up bound at the
+    largest factor flags the cells that may not be linear
+    in the source : only these are run at each factor.
+    The other cells are scaled from the base run, after
+    a spot check of sweepCheck of them run at the factor
+    furthest from 1. If the spot check finds a cell that
+    is not linear the bound is not trusted and every cell
+    is run. The cells of every group [named history] are
+    swept together.
+    \param Base :: Runner of the base [unit factor] run
+    \param RC :: Result cache [0 : none]
+    \return number of failed runs
+  */
+{
+  ELog::RegMethod RegA("normSweep","run");
+
+  if (Ctrl.sweepScale.empty()) return 0;
+
+  JMAP BaseJob;
+  for(const cellJob& BJ : Base.getJobs())
+    BaseJob.emplace(GCell(BJ.group,BJ.cellN),&BJ);
+
+  // check factor : the largest departure from linearity
+  size_t jCheck(0);
+  double maxF(1.0);
+  for(size_t j=0;j<Ctrl.sweepScale.size();j++)
+    {
+      const double F=Ctrl.sweepScale[j];
+      if (std::abs(std::log(F))>
+	  std::abs(std::log(Ctrl.sweepScale[jCheck])))
+	jCheck=j;
+      maxF=std::max(maxF,F);
+    }
+
+  JMAP Good;
+  JMAP Flagged;
+  std::map<GCell,double> Bound;
+  for(const JMAP::value_type& BV : BaseJob)
+    {
+      if (BV.second->status) continue;
+      Good.insert(BV);
+      const double B=burnupBound(BV.first.second,maxF,BV.first.first);
+      if (B<=Ctrl.burnTol)
+	Bound.emplace(BV.first,B);
+      else
+	Flagged.insert(BV);
+    }
+
+  // spot check : bounded cells evenly spaced in the list
+  JMAP First(Flagged);
+  const size_t NB(Bound.size());
+  const size_t nCheck(std::min(Ctrl.sweepCheck,NB));
+  size_t index(0);
+  for(const std::map<GCell,double>::value_type& BV : Bound)
+    if ((index++ * nCheck) % NB < nCheck)
+      First.emplace(BV.first,Good.find(BV.first)->second);
+
+  std::vector<cellJob> Done;
+  size_t nFail=runFactor(jCheck,BaseJob,First,
+			 std::map<GCell,double>(),RC,Done);
+  if (runProgs::stopLevel())
+    return nFail;
+
+  const double F=Ctrl.sweepScale[jCheck];
+  double maxDiff(0.0);
+  bool linear(1);
+  for(const cellJob& CJ : Done)
+    {
+      const GCell GC(CJ.group,CJ.cellN);
+      if (Bound.find(GC)==Bound.end()) continue;
+      const double D=(CJ.status) ? -1.0 :
+	cellRunner::tableDeviation(Good.find(GC)->second->dirName,
+				   CJ.dirName,F);
+      if (D<0.0 || D>Ctrl.burnTol)
+	{
+	  ELog::EM<<"Sweep spot check : cell "<<CJ.cellN
+		  <<" not linear [difference "<<D<<"]"<<ELog::endWarn;
+	  linear=0;
+	}
+      maxDiff=std::max(maxDiff,D);
+    }
+
+  std::map<GCell,double> Linear;
+  if (linear)
+    for(const std::map<GCell,double>::value_type& BV : Bound)
+      Linear.emplace(BV.first,std::max(BV.second,maxDiff));
+  else
+    ELog::EM<<"Sweep : burn-up bound not confirmed [burn_xs too small ?] : "
+	    "all cells run"<<ELog::endWarn;
+  ELog::EM<<"Sweep : "<<Flagged.size()<<" of "<<Good.size()
+	  <<" cells flagged by the burn-up bound : spot check of "
+	  <<nCheck<<" [max difference "<<maxDiff<<"]"<<ELog::endDiag;
+
+  JMAP Rest;
+  for(const JMAP::value_type& BV : Good)
+    if (First.find(BV.first)==First.end())
+      Rest.insert(BV);
+  nFail+=runFactor(jCheck,BaseJob,Rest,Linear,RC,Done);
+
+  for(size_t j=0;j<Ctrl.sweepScale.size() && !runProgs::stopLevel();j++)
+    if (j!=jCheck)
+      nFail+=runFactor(j,BaseJob,Good,Linear,RC,Done);
+  return nFail;
+}
@@ -0,0 +1,195 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/pSquare.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <cmath>
+#include <algorithm>
+
+#include "pSquare.h"
+
+pSquare::pSquare(const double P) :
+  prob(P),nCount(0)
+  /*!
+    Constructor
+    \param P :: Quantile [0-1]
+  */
+{
+  for(size_t i=0;i<5;i++)
+    Q[i]=Pos[i]=DPos[i]=DInc[i]=0.0;
+}
+
+pSquare::pSquare(const pSquare& A) :
+  prob(A.prob),nCount(A.nCount)
+  /*!
+    Copy constructor
+    \param A :: pSquare to copy
+  */
+{
+  for(size_t i=0;i<5;i++)
+    {
+      Q[i]=A.Q[i];
+      Pos[i]=A.Pos[i];
+      DPos[i]=A.DPos[i];
+      DInc[i]=A.DInc[i];
+    }
+}
+
+pSquare&
+pSquare::operator=(const pSquare& A)
+  /*!
+    Assignment operator
+    \param A :: pSquare to copy
+    \return *this
+  */
+{
+  if (this!=&A)
+    {
+      prob=A.prob;
+      nCount=A.nCount;
+      for(size_t i=0;i<5;i++)
+	{
+	  Q[i]=A.Q[i];
+	  Pos[i]=A.Pos[i];
+	  DPos[i]=A.DPos[i];
+	  DInc[i]=A.DInc[i];
+	}
+    }
+  return *this;
+}
+
+pSquare::~pSquare()
+  /*!
+    Destructor
+  */
+{}
+
+double
+pSquare::parabolic(const size_t i,const double D) const
+  /*!
+    Piecewise parabolic prediction of marker i moved by D
+    \param i :: Marker [1-3]
+    \param D :: Move [+/-1]
+    \return new height
+  */
+{
+  return Q[i]+D/(Pos[i+1]-Pos[i-1])*
+    ((Pos[i]-Pos[i-1]+D)*(Q[i+1]-Q[i])/(Pos[i+1]-Pos[i])+
+     (Pos[i+1]-Pos[i]-D)*(Q[i]-Q[i-1])/(Pos[i]-Pos[i-1]));
+}
+
+double
+pSquare::linear(const size_t i,const double D) const
+  /*!
+    Linear prediction of marker i moved by D
+    \param i :: Marker [1-3]
+    \param D :: Move [+/-1]
+    \return new height
+  */
+{
+  const size_t j=(D>0.0) ? i+1 : i-1;
+  return Q[i]+D*(Q[j]-Q[i])/(Pos[j]-Pos[i]);
+}
+
+void
+pSquare::addValue(const double V)
+  /*!
+    Add a value to the estimate
+    \param V :: Value
+  */
+{
+  if (nCount<5)
+    {
+      Q[nCount++]=V;
+      if (nCount==5)
+	{
+	  std::sort(Q,Q+5);
+	  for(size_t i=0;i<5;i++)
+	    Pos[i]=static_cast<double>(i+1);
+	  DPos[0]=1.0;
+	  DPos[1]=1.0+2.0*prob;
+	  DPos[2]=1.0+4.0*prob;
+	  DPos[3]=3.0+2.0*prob;
+	  DPos[4]=5.0;
+	  DInc[0]=0.0;
+	  DInc[1]=prob/2.0;
+	  DInc[2]=prob;
+	  DInc[3]=(1.0+prob)/2.0;
+	  DInc[4]=1.0;
+	}
+      return;
+    }
+
+  // cell k holding V
+  size_t k;
+  if (V<Q[0])
+    {
+      Q[0]=V;
+      k=0;
+    }
+  else if (V>=Q[4])
+    {
+      Q[4]=V;
+      k=3;
+    }
+  else
+    {
+      k=0;
+      while(V>=Q[k+1]) k++;
+    }
+  for(size_t i=k+1;i<5;i++)
+    Pos[i]+=1.0;
+  for(size_t i=0;i<5;i++)
+    DPos[i]+=DInc[i];
+  nCount++;
+
+  for(size_t i=1;i<4;i++)
+    {
+      const double D=DPos[i]-Pos[i];
+      if ((D>=1.0 && Pos[i+1]-Pos[i]>1.0) ||
+	  (D<=-1.0 && Pos[i-1]-Pos[i]<-1.0))
+	{
+	  const double S=(D>0.0) ? 1.0 : -1.0;
+	  const double QP=parabolic(i,S);
+	  Q[i]=(Q[i-1]<QP && QP<Q[i+1]) ? QP : linear(i,S);
+	  Pos[i]+=S;
+	}
+    }
+  return;
+}
+
+double
+pSquare::getValue() const
+  /*!
+    Current estimate of the quantile
+    \return quantile [0 if no values]
+  */
+{
+  if (!nCount) return 0.0;
+  if (nCount<5)
+    {
+      double V[5];
+      std::copy(Q,Q+nCount,V);
+      std::sort(V,V+nCount);
+      const size_t index=static_cast<size_t>
+	(std::floor(prob*static_cast<double>(nCount-1)+0.5));
+      return V[index];
+    }
+  return Q[2];
+}
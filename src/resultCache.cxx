@@ -0,0 +1,504 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/resultCache.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cerrno>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cctype>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "stringCombine.h"
+#include "MD5hash.h"
+#include "cellJob.h"
+#include "resultCache.h"
+
+resultCache::resultCache(const std::string& CDir,const size_t MS) :
+  cacheDir(CDir),maxSize(MS),nHit(0),nMiss(0),
+  tmpExt(".tmp"+StrFunc::makeString(static_cast<long int>(getpid())))
+  /*!
+    Constructor
+    \param CDir :: Cache directory [empty : no cache]
+    \param MS :: Maximum size of cache [bytes / 0 : unlimited]
+  */
+{
+  ELog::RegMethod RegA("resultCache","constructor");
+  if (!cacheDir.empty())
+    {
+      boost::filesystem::create_directories(cacheDir);
+      readIndex(Index);
+    }
+}
+
+resultCache::resultCache(const resultCache& A) :
+  cacheDir(A.cacheDir),maxSize(A.maxSize),Index(A.Index),
+  Removed(A.Removed),nHit(A.nHit),nMiss(A.nMiss),tmpExt(A.tmpExt)
+  /*!
+    Copy constructor
+    \param A :: resultCache to copy
+  */
+{}
+
+resultCache&
+resultCache::operator=(const resultCache& A)
+  /*!
+    Assignment operator
+    \param A :: resultCache to copy
+    \return *this
+  */
+{
+  if (this!=&A)
+    {
+      cacheDir=A.cacheDir;
+      maxSize=A.maxSize;
+      Index=A.Index;
+      Removed=A.Removed;
+      nHit=A.nHit;
+      nMiss=A.nMiss;
+      tmpExt=A.tmpExt;
+    }
+  return *this;
+}
+
+resultCache::~resultCache()
+  /*!
+    Destructor
+  */
+{}
+
+const std::vector<std::string>&
+resultCache::inputFiles()
+  /*!
+    Files written for each cell that define the problem
+    \return input file names
+  */
+{
+  static const std::vector<std::string> IFiles=
+    {"input","fluxes","splprods","material","locate"};
+  return IFiles;
+}
+
+const std::vector<std::string>&
+resultCache::runFiles()
+  /*!
+    Input files that are the same for every cell of a run
+    \return file names
+  */
+{
+  static const std::vector<std::string> RFiles={"material","locate"};
+  return RFiles;
+}
+
+bool
+resultCache::isResult(const std::string& FName)
+  /*!
+    Determine if a file in the cell directory is a result
+    of the CINDER/TABCODE run. Anything else [inputs, logs,
+    scale/sample files] is not cached.
+    \param FName :: File name [no directory]
+    \return true if a result file
+  */
+{
+  for(const std::string& OName : cellJob::expectedOutputs())
+    if (FName==OName) return 1;
+  if (FName=="gamma")
+    return 1;
+  // TABCODE tables : tab1, tab2 ...
+  return (FName.size()>3 && FName.compare(0,3,"tab")==0 &&
+	  std::isdigit(FName[3]));
+}
+
+void
+resultCache::copyFile(const boost::filesystem::path& Src,
+		      const boost::filesystem::path& Dest)
+  /*!
+    Copy a file [overwriting Dest]. Done with streams as
+    the cache/scratch can be on a different file system
+    to the cell directories.
+    \param Src :: File to copy
+    \param Dest :: New file
+  */
+{
+  std::ifstream IX(Src.string().c_str(),std::ios::binary);
+  std::ofstream OX(Dest.string().c_str(),
+		   std::ios::binary | std::ios::trunc);
+  bool good(IX.is_open() && OX.is_open());
+  if (good)
+    {
+      // empty file : inserting rdbuf would set failbit
+      if (IX.peek()!=std::ifstream::traits_type::eof())
+	OX<<IX.rdbuf();
+      OX.close();
+      good=!OX.fail();
+    }
+  if (!good)
+    throw boost::filesystem::filesystem_error
+      ("copyFile",Src,Dest,boost::system::error_code
+       ((errno) ? errno : EIO,boost::system::generic_category()));
+  return;
+}
+
+std::string
+resultCache::fileHash(const std::string& FName)
+  /*!
+    Calculate the MD5 of a file
+    \param FName :: File name
+    \return hash [empty if file cannot be read]
+  */
+{
+  ELog::RegMethod RegA("resultCache","fileHash");
+
+  std::ifstream IX(FName.c_str(),std::ios::binary);
+  if (!IX.good()) return "";
+
+  std::ostringstream cx;
+  cx<<IX.rdbuf();
+  MD5hash MH;
+  return MH.processMessage(cx.str());
+}
+
+std::string
+resultCache::problemKey(const std::string& DName)
+  /*!
+    Calculate the key of the problem in a cell directory.
+    The locate file holds the library path so a change
+    of library is a different problem. The hash of a run
+    file [material/locate] is kept while the file is the
+    same file [device/inode] with the same size, mtime and
+    ctime, so a shared [linked] file is hashed once.
+    \param DName :: Cell directory
+    \return hash key [empty if an input is missing]
+  */
+{
+  ELog::RegMethod RegA("resultCache","problemKey");
+
+  /// Hash of each run file [dev:inode : (stamp,hash)]
+  static std::map<std::string,std::pair<std::string,std::string>> RunHash;
+
+  const boost::filesystem::path BDir(DName);
+  const std::vector<std::string>& RFiles=runFiles();
+  std::string Key;
+  for(const std::string& IName : inputFiles())
+    {
+      const std::string FName=(BDir / IName).string();
+      std::string H;
+      if (std::find(RFiles.begin(),RFiles.end(),IName)!=RFiles.end())
+	{
+	  struct stat SBuf;
+	  if (::stat(FName.c_str(),&SBuf)) return "";
+	  std::ostringstream ix,sx;
+	  ix<<SBuf.st_dev<<":"<<SBuf.st_ino;
+	  sx<<SBuf.st_size<<" "<<SBuf.st_mtim.tv_sec<<"."
+	    <<SBuf.st_mtim.tv_nsec<<" "<<SBuf.st_ctim.tv_sec<<"."
+	    <<SBuf.st_ctim.tv_nsec;
+	  std::pair<std::string,std::string>& RH=RunHash[ix.str()];
+	  if (RH.second.empty() || RH.first!=sx.str())
+	    RH=std::pair<std::string,std::string>(sx.str(),fileHash(FName));
+	  H=RH.second;
+	}
+      else
+	H=fileHash(FName);
+      if (H.empty()) return "";
+      Key+=IName+":"+H+"\n";
+    }
+  MD5hash MH;
+  return MH.processMessage(Key);
+}
+
+std::string
+resultCache::indexFile() const
+  /*!
+    Name of the index file
+    \return index file name
+  */
+{
+  return (boost::filesystem::path(cacheDir) / "index").string();
+}
+
+void
+resultCache::readIndex(ITYPE& Out) const
+  /*!
+    Read the index file. Entries without a directory
+    are dropped.
+    \param Out :: Index to fill
+  */
+{
+  ELog::RegMethod RegA("resultCache","readIndex");
+
+  Out.clear();
+  std::ifstream IX(indexFile().c_str());
+  std::string Line;
+  while(std::getline(IX,Line))
+    {
+      std::string Key;
+      size_t S;
+      long int T;
+      if (StrFunc::section(Line,Key) &&
+	  StrFunc::section(Line,S) &&
+	  StrFunc::section(Line,T) &&
+	  boost::filesystem::is_directory
+	  (boost::filesystem::path(cacheDir) / Key))
+	Out.emplace(Key,std::pair<size_t,long int>(S,T));
+    }
+  return;
+}
+
+void
+resultCache::mergeIndex()
+  /*!
+    Merge the index on disk [written by other runs sharing
+    the cache] into Index. Entries this run removed stay
+    removed and the latest use of an entry is kept.
+  */
+{
+  ITYPE Disk;
+  readIndex(Disk);
+  for(const ITYPE::value_type& IV : Disk)
+    {
+      if (Removed.find(IV.first)!=Removed.end())
+	continue;
+      std::pair<ITYPE::iterator,bool> PI=Index.insert(IV);
+      if (!PI.second && PI.first->second.second<IV.second.second)
+	PI.first->second.second=IV.second.second;
+    }
+  return;
+}
+
+void
+resultCache::writeIndex() const
+  /*!
+    Write the index file. It is written to a temporary
+    file [unique to the process] and renamed so an
+    interrupted run does not leave a truncated index.
+  */
+{
+  ELog::RegMethod RegA("resultCache","writeIndex");
+
+  const std::string IName=indexFile();
+  const std::string TName=IName+tmpExt;
+  std::ofstream OX(TName.c_str());
+  for(const ITYPE::value_type& IV : Index)
+    OX<<IV.first<<" "<<IV.second.first<<" "<<IV.second.second<<std::endl;
+  OX.close();
+  if (OX.fail())
+    {
+      ELog::EM<<"Failed to write cache index "<<TName<<ELog::endErr;
+      return;
+    }
+  boost::system::error_code EC;
+  boost::filesystem::rename(TName,IName,EC);
+  if (EC)
+    ELog::EM<<"Failed to write cache index "<<IName<<ELog::endErr;
+  return;
+}
+
+void
+resultCache::evict()
+  /*!
+    Remove the least recently used entries until the
+    cache is smaller than maxSize
+  */
+{
+  ELog::RegMethod RegA("resultCache","evict");
+
+  if (!maxSize) return;
+
+  size_t total(0);
+  for(const ITYPE::value_type& IV : Index)
+    total+=IV.second.first;
+
+  while(total>maxSize && !Index.empty())
+    {
+      ITYPE::iterator oldest=Index.begin();
+      for(ITYPE::iterator mc=Index.begin();mc!=Index.end();mc++)
+	if (mc->second.second<oldest->second.second)
+	  oldest=mc;
+
+      boost::system::error_code EC;
+      boost::filesystem::remove_all
+	(boost::filesystem::path(cacheDir) / oldest->first,EC);
+      total-=oldest->second.first;
+      Removed.insert(oldest->first);
+      Index.erase(oldest);
+    }
+  return;
+}
+
+bool
+resultCache::restore(const std::string& Key,const std::string& DName)
+  /*!
+    Copy the cached results into a cell directory
+    \param Key :: Problem key
+    \param DName :: Cell directory
+    \return true if the results were restored
+  */
+{
+  ELog::RegMethod RegA("resultCache","restore");
+
+  namespace BF=boost::filesystem;
+
+  ITYPE::iterator mc=Index.find(Key);
+  if (Key.empty() || mc==Index.end())
+    {
+      nMiss++;
+      return 0;
+    }
+
+  try
+    {
+      const BF::path CDir=BF::path(cacheDir) / Key;
+      for(BF::directory_iterator di(CDir);di!=BF::directory_iterator();di++)
+	copyFile(di->path(),BF::path(DName) / di->path().filename());
+    }
+  catch (BF::filesystem_error& EX)
+    {
+      ELog::EM<<"Cache entry "<<Key<<" unreadable : "
+	      <<EX.what()<<ELog::endWarn;
+      Removed.insert(Key);
+      Index.erase(mc);
+      nMiss++;
+      return 0;
+    }
+  mc->second.second=static_cast<long int>(time(0));
+  nHit++;
+  return 1;
+}
+
+void
+resultCache::store(const std::string& Key,const std::string& DName)
+  /*!
+    Copy the results of a cell directory into the cache.
+    The entry is built in a temporary directory and renamed
+    into place so a partial entry is never used. If another
+    run has stored the same key first its entry is kept.
+    \param Key :: Problem key
+    \param DName :: Cell directory
+  */
+{
+  ELog::RegMethod RegA("resultCache","store");
+
+  namespace BF=boost::filesystem;
+
+  if (Key.empty() || Index.find(Key)!=Index.end())
+    return;
+
+  const BF::path CDir=BF::path(cacheDir) / Key;
+  const BF::path TDir=BF::path(cacheDir) / (Key+tmpExt);
+  try
+    {
+      BF::remove_all(TDir);
+      BF::create_directory(TDir);
+      size_t total(0);
+      for(BF::directory_iterator di(DName);di!=BF::directory_iterator();di++)
+	{
+	  const std::string FName=di->path().filename().string();
+	  if (BF::is_regular_file(di->status()) && isResult(FName))
+	    {
+	      copyFile(di->path(),TDir / FName);
+	      total+=static_cast<size_t>(BF::file_size(di->path()));
+	    }
+	}
+      boost::system::error_code EC;
+      BF::rename(TDir,CDir,EC);
+      if (EC)
+	{
+	  if (!BF::is_directory(CDir))
+	    throw BF::filesystem_error("store",TDir,CDir,EC);
+	  BF::remove_all(TDir);
+	}
+      Removed.erase(Key);
+      Index.emplace(Key,std::pair<size_t,long int>
+		    (total,static_cast<long int>(time(0))));
+    }
+  catch (BF::filesystem_error& EX)
+    {
+      ELog::EM<<"Failed to cache "<<DName<<" : "<<EX.what()<<ELog::endWarn;
+      boost::system::error_code EC;
+      BF::remove_all(TDir,EC);
+      return;
+    }
+  evict();
+  return;
+}
+
+void
+resultCache::flush()
+  /*!
+    Write the index to disk. Several runs can share a
+    cache : the index is locked [flock on index.lock] and
+    the entries on disk are merged in before it is written.
+  */
+{
+  ELog::RegMethod RegA("resultCache","flush");
+
+  if (cacheDir.empty()) return;
+
+  const std::string LName=indexFile()+".lock";
+  const int fd=::open(LName.c_str(),O_RDWR | O_CREAT | O_CLOEXEC,0644);
+  if (fd<0 || ::flock(fd,LOCK_EX))
+    ELog::EM<<"Failed to lock cache index "<<LName<<ELog::endWarn;
+
+  mergeIndex();
+  evict();
+  writeIndex();
+
+  if (fd>=0)
+    ::close(fd);   // releases the lock
+  return;
+}
+
+void
+resultCache::write(std::ostream& OX) const
+  /*!
+    Write a summary of the cache use
+    \param OX :: Output stream
+  */
+{
+  size_t total(0);
+  for(const ITYPE::value_type& IV : Index)
+    total+=IV.second.first;
+
+  OX<<"Cache "<<cacheDir<<" : hits "<<nHit<<" misses "<<nMiss
+    <<" entries "<<Index.size()<<" size "<<total<<" bytes";
+  return;
+}
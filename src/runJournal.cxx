@@ -0,0 +1,404 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/runJournal.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "cellJob.h"
+#include "resultCache.h"
+#include "runJournal.h"
+
+runJournal::runJournal(const std::string& FName) :
+  fileName(FName),fd(-1),shardIndex(0),nShard(0)
+  /*!
+    Constructor : reads the journal only. Nothing can be
+    appended so the file is left as it is [merge input].
+    \param FName :: Journal file
+  */
+{
+  ELog::RegMethod RegA("runJournal","constructor(read)");
+  readJournal();
+}
+
+runJournal::runJournal(const std::string& FName,const bool resumeFlag,
+		       const bool readFlag) :
+  fileName(FName),fd(-1),shardIndex(0),nShard(0)
+  /*!
+    Constructor : opens the journal for appending. A journal
+    that does not end in a new line [torn by a crash] is
+    ended so the next record starts on a line of its own.
+    \param FName :: Journal file
+    \param resumeFlag :: Keep the existing journal [else truncate it]
+    \param readFlag :: Read the kept journal [else append only]
+  */
+{
+  ELog::RegMethod RegA("runJournal","constructor");
+
+  if (resumeFlag && readFlag)
+    readJournal();
+
+  const int flags=O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC |
+    ((resumeFlag) ? 0 : O_TRUNC);
+  fd=open(fileName.c_str(),flags,0644);
+  if (fd<0)
+    throw ColErr::FileError(0,"runJournal",fileName);
+
+  if (resumeFlag)
+    {
+      std::ifstream IX(fileName.c_str(),std::ios::binary);
+      if (IX.seekg(-1,std::ios::end) && IX.get()!='\n')
+	{
+	  ELog::EM<<"Ending partial last line of "<<fileName<<ELog::endWarn;
+	  writeLine("\n");
+	}
+    }
+}
+
+runJournal::~runJournal()
+  /*!
+    Destructor
+  */
+{
+  if (fd>=0)
+    close(fd);
+}
+
+void
+runJournal::readJournal()
+  /*!
+    Read the journal : the last complete record of
+    each cell wins. Lines that do not parse [torn by a crash]
+    are skipped.
+  */
+{
+  ELog::RegMethod RegA("runJournal","readJournal");
+
+  std::ifstream IX(fileName.c_str());
+  std::string Line;
+  size_t nBad(0);
+  while(std::getline(IX,Line))
+    {
+      const std::vector<std::string> Items=StrFunc::StrParts(Line);
+      if (!Items.empty() && Items[0]=="#")
+	{
+	  int I,N;
+	  if (Items.size()==4 && Items[1]=="shard" &&
+	      StrFunc::convert(Items[2],I) && StrFunc::convert(Items[3],N) &&
+	      I>=0 && N>I)
+	    {
+	      shardIndex=static_cast<size_t>(I);
+	      nShard=static_cast<size_t>(N);
+	    }
+	  else if (Items.size()>1 && Items[1]=="cells")
+	    {
+	      Planned.clear();
+	      for(size_t i=2;i<Items.size();i++)
+		if (StrFunc::convert(Items[i],I))
+		  Planned.push_back(I);
+	    }
+	  continue;
+	}
+
+      int cellN,status,nOut;
+      if (Items.size()<20 || Items[0]!="cell" || Items.back()!="." ||
+	  !StrFunc::convert(Items[1],cellN) ||
+	  !StrFunc::convert(Items[5],status) ||
+	  !StrFunc::convert(Items[18],nOut) ||
+	  nOut<0 || Items.size()!=20+2*static_cast<size_t>(nOut))
+	{
+	  if (!Line.empty()) nBad++;
+	  continue;
+	}
+
+      if (status)
+	{
+	  Done.erase(cellN);
+	  Records.erase(cellN);
+	  continue;
+	}
+
+      HTYPE Outputs;
+      for(size_t i=0;i<static_cast<size_t>(nOut);i++)
+	Outputs.emplace(Items[19+2*i],Items[20+2*i]);
+      Done[cellN]=std::pair<std::string,HTYPE>(Items[16],Outputs);
+      Records[cellN]=Line+"\n";
+    }
+  if (nBad)
+    ELog::EM<<"Skipped "<<nBad<<" partial lines in "<<fileName<<ELog::endWarn;
+  return;
+}
+
+std::map<int,double>
+runJournal::readTimes(const std::string& FName)
+  /*!
+    Read the run times of the cells that were run [not
+    restored from the cache or copied from another cell]
+    without error from a journal
+    \param FName :: Journal file
+    \return map of cell : run time [sec]
+  */
+{
+  ELog::RegMethod RegA("runJournal","readTimes");
+
+  std::map<int,double> Out;
+  std::ifstream IX(FName.c_str());
+  std::string Line;
+  while(std::getline(IX,Line))
+    {
+      const std::vector<std::string> Items=StrFunc::StrParts(Line);
+      int cellN,status,cinderExit;
+      double startT,endT;
+      if (Items.size()>=20 && Items[0]=="cell" && Items.back()=="." &&
+	  StrFunc::convert(Items[1],cellN) &&
+	  StrFunc::convert(Items[5],status) && !status &&
+	  StrFunc::convert(Items[7],cinderExit) && !cinderExit &&
+	  Items[10]=="from" && Items[11]=="run" &&
+	  StrFunc::convert(Items[13],startT) &&
+	  StrFunc::convert(Items[14],endT) && endT>startT)
+	Out[cellN]=endT-startT;
+    }
+  return Out;
+}
+
+runJournal::HTYPE
+runJournal::outputHashes(const std::string& DName)
+  /*!
+    Calculate the hashes of the result files in a directory
+    \param DName :: Cell directory
+    \return map of file : hash
+  */
+{
+  ELog::RegMethod RegA("runJournal","outputHashes");
+
+  namespace BF=boost::filesystem;
+
+  HTYPE Out;
+  boost::system::error_code EC;
+  for(BF::directory_iterator di(DName,EC);di!=BF::directory_iterator();di++)
+    {
+      const std::string FName=di->path().filename().string();
+      if (BF::is_regular_file(di->status()) &&
+	  resultCache::isResult(FName))
+	Out.emplace(FName,resultCache::fileHash(di->path().string()));
+    }
+  return Out;
+}
+
+bool
+runJournal::checkOutputs(const int cellN,const std::string& DName) const
+  /*!
+    Check that the outputs of a done cell have the
+    recorded hashes
+    \param cellN :: Cell number [must be in Done]
+    \param DName :: Cell directory
+    \return true if all outputs are intact
+  */
+{
+  ELog::RegMethod RegA("runJournal","checkOutputs");
+
+  const boost::filesystem::path BDir(DName);
+  for(const HTYPE::value_type& HV : Done.find(cellN)->second.second)
+    if (resultCache::fileHash((BDir / HV.first).string())!=HV.second)
+      return 0;
+
+  return 1;
+}
+
+bool
+runJournal::isComplete(const cellJob& CJ) const
+  /*!
+    Determine if a cell has a good record in the journal
+    and its outputs are intact
+    \param CJ :: Job [hashKey set]
+    \return true if the cell need not be re-run
+  */
+{
+  ELog::RegMethod RegA("runJournal","isComplete(cellJob)");
+
+  DTYPE::const_iterator mc=Done.find(CJ.cellN);
+  if (mc==Done.end() || CJ.hashKey.empty() ||
+      mc->second.first!=CJ.hashKey)
+    return 0;
+
+  return checkOutputs(CJ.cellN,CJ.dirName);
+}
+
+bool
+runJournal::isComplete(const int cellN) const
+  /*!
+    Determine if a cell has a good record in the journal.
+    The inputs and outputs in the recorded directory must
+    still match the record.
+    \param cellN :: Cell number
+    \return true if the cell is complete
+  */
+{
+  ELog::RegMethod RegA("runJournal","isComplete(int)");
+
+  DTYPE::const_iterator mc=Done.find(cellN);
+  if (mc==Done.end()) return 0;
+
+  const std::string DName=StrFunc::StrParts(Records.find(cellN)->second)[3];
+  if (resultCache::problemKey(DName)!=mc->second.first)
+    return 0;
+
+  return checkOutputs(cellN,DName);
+}
+
+const std::string&
+runJournal::getRecord(const int cellN) const
+  /*!
+    Get the last good record line of a cell
+    \param cellN :: Cell number
+    \return record line [with newline]
+  */
+{
+  std::map<int,std::string>::const_iterator mc=Records.find(cellN);
+  if (mc==Records.end())
+    throw ColErr::InContainerError<int>(cellN,"cellN in Records");
+  return mc->second;
+}
+
+bool
+runJournal::getShard(size_t& I,size_t& N) const
+  /*!
+    Get the shard spec recorded in the journal
+    \param I :: Shard index
+    \param N :: Number of shards
+    \return true if the journal is from a sharded run
+  */
+{
+  I=shardIndex;
+  N=nShard;
+  return (nShard>0);
+}
+
+void
+runJournal::writeLine(const std::string& Line)
+  /*!
+    Append a line in one write() so concurrent appends
+    do not interleave.
+    \param Line :: Complete line [with newline]
+  */
+{
+  ELog::RegMethod RegA("runJournal","writeLine");
+
+  if (fd<0)
+    throw ColErr::FileError(0,"runJournal [read only]",fileName);
+
+  ssize_t nOut;
+  do
+    {
+      nOut=write(fd,Line.c_str(),Line.size());
+    } while (nOut<0 && errno==EINTR);
+
+  if (nOut!=static_cast<ssize_t>(Line.size()))
+    ELog::EM<<"Failed to write journal "<<fileName<<ELog::endErr;
+  else
+    fdatasync(fd);
+  return;
+}
+
+void
+runJournal::append(const std::string& Line)
+  /*!
+    Append a record from another journal
+    \param Line :: Record line [with newline]
+  */
+{
+  writeLine(Line);
+  return;
+}
+
+void
+runJournal::writeShard(const size_t I,const size_t N,
+		       const std::vector<int>& Cells)
+  /*!
+    Record the shard spec and the cells planned for it
+    \param I :: Shard index
+    \param N :: Number of shards
+    \param Cells :: Cells of the shard
+  */
+{
+  std::ostringstream cx;
+  cx<<"# shard "<<I<<" "<<N<<"\n";
+  cx<<"# cells";
+  for(const int CN : Cells)
+    cx<<" "<<CN;
+  cx<<"\n";
+  writeLine(cx.str());
+  return;
+}
+
+void
+runJournal::record(const cellJob& CJ)
+  /*!
+    Append the record of a finished job. The from field
+    is run / cache / the cell the results were copied from.
+    \param CJ :: Finished job
+  */
+{
+  ELog::RegMethod RegA("runJournal","record");
+
+  const HTYPE Outputs=(CJ.status) ? HTYPE() : outputHashes(CJ.dirName);
+
+  std::ostringstream cx;
+  cx<<"cell "<<CJ.cellN<<" dir "<<CJ.dirName
+    <<" status "<<CJ.status<<" cinder "<<CJ.cinderExit
+    <<" tabcode "<<CJ.tabcodeExit
+    <<" from ";
+  if (CJ.sourceCell)
+    cx<<CJ.sourceCell;
+  else
+    cx<<((CJ.cacheHit) ? "cache" : "run");
+  cx<<" time "<<std::fixed<<std::setprecision(3)
+    <<CJ.startTime<<" "<<CJ.endTime
+    <<" key "<<((CJ.hashKey.empty()) ? "-" : CJ.hashKey)
+    <<" outputs "<<Outputs.size();
+  for(const HTYPE::value_type& HV : Outputs)
+    cx<<" "<<HV.first<<" "<<HV.second;
+  cx<<" .\n";
+
+  writeLine(cx.str());
+  return;
+}
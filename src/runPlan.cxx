@@ -0,0 +1,281 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/runPlan.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <functional>
+#include <chrono>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "runProgs.h"
+#include "cellJob.h"
+#include "resultCache.h"
+#include "runJournal.h"
+#include "cellRunner.h"
+#include "Control.h"
+#include "shardPlan.h"
+#include "cellDedup.h"
+#include "runPlan.h"
+
+runPlan::runPlan(const Control& C) :
+  Ctrl(C)
+  /*!
+    Constructor
+    \param C :: Control [problem and run options]
+  */
+{}
+
+runPlan::~runPlan()
+  /*!
+    Destructor
+  */
+{}
+
+void
+runPlan::writePlan() const
+  /*!
+    Write the cinder input deck for each cell [of the shard]
+    in each history and a manifest of the jobs to run instead
+    of running them. Each job can then be run by runCell.
+    A job also takes the cells that copy its results [dedup]
+    so the jobs match those of a full run. On resume the
+    journals are read here and completed jobs are left out.
+  */
+{
+  ELog::RegMethod RegA("runPlan","writePlan");
+
+  if (!Ctrl.sweepScale.empty() || Ctrl.uqSamples)
+    throw ColErr::InvalidLine("norm_sweep/uq_samples",
+			      "Not supported in plan mode");
+
+  const runProgs& RP=runProgs::Instance();
+  const shardPlan SP(Ctrl);
+  const std::vector<int> Cells=SP.shardCells();
+  const std::set<int> runCells(Cells.begin(),Cells.end());
+  const std::string JName=(Ctrl.nShard) ?
+    SP.shardJournal(Ctrl.shardIndex) : Ctrl.journalFile;
+
+  const cellDedup CD(Ctrl);
+  std::map<int,int> Source=CD.dedupCells(Cells);
+  const std::map<int,std::pair<double,double>> Scale=
+    CD.clusterCells(Cells,Source);
+  CD.writeSourceMap(Cells.size(),Source,Scale);
+
+  // cell jobs in the cell list order [log index]
+  std::vector<cellJob> Jobs;
+  size_t index(1);
+  for(const std::map<int,double>::value_type& CV : Ctrl.Vols)
+    if (Ctrl.fluxes.isValid(CV.first,Ctrl.fluxTol))
+      {
+	if (runCells.count(CV.first))
+	  Jobs.push_back(cellJob(CV.first,Ctrl.getOutDir(CV.first),
+				 CV.second,index));
+	index++;
+      }
+
+  if (Ctrl.Histories.hasScenarios())
+    Ctrl.writeDecks(Cells);
+
+  const std::string TName=Ctrl.manifestFile+".tmp";
+  std::ofstream OX(TName.c_str());
+  OX<<"# activation manifest"<<std::endl;
+  OX<<"# job id cell N group G dir D volume V log L cost C journal J "
+    "cinder EXE LOG tabcode EXE LOG copies N [CELL DIR VOLUME LOG SCALE "
+    "BOUND] outputs N FILES ."<<std::endl;
+
+  const std::map<int,double> Cost=SP.featureCost();
+  const std::vector<std::string>& Outputs=cellJob::expectedOutputs();
+  size_t jobID(1);
+  size_t nDone(0);
+  for(const std::string& G : Ctrl.Histories.getGroups())
+    {
+      const std::string GJName=Ctrl.Histories.groupPath(G,JName);
+      if (!G.empty())
+	boost::filesystem::create_directories
+	  (boost::filesystem::path(GJName).parent_path());
+      // read once here : runCell only appends
+      runJournal JR(GJName,Ctrl.resumeFlag);
+      if (Ctrl.nShard)
+	JR.writeShard(Ctrl.shardIndex,Ctrl.nShard,Cells);
+
+      std::vector<cellJob> GJobs;
+      for(const cellJob& JItem : Jobs)
+	{
+	  GJobs.push_back(JItem);
+	  cellJob& CJ(GJobs.back());
+	  CJ.dirName=Ctrl.Histories.groupPath(G,CJ.dirName);
+	  CJ.runDir=CJ.dirName;
+	  CJ.group=G;
+	  Ctrl.writeCellInput(CJ.dirName,CJ.cellN,CJ.volume,1.0,G);
+	}
+
+      for(const cellJob& CJ : GJobs)
+	{
+	  if (Source.find(CJ.cellN)!=Source.end())
+	    continue;
+	  std::vector<const cellJob*> Copies;
+	  bool done=JR.isComplete(CJ.cellN);
+	  for(const cellJob& CC : GJobs)
+	    {
+	      std::map<int,int>::const_iterator mc=Source.find(CC.cellN);
+	      if (mc!=Source.end() && mc->second==CJ.cellN)
+		{
+		  Copies.push_back(&CC);
+		  done&=JR.isComplete(CC.cellN);
+		}
+	    }
+	  if (done)
+	    {
+	      nDone++;
+	      continue;
+	    }
+
+	  OX<<"job "<<jobID++<<" cell "<<CJ.cellN
+	    <<" group "<<((G.empty()) ? "-" : G)<<" dir "<<CJ.dirName
+	    <<" volume "<<CJ.volume<<" log "<<CJ.logIndex
+	    <<" cost "<<Cost.find(CJ.cellN)->second<<" journal "<<GJName
+	    <<" cinder "<<RP.getCinderEXE()<<" "<<CJ.cinderLog()
+	    <<" tabcode "<<RP.getTabcodeEXE()<<" "<<CJ.tabcodeLog()
+	    <<" copies "<<Copies.size();
+	  for(const cellJob* CPtr : Copies)
+	    {
+	      std::map<int,std::pair<double,double>>::const_iterator
+		sc=Scale.find(CPtr->cellN);
+	      OX<<" "<<CPtr->cellN<<" "<<CPtr->dirName<<" "<<CPtr->volume
+		<<" "<<CPtr->logIndex<<" "
+		<<((sc!=Scale.end()) ? sc->second.first : 1.0)<<" "
+		<<((sc!=Scale.end()) ? sc->second.second : 0.0);
+	    }
+	  OX<<" outputs "<<Outputs.size();
+	  for(const std::string& OName : Outputs)
+	    OX<<" "<<OName;
+	  OX<<" ."<<std::endl;
+	}
+    }
+  OX.close();
+  if (OX.fail())
+    throw ColErr::FileError(0,"Manifest",TName);
+  boost::filesystem::rename(TName,Ctrl.manifestFile);
+
+  ELog::EM<<"Manifest "<<Ctrl.manifestFile<<" : "<<jobID-1
+	  <<" jobs [ "<<nDone<<" done ]"<<ELog::endDiag;
+  return;
+}
+
+int
+runPlan::runCell(const size_t jobID) const
+  /*!
+    Run a single job of the manifest written by writePlan
+    and the copies of its results. The run uses the result
+    cache and is appended to the journal of its history
+    [which is shared by all the job runs and is not read].
+    \param jobID :: Job id in the manifest
+    \return status of the job [0 : success]
+  */
+{
+  ELog::RegMethod RegA("runPlan","runCell");
+
+  std::ifstream IX(Ctrl.manifestFile.c_str());
+  if (!IX.good())
+    throw ColErr::FileError(0,"Manifest",Ctrl.manifestFile);
+
+  std::string Line;
+  while(std::getline(IX,Line))
+    {
+      const std::vector<std::string> Items=StrFunc::StrParts(Line);
+      int ID,cellN,logIndex,nCopy;
+      double Vol;
+      if (Items.size()>23 && Items[0]=="job" &&
+	  StrFunc::convert(Items[1],ID) && ID>0 &&
+	  static_cast<size_t>(ID)==jobID)
+	{
+	  if (!StrFunc::convert(Items[3],cellN) ||
+	      !StrFunc::convert(Items[9],Vol) ||
+	      !StrFunc::convert(Items[11],logIndex) || logIndex<0 ||
+	      Items[22]!="copies" ||
+	      !StrFunc::convert(Items[23],nCopy) || nCopy<0 ||
+	      Items.size()<24+6*static_cast<size_t>(nCopy))
+	    throw ColErr::InvalidLine(Line,"Manifest job");
+
+	  const std::string G=(Items[5]=="-") ? "" : Items[5];
+	  resultCache RC(Ctrl.cacheDir,Ctrl.cacheSize*1024*1024);
+	  runJournal JR(Items[15],1,0);
+	  cellRunner CR(1);
+	  if (!Ctrl.cacheDir.empty())
+	    CR.setCache(&RC);
+	  CR.setJournal(G,&JR);
+	  Ctrl.setRunner(CR);
+
+	  cellJob CJ(cellN,Items[7],Vol,static_cast<size_t>(logIndex));
+	  CJ.group=G;
+	  CR.addJob(CJ);
+	  for(size_t i=24;i<24+6*static_cast<size_t>(nCopy);i+=6)
+	    {
+	      int copyN,copyLog;
+	      double copyVol;
+	      if (!StrFunc::convert(Items[i],copyN) ||
+		  !StrFunc::convert(Items[i+2],copyVol) ||
+		  !StrFunc::convert(Items[i+3],copyLog) || copyLog<0)
+		throw ColErr::InvalidLine(Line,"Manifest copy");
+	      cellJob CC(copyN,Items[i+1],copyVol,
+			 static_cast<size_t>(copyLog));
+	      CC.group=G;
+	      if (!StrFunc::convert(Items[i+4],CC.fluxScale) ||
+		  !StrFunc::convert(Items[i+5],CC.errorBound))
+		throw ColErr::InvalidLine(Line,"Manifest copy");
+	      CR.addCopy(CC,cellN);
+	    }
+	  CR.waitAll();
+	  RC.flush();
+
+	  std::ostringstream cx;
+	  CR.writeStatus(cx);
+	  ELog::EM<<"Cell run status:\n"<<cx.str()<<ELog::endDiag;
+	  return (CR.nFailed()) ? 1 : 0;
+	}
+    }
+  throw ColErr::InContainerError<size_t>(jobID,"Job in "+Ctrl.manifestFile);
+}
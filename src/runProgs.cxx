@@ -32,7 +32,16 @@
 #include <algorithm>
 #include <functional>
 #include <iterator>
-#include <wait.h>
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <poll.h>
+#include <pthread.h>
 #include <unistd.h>
 #include <boost/format.hpp>
 
@@ -51,13 +60,48 @@
 #include "cinderHistory.h"
 #include "runProgs.h"
 
+/// Stop signals received [SIGTERM counts as two]
+static volatile sig_atomic_t stopCount(0);
+/// Handlers replaced by catchSignals
+static struct sigaction oldINT,oldTERM;
+
+static void
+stopHandler(const int sigNum)
+  /*!
+    Record a stop request : the first SIGINT drains the
+    running jobs, a second SIGINT or a SIGTERM kills them
+    \param sigNum :: signal number
+  */
+{
+  stopCount=(sigNum==SIGTERM) ? 2 : stopCount+1;
+  return;
+}
+
+static void
+childHandler(const int)
+  /*!
+    Nothing to do : SIGCHLD only has to end the
+    ppoll in reapChildren
+  */
+{
+  return;
+}
+
 runProgs::runProgs() :
   cinderCMD("/home/ansell/cinder-1.05/src/cinder"),
-  htapeCMD("/home/ansell/BinV270/bin/htape3x")
+  htapeCMD("/home/ansell/BinV270/bin/htape3x"),
+  cpuLimit(0.0),memLimit(0.0)
   /*!
-    Constructor
+    Constructor : SIGCHLD is caught [not ignored] so
+    that a blocked reapChildren wakes when a child exits
   */
-{}
+{
+  struct sigaction SA;
+  sigemptyset(&SA.sa_mask);
+  SA.sa_flags=SA_RESTART | SA_NOCLDSTOP;
+  SA.sa_handler=childHandler;
+  sigaction(SIGCHLD,&SA,0);
+}
 
 
 
@@ -113,100 +157,488 @@ runProgs::setHTapeEXE(const std::string& prog)
   return;
 }
 
-int
-runProgs::runCode(const std::string& CMD)
+void
+runProgs::setEnv(const std::string& name,const std::string& value)
   /*!
-    Run a piece of code
-    \param CMD :: Command to run
-    \return status code
+    Set an environment variable for all children
+    \param name :: variable name
+    \param value :: value
    */
 {
-  ELog::RegMethod RegA("runProgs","runCode");
-  return system(CMD.c_str());
+  envExtra[name]=value;
+  return;
+}
+
+void
+runProgs::setLimits(const double CPU,const double Mem)
+  /*!
+    Set the resource limits of the job children
+    \param CPU :: CPU time limit [sec / 0 : none]
+    \param Mem :: Address space limit [MB / 0 : none]
+   */
+{
+  cpuLimit=CPU;
+  memLimit=Mem;
+  return;
+}
+
+void
+runProgs::catchSignals(const bool flag)
+  /*!
+    Catch SIGINT/SIGTERM [recorded for stopLevel] for the
+    run, or put back the previous handlers. Each phase checks
+    stopLevel and ends early. A stop signal ends a blocked
+    reapChildren at once.
+    \param flag :: true to catch / false to restore
+   */
+{
+  if (flag)
+    {
+      struct sigaction SA;
+      sigemptyset(&SA.sa_mask);
+      SA.sa_flags=0;
+      SA.sa_handler=stopHandler;
+      sigaction(SIGINT,&SA,&oldINT);
+      sigaction(SIGTERM,&SA,&oldTERM);
+    }
+  else
+    {
+      sigaction(SIGINT,&oldINT,0);
+      sigaction(SIGTERM,&oldTERM,0);
+    }
+  return;
 }
 
 int
-runProgs::runHTape(const std::string& ARGS,
-                   const std::string& outFile)
+runProgs::stopLevel()
+  /*!
+    Stop requested by signal
+    \return 0 : none / 1 : drain running jobs / 2 : kill them
+   */
+{
+  return (stopCount>2) ? 2 : static_cast<int>(stopCount);
+}
+
+void
+runProgs::killChild(const pid_t pid,const int sigNum) const
+  /*!
+    Signal a job child and its process group
+    \param pid :: Child process [group leader]
+    \param sigNum :: Signal to send
+   */
+{
+  if (pid>0 && activePID.find(pid)!=activePID.end())
+    kill(-pid,sigNum);
+  return;
+}
+
+std::string
+runProgs::findExe(const std::string& CMD)
   /*!
-    Run a piece of code in htape
-    \param ARGS :: Argunments 
-    \param outFile :: file to write output to [if not empty]
-    \return return code
+    Find the program on the PATH if it has no directory
+    \param CMD :: Program name
+    \return full path [or CMD if not found]
    */
 {
-  ELog::RegMethod RegA("runProgs","runHTape");
+  if (CMD.find('/')!=std::string::npos)
+    return CMD;
 
-  if (outFile.empty())
-    return runCode(htapeCMD+" "+ARGS);
+  const char* pathPtr=getenv("PATH");
+  if (!pathPtr) return CMD;
 
-  return runCode(htapeCMD+" "+ARGS+" > "+outFile);
+  std::string dirName;
+  std::istringstream cx(pathPtr);
+  while(std::getline(cx,dirName,':'))
+    {
+      const std::string fullName=
+	((dirName.empty()) ? "." : dirName)+"/"+CMD;
+      if (!access(fullName.c_str(),X_OK))
+	return fullName;
+    }
+  return CMD;
+}
+
+std::vector<std::string>
+runProgs::buildEnv(const std::map<std::string,std::string>& jobEnv) const
+  /*!
+    Construct the environment of a child : the current
+    environment with envExtra and then jobEnv overwriting
+    \param jobEnv :: Variables of this child only
+    \return NAME=VALUE list
+   */
+{
+  std::map<std::string,std::string> Extra(jobEnv);
+  Extra.insert(envExtra.begin(),envExtra.end());
+
+  std::vector<std::string> Out;
+  for(char** ePtr=environ;*ePtr;ePtr++)
+    {
+      const std::string Item(*ePtr);
+      const std::string::size_type pos=Item.find('=');
+      if (Extra.find(Item.substr(0,pos))==Extra.end())
+	Out.push_back(Item);
+    }
+  for(const std::map<std::string,std::string>::value_type& EV : Extra)
+    Out.push_back(EV.first+"="+EV.second);
+  return Out;
 }
 
 int
-runProgs::runCinder(const std::string& ARGS,
-                    const std::string& outFile)
+runProgs::exitCode(const int wStatus)
+  /*!
+    Convert a waitpid status into an exit code
+    \param wStatus :: status from waitpid
+    \return exit value [128+signal if killed]
+   */
+{
+  if (WIFEXITED(wStatus))
+    return WEXITSTATUS(wStatus);
+  if (WIFSIGNALED(wStatus))
+    return 128+WTERMSIG(wStatus);
+  return -1;
+}
+
+pid_t
+runProgs::forkExec(const std::string& CMD,const std::string& ARGS,
+		   const std::string& workDir,const std::string& outFile,
+		   const std::string& errFile,
+		   const std::map<std::string,std::string>& jobEnv,
+		   int* pipeFD,const int jobFlag)
+  /*!
+    Start a child process. Everything is built before the
+    fork so the child only makes system calls. Job children
+    lead their own process group, so they can be signalled
+    with any children of their own and do not get the
+    terminal signals : the runner decides what to stop.
+    \param CMD :: Program to run
+    \param ARGS :: Space separated arguments
+    \param workDir :: Working directory of child [empty for cwd]
+    \param outFile :: stdout file [relative to workDir / empty to inherit]
+    \param errFile :: stderr file [relative to workDir / empty to inherit]
+    \param jobEnv :: Environment variables of this child
+    \param pipeFD :: if not null : stdout to a pipe [read end]
+    \param jobFlag :: 1 : own process group / 2 : and resource limits
+    \return pid of child / -1 on failure
+   */
+{
+  ELog::RegMethod RegA("runProgs","forkExec");
+
+  // soft CPU limit sends SIGXCPU : the hard limit is the backstop
+  struct rlimit CPULim,MemLim;
+  CPULim.rlim_cur=static_cast<rlim_t>(std::ceil(cpuLimit));
+  CPULim.rlim_max=CPULim.rlim_cur+5;
+  MemLim.rlim_cur=MemLim.rlim_max=
+    static_cast<rlim_t>(memLimit*1024.0*1024.0);
+
+  const std::string exeName=findExe(CMD);
+  std::vector<std::string> argStr=StrFunc::StrParts(ARGS);
+  argStr.insert(argStr.begin(),CMD);
+
+  const std::vector<std::string> envStr=buildEnv(jobEnv);
+
+  std::vector<char*> argV;
+  for(const std::string& A : argStr)
+    argV.push_back(const_cast<char*>(A.c_str()));
+  argV.push_back(0);
+  std::vector<char*> envV;
+  for(const std::string& E : envStr)
+    envV.push_back(const_cast<char*>(E.c_str()));
+  envV.push_back(0);
+
+  int pFD[2]={-1,-1};
+  if (pipeFD && pipe2(pFD,O_CLOEXEC))
+    {
+      ELog::EM<<"Failed to create pipe for "<<CMD<<ELog::endCrit;
+      return -1;
+    }
+
+  std::cout.flush();
+  const pid_t pid=fork();
+  if (pid==0)
+    {
+      const int fileFlag(O_WRONLY | O_CREAT | O_TRUNC);
+      if (jobFlag)
+	setpgid(0,0);
+      if (jobFlag>1 && cpuLimit>0.0 && setrlimit(RLIMIT_CPU,&CPULim))
+	_exit(126);
+      if (jobFlag>1 && memLimit>0.0 && setrlimit(RLIMIT_AS,&MemLim))
+	_exit(126);
+      if (!workDir.empty() && chdir(workDir.c_str()))
+	_exit(126);
+      if (pipeFD)
+	{
+	  if (dup2(pFD[1],STDOUT_FILENO)<0) _exit(126);
+	}
+      else if (!outFile.empty())
+	{
+	  const int fd=open(outFile.c_str(),fileFlag,0644);
+	  if (fd<0 || dup2(fd,STDOUT_FILENO)<0) _exit(126);
+	  close(fd);
+	}
+      if (!errFile.empty())
+	{
+	  const int fd=open(errFile.c_str(),fileFlag,0644);
+	  if (fd<0 || dup2(fd,STDERR_FILENO)<0) _exit(126);
+	  close(fd);
+	}
+      execve(exeName.c_str(),argV.data(),envV.data());
+      _exit(127);
+    }
+
+  if (pipeFD)
+    {
+      close(pFD[1]);
+      if (pid<0)
+	close(pFD[0]);
+      else
+	*pipeFD=pFD[0];
+    }
+  if (pid<0)
+    {
+      ELog::EM<<"Fork failed for "<<CMD<<ELog::endCrit;
+      return -1;
+    }
+  // both sides : the group exists before either uses it
+  if (jobFlag)
+    setpgid(pid,pid);
+  activePID.insert(pid);
+  return pid;
+}
+
+pid_t
+runProgs::startCode(const std::string& CMD,const std::string& ARGS,
+		    const std::string& workDir,const std::string& outFile,
+		    const std::string& errFile,
+		    const std::map<std::string,std::string>& jobEnv)
   /*!
-    Run a piece of code in htape
-    \param ARGS :: Argunments 
-    \param outFile :: file to write output to [if not empty]
-    \return return code
+    Start a program without waiting
+    \param CMD :: Program to run
+    \param ARGS :: Space separated arguments
+    \param workDir :: Working directory of child [empty for cwd]
+    \param outFile :: stdout file [relative to workDir / empty to inherit]
+    \param errFile :: stderr file [relative to workDir / empty to inherit]
+    \param jobEnv :: Environment variables of this child
+    \return pid of child / -1 on failure
    */
 {
-  ELog::RegMethod RegA("runProgs","runCinder");
+  return forkExec(CMD,ARGS,workDir,outFile,errFile,jobEnv,0,0);
+}
 
-  if (outFile.empty())
-    return runCode(cinderCMD+" "+ARGS);
+pid_t
+runProgs::startPipe(const std::string& CMD,const std::string& ARGS,
+		    const std::string& workDir,const std::string& errFile,
+		    const std::map<std::string,std::string>& jobEnv,
+		    int& readFD)
+  /*!
+    Start a program with stdout connected to a pipe
+    \param CMD :: Program to run
+    \param ARGS :: Space separated arguments
+    \param workDir :: Working directory of child [empty for cwd]
+    \param errFile :: stderr file [relative to workDir / empty to inherit]
+    \param jobEnv :: Environment variables of this child
+    \param readFD :: read end of the pipe [-1 on failure / caller closes]
+    \return pid of child / -1 on failure
+   */
+{
+  readFD= -1;
+  return forkExec(CMD,ARGS,workDir,"",errFile,jobEnv,&readFD,0);
+}
 
-  return runCode(cinderCMD+" "+ARGS+" > "+outFile);
+pid_t
+runProgs::startJob(const std::string& CMD,const std::string& ARGS,
+		   const std::string& workDir,const std::string& outFile,
+		   const bool limitFlag)
+  /*!
+    Start a job child in its own process group
+    \param CMD :: Program to run
+    \param ARGS :: Space separated arguments
+    \param workDir :: Working directory of child
+    \param outFile :: stdout file [relative to workDir / empty to inherit]
+    \param limitFlag :: apply the CPU/memory limits
+    \return pid of child / -1 on failure
+   */
+{
+  return forkExec(CMD,ARGS,workDir,outFile,"",
+		  std::map<std::string,std::string>(),0,(limitFlag) ? 2 : 1);
 }
 
-int
-runProgs::runTabCode(const std::string& ARGS,
-                     const std::string& outFile)
+pid_t
+runProgs::startHTape(const std::string& ARGS,const std::string& workDir,
+		     const std::string& outFile)
+  /*!
+    Start htape without waiting
+    \param ARGS :: Arguments
+    \param workDir :: Working directory
+    \param outFile :: stdout file [relative to workDir]
+    \return pid
+   */
+{
+  return startCode(htapeCMD,ARGS,workDir,outFile,"",
+		   std::map<std::string,std::string>());
+}
+
+pid_t
+runProgs::startCinder(const std::string& workDir,const std::string& outFile)
+  /*!
+    Start cinder as a limited job without waiting
+    \param workDir :: Working directory
+    \param outFile :: stdout file [relative to workDir]
+    \return pid
+   */
+{
+  return startJob(cinderCMD,"",workDir,outFile,1);
+}
+
+pid_t
+runProgs::startTabCode(const std::string& workDir,
+		       const std::string& outFile)
   /*!
-    Run a piece of code in htape
-    \param ARGS :: Argunments 
-    \param outFile :: file to write output to [if not empty]
-    \return return code
+    Start tabcode as a limited job without waiting
+    \param workDir :: Working directory
+    \param outFile :: stdout file [relative to workDir]
+    \return pid
    */
 {
-  ELog::RegMethod RegA("runProgs","runTabCode");
+  return startJob(tabcodeCMD,"",workDir,outFile,1);
+}
 
-  if (outFile.empty())
-    return runCode(tabcodeCMD+" "+ARGS);
+pid_t
+runProgs::startTask(const std::function<int()>& Task)
+  /*!
+    Run a function in a forked child [own process group]
+    without waiting. The child has a copy of the data of
+    the process, so the function only works through files.
+    \param Task :: Function to run : its value is the exit code
+    \return pid of child / -1 on failure
+   */
+{
+  ELog::RegMethod RegA("runProgs","startTask");
 
-  return runCode(tabcodeCMD+" "+ARGS+" > "+outFile);
+  std::cout.flush();
+  const pid_t pid=fork();
+  if (pid==0)
+    {
+      setpgid(0,0);
+      int code(1);
+      try
+	{
+	  code=Task();
+	}
+      catch (...) { }
+      std::cout.flush();
+      std::cerr.flush();
+      _exit(code);
+    }
+  if (pid<0)
+    {
+      ELog::EM<<"Fork failed for task"<<ELog::endCrit;
+      return -1;
+    }
+  setpgid(pid,pid);
+  activePID.insert(pid);
+  return pid;
 }
 
+bool
+runProgs::pollChildren()
+  /*!
+    Collect the registered children that have finished.
+    Only our own pids are waited on : any other child of
+    the process [e.g. from a library] is left alone.
+    \return true if a child was collected
+   */
+{
+  bool found(0);
+  std::set<pid_t>::iterator ac=activePID.begin();
+  while(ac!=activePID.end())
+    {
+      int wStatus(0);
+      pid_t pid;
+      do
+	{
+	  pid=waitpid(*ac,&wStatus,WNOHANG);
+	} while(pid<0 && errno==EINTR);
 
+      if (pid==*ac || (pid<0 && errno==ECHILD))
+	{
+	  donePID[*ac]=(pid<0) ? -1 : exitCode(wStatus);
+	  activePID.erase(ac++);
+	  found=1;
+	}
+      else
+	ac++;
+    }
+  return found;
+}
 
+bool
+runProgs::reapChildren(const bool blockFlag,const double maxWait)
+  /*!
+    Collect all the finished children. A blocked wait sleeps
+    in ppoll with SIGCHLD unblocked, so it wakes when a child
+    exits, on a stop signal or at maxWait. The sleep is cut
+    into short steps in case SIGCHLD goes to another thread.
+    \param blockFlag :: wait until at least one child finishes
+    \param maxWait :: Longest wait if blocking [sec / 0 : no limit]
+    \return true if a child was collected
+   */
+{
+  if (!blockFlag || activePID.empty())
+    return pollChildren();
 
+  sigset_t chldMask,origMask;
+  sigemptyset(&chldMask);
+  sigaddset(&chldMask,SIGCHLD);
+  pthread_sigmask(SIG_BLOCK,&chldMask,&origMask);
+  sigset_t waitMask(origMask);
+  sigdelset(&waitMask,SIGCHLD);
 
-/*		  /
-  pid_t pid = fork(); // create child proces
+  typedef std::chrono::steady_clock clockTYPE;
+  const clockTYPE::time_point endTime=clockTYPE::now()+
+    std::chrono::duration_cast<clockTYPE::duration>
+    (std::chrono::duration<double>(maxWait));
+  const sig_atomic_t stopStart(stopCount);
 
-  char** ARGV=
-  switch (pid)
+  bool found(0);
+  while(!activePID.empty() && !(found=pollChildren()) &&
+	stopCount==stopStart)
     {
-    case -1:
-      ELog::EM<<"ERROR Fork failed"<<ELog::endErr;
-      return;
-    case 0: 
-      ELog::EM<<"Calling CHILD PROCESS:"<<CMD<<ELog::endDiag;
-      execv(CMD.c_str(), ); // Execute the program
-      ELog::EM<<"Failed to start process "<<ELog::endErr;
-      return;
-    default:
-      ELog::EM << "Process created with pid " << pid << ELog::endDiag;;
-      int status;
-      
-      while (!WIFEXITED(status))
+      double W(0.5);
+      if (maxWait>0.0)
 	{
-	  waitpid(pid, status, 0); // Wait for process
+	  const double R=std::chrono::duration<double>
+	    (endTime-clockTYPE::now()).count();
+	  if (R<=0.0) break;
+	  W=std::min(W,R);
 	}
-      
-      ELog::EM << "Process exited  " << WEXITSTATUS(status) << ELog::endDiag;
+      struct timespec TS;
+      TS.tv_sec=static_cast<time_t>(W);
+      TS.tv_nsec=static_cast<long int>
+	(1e9*(W-static_cast<double>(TS.tv_sec)));
+      ppoll(0,0,&TS,&waitMask);
     }
-		  
-*/
+  pthread_sigmask(SIG_SETMASK,&origMask,0);
+  return found;
+}
+
+int
+runProgs::checkChild(const pid_t pid,int& code)
+  /*!
+    Non-blocking check of a child
+    \param pid :: Child process
+    \param code :: Exit code [if finished]
+    \return 1 if finished / 0 if still running
+   */
+{
+  std::map<pid_t,int>::iterator mc=donePID.find(pid);
+  if (mc==donePID.end())
+    {
+      reapChildren(0,0.0);
+      mc=donePID.find(pid);
+      if (mc==donePID.end())
+	return 0;
+    }
+  code=mc->second;
+  donePID.erase(mc);
+  return 1;
+}
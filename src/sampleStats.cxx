@@ -0,0 +1,232 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/sampleStats.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <boost/format.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "pSquare.h"
+#include "sampleStats.h"
+
+sampleStats::sampleStats() :
+  nSample(0)
+  /*!
+    Constructor
+  */
+{}
+
+sampleStats::sampleStats(const sampleStats& A) :
+  Lines(A.Lines),Spans(A.Spans),nSample(A.nSample),
+  Mean(A.Mean),M2(A.M2),QLow(A.QLow),QMid(A.QMid),QHigh(A.QHigh)
+  /*!
+    Copy constructor
+    \param A :: sampleStats to copy
+  */
+{}
+
+sampleStats&
+sampleStats::operator=(const sampleStats& A)
+  /*!
+    Assignment operator
+    \param A :: sampleStats to copy
+    \return *this
+  */
+{
+  if (this!=&A)
+    {
+      Lines=A.Lines;
+      Spans=A.Spans;
+      nSample=A.nSample;
+      Mean=A.Mean;
+      M2=A.M2;
+      QLow=A.QLow;
+      QMid=A.QMid;
+      QHigh=A.QHigh;
+    }
+  return *this;
+}
+
+sampleStats::~sampleStats()
+  /*!
+    Destructor
+  */
+{}
+
+void
+sampleStats::splitLine(const std::string& Line,STYPE& Items,
+		       std::vector<double>& Values)
+  /*!
+    Find the numbers in a line
+    \param Line :: Line to split
+    \param Items :: Spans of the numbers [added to]
+    \param Values :: Numbers [added to]
+  */
+{
+  size_t pos(0);
+  while(pos<Line.size())
+    {
+      while(pos<Line.size() && std::isspace(Line[pos])) pos++;
+      const size_t start(pos);
+      while(pos<Line.size() && !std::isspace(Line[pos])) pos++;
+      double V;
+      if (pos>start && StrFunc::convert(Line.substr(start,pos-start),V))
+	{
+	  Items.push_back(std::pair<size_t,size_t>(start,pos-start));
+	  Values.push_back(V);
+	}
+    }
+  return;
+}
+
+bool
+sampleStats::addFile(const std::string& FName)
+  /*!
+    Add a sample file
+    \param FName :: File of the sample
+    \return true if added [false if missing / different layout]
+  */
+{
+  ELog::RegMethod RegA("sampleStats","addFile");
+
+  std::ifstream IX(FName.c_str());
+  if (!IX.good()) return 0;
+
+  std::vector<std::string> FLines;
+  std::vector<STYPE> FSpans;
+  std::vector<double> Values;
+  std::string Line;
+  while(std::getline(IX,Line))
+    {
+      FLines.push_back(Line);
+      FSpans.push_back(STYPE());
+      splitLine(Line,FSpans.back(),Values);
+    }
+
+  if (!nSample)
+    {
+      Lines=FLines;
+      Spans=FSpans;
+      Mean.assign(Values.size(),0.0);
+      M2.assign(Values.size(),0.0);
+      QLow.assign(Values.size(),pSquare(0.05));
+      QMid.assign(Values.size(),pSquare(0.5));
+      QHigh.assign(Values.size(),pSquare(0.95));
+    }
+  else
+    {
+      if (FSpans.size()!=Spans.size()) return 0;
+      for(size_t i=0;i<Spans.size();i++)
+	if (FSpans[i].size()!=Spans[i].size()) return 0;
+    }
+
+  nSample++;
+  const double N(static_cast<double>(nSample));
+  for(size_t i=0;i<Values.size();i++)
+    {
+      const double D=Values[i]-Mean[i];
+      Mean[i]+=D/N;
+      M2[i]+=D*(Values[i]-Mean[i]);
+      QLow[i].addValue(Values[i]);
+      QMid[i].addValue(Values[i]);
+      QHigh[i].addValue(Values[i]);
+    }
+  return 1;
+}
+
+void
+sampleStats::writeFile(const std::string& FName,
+		       const std::vector<double>& Values) const
+  /*!
+    Write the template with the numbers replaced
+    \param FName :: Output file
+    \param Values :: Numbers in template order
+  */
+{
+  ELog::RegMethod RegA("sampleStats","writeFile");
+
+  boost::format FMT("%12.5e");
+  std::ofstream OX(FName.c_str());
+  size_t index(0);
+  for(size_t i=0;i<Lines.size();i++)
+    {
+      size_t pos(0);
+      for(const std::pair<size_t,size_t>& SP : Spans[i])
+	{
+	  OX<<Lines[i].substr(pos,SP.first-pos)
+	    <<(FMT % Values[index++]).str();
+	  pos=SP.first+SP.second;
+	}
+      OX<<Lines[i].substr(pos)<<std::endl;
+    }
+  OX.close();
+  if (OX.fail())
+    ELog::EM<<"Failed to write "<<FName<<ELog::endErr;
+  return;
+}
+
+void
+sampleStats::write(const std::string& FBase) const
+  /*!
+    Write the statistics files
+    \param FBase :: Base name [.mean/.std/.p05/.p50/.p95 added]
+  */
+{
+  ELog::RegMethod RegA("sampleStats","write");
+
+  if (!nSample) return;
+
+  std::vector<double> SD(M2.size());
+  for(size_t i=0;i<M2.size();i++)
+    SD[i]=(nSample>1) ?
+      std::sqrt(M2[i]/static_cast<double>(nSample-1)) : 0.0;
+
+  std::vector<double> PL(QLow.size()),PM(QMid.size()),PH(QHigh.size());
+  for(size_t i=0;i<QLow.size();i++)
+    {
+      PL[i]=QLow[i].getValue();
+      PM[i]=QMid[i].getValue();
+      PH[i]=QHigh[i].getValue();
+    }
+
+  writeFile(FBase+".mean",Mean);
+  writeFile(FBase+".std",SD);
+  writeFile(FBase+".p05",PL);
+  writeFile(FBase+".p50",PM);
+  writeFile(FBase+".p95",PH);
+  return;
+}
@@ -0,0 +1,154 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/scenarioSet.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+
+scenarioSet::scenarioSet()
+  /*!
+    Constructor
+  */
+{}
+
+scenarioSet::scenarioSet(const scenarioSet& A) :
+  mainHistory(A.mainHistory),Scenarios(A.Scenarios)
+  /*!
+    Copy constructor
+    \param A :: scenarioSet to copy
+  */
+{}
+
+scenarioSet&
+scenarioSet::operator=(const scenarioSet& A)
+  /*!
+    Assignment operator
+    \param A :: scenarioSet to copy
+    \return *this
+  */
+{
+  if (this!=&A)
+    {
+      mainHistory=A.mainHistory;
+      Scenarios=A.Scenarios;
+    }
+  return *this;
+}
+
+scenarioSet::~scenarioSet()
+  /*!
+    Destructor
+  */
+{}
+
+std::string
+scenarioSet::scenarioPath(const std::string& SName,
+			  const std::string& PName)
+  /*!
+    Put a path in the subtree of a scenario
+    \param SName :: Scenario name
+    \param PName :: Path [file or directory base]
+    \return path with the scenario before the last component
+   */
+{
+  const boost::filesystem::path P(PName);
+  return (P.parent_path() / SName / P.filename()).string();
+}
+
+void
+scenarioSet::addLine(const std::string& histName,
+		     const std::string& AWord,std::string line)
+  /*!
+    Add a line of a history
+    \param histName :: Named history [empty : main history]
+    \param AWord :: First word of the line
+    \param line :: Rest of the line
+  */
+{
+  if (histName.empty())
+    mainHistory.addLine(AWord,line);
+  else
+    Scenarios[histName].addLine(AWord,line);
+  return;
+}
+
+const cinderHistory&
+scenarioSet::getHistory(const std::string& group) const
+  /*!
+    Get the history of a group of jobs
+    \param group :: Named history [empty : main history]
+    \return history
+   */
+{
+  if (group.empty())
+    return mainHistory;
+  std::map<std::string,cinderHistory>::const_iterator mc=
+    Scenarios.find(group);
+  if (mc==Scenarios.end())
+    throw ColErr::InContainerError<std::string>(group,"Scenarios");
+  return mc->second;
+}
+
+std::vector<std::string>
+scenarioSet::getGroups() const
+  /*!
+    Groups to run : the main history [if it has steps or
+    there is nothing else] and each named history
+    \return group names [empty : main history]
+   */
+{
+  std::vector<std::string> Out;
+  if (mainHistory.nSteps() || Scenarios.empty())
+    Out.push_back("");
+  for(const std::map<std::string,cinderHistory>::value_type& SV : Scenarios)
+    Out.push_back(SV.first);
+  return Out;
+}
+
+std::string
+scenarioSet::groupPath(const std::string& group,
+		       const std::string& PName) const
+  /*!
+    Path of a file/directory of a group
+    \param group :: Named history [empty : main history]
+    \param PName :: Path of the main history
+    \return path in the subtree of the group
+   */
+{
+  return (group.empty()) ? PName : scenarioPath(group,PName);
+}
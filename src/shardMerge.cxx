@@ -0,0 +1,150 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/shardMerge.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "runJournal.h"
+#include "Control.h"
+#include "shardPlan.h"
+#include "shardMerge.h"
+
+shardMerge::shardMerge(const Control& C) :
+  Ctrl(C)
+  /*!
+    Constructor
+    \param C :: Control [problem and run options]
+  */
+{}
+
+shardMerge::~shardMerge()
+  /*!
+    Destructor
+  */
+{}
+
+size_t
+shardMerge::mergeGroup(const std::string& G,const size_t N) const
+  /*!
+    Merge the shard journals of one history into its
+    journal. The shard journals are only read.
+    \param G :: Named history [empty : main history]
+    \param N :: Number of shards
+    \return number of missing/failed cells [+ bad shards]
+  */
+{
+  ELog::RegMethod RegA("shardMerge","mergeGroup");
+
+  const std::string MName=Ctrl.Histories.groupPath(G,Ctrl.journalFile);
+  const boost::filesystem::path MPath=
+    boost::filesystem::path(MName).parent_path();
+  if (!MPath.empty())
+    boost::filesystem::create_directories(MPath);
+
+  runJournal MJ(MName,0);
+  const shardPlan SP(Ctrl);
+  size_t nBad(0);
+  size_t nCells(0);
+  std::vector<int> Missing;
+  for(size_t i=0;i<N;i++)
+    {
+      const std::string SName=Ctrl.Histories.groupPath(G,SP.shardJournal(i));
+      if (!boost::filesystem::exists(SName))
+	{
+	  ELog::EM<<"Missing shard journal "<<SName<<ELog::endWarn;
+	  nBad++;
+	  continue;
+	}
+      const runJournal SJ(SName);
+      size_t SI,SN;
+      if (!SJ.getShard(SI,SN) || SI!=i || SN!=N)
+	{
+	  ELog::EM<<"Journal "<<SName<<" is not shard "
+		  <<i<<"/"<<N<<ELog::endWarn;
+	  nBad++;
+	  continue;
+	}
+      for(const int CN : SJ.getPlanned())
+	{
+	  nCells++;
+	  if (SJ.isComplete(CN))
+	    MJ.append(SJ.getRecord(CN));
+	  else
+	    Missing.push_back(CN);
+	}
+    }
+
+  ELog::EM<<"Merged "<<nCells-Missing.size()<<" of "<<nCells
+	  <<" cells from "<<N-nBad<<" of "<<N<<" shards into "
+	  <<MName<<ELog::endDiag;
+  if (!Missing.empty())
+    {
+      std::ostringstream cx;
+      std::copy(Missing.begin(),Missing.end(),
+		std::ostream_iterator<int>(cx," "));
+      ELog::EM<<"Incomplete cells : "<<cx.str()<<ELog::endCrit;
+    }
+  return Missing.size()+nBad;
+}
+
+size_t
+shardMerge::merge(const size_t N) const
+  /*!
+    Merge the journals of a run split into N shards into
+    the main journal and the journal of each named history.
+    Every cell planned for a shard must have a good record
+    with the inputs and outputs intact.
+    \param N :: Number of shards
+    \return number of missing/failed cells [+ bad shards]
+  */
+{
+  ELog::RegMethod RegA("shardMerge","merge");
+
+  size_t nBad(0);
+  for(const std::string& G : Ctrl.Histories.getGroups())
+    nBad+=mergeGroup(G,N);
+  return nBad;
+}
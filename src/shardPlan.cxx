@@ -0,0 +1,215 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/shardPlan.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "runJournal.h"
+#include "Control.h"
+#include "shardPlan.h"
+
+shardPlan::shardPlan(const Control& C) :
+  Ctrl(C)
+  /*!
+    Constructor
+    \param C :: Control [problem and run options]
+  */
+{}
+
+shardPlan::~shardPlan()
+  /*!
+    Destructor
+  */
+{}
+
+std::string
+shardPlan::shardJournal(const size_t I) const
+  /*!
+    Name of the journal of a shard
+    \param I :: Shard index
+    \return journal file name
+  */
+{
+  return Ctrl.journalFile+"."+StrFunc::makeString(I);
+}
+
+std::map<int,double>
+shardPlan::featureCost() const
+  /*!
+    Relative cost of the CINDER run of each cell with flux.
+    The chain solution scales with the number of nuclides
+    [material + spallation products] and the number of time
+    steps. More flux populates more of the chains so it is
+    included as a weak [log] factor.
+    \return map of cell : cost [arb. units]
+  */
+{
+  ELog::RegMethod RegA("shardPlan","featureCost");
+
+  std::map<int,double> Flux;
+  double fluxSum(0.0);
+  for(const std::map<int,double>::value_type& CV : Ctrl.Vols)
+    {
+      const double F=Ctrl.fluxes.integralFlux(CV.first);
+      if (F>=Ctrl.fluxTol)
+	{
+	  Flux.emplace(CV.first,F);
+	  fluxSum+=F;
+	}
+    }
+  const double fluxRef=(Flux.empty()) ? 1.0 : fluxSum/
+    static_cast<double>(Flux.size());
+  
+  const double nSteps=
+    static_cast<double>(Ctrl.Histories.getMain().nSteps()+1);
+  std::map<int,double> Out;
+  for(const std::map<int,double>::value_type& FV : Flux)
+    {
+      std::map<int,int>::const_iterator mc=Ctrl.MatNumber.find(FV.first);
+      const size_t nMat=(mc==Ctrl.MatNumber.end()) ? 0 :
+	Ctrl.matCards.nComponents(mc->second);
+      const double nNuc=
+	static_cast<double>(nMat+Ctrl.HT.nProducts(FV.first)+1);
+      Out.emplace(FV.first,nSteps*nNuc*(1.0+std::log1p(FV.second/fluxRef)));
+    }
+  return Out;
+}
+
+std::map<int,double>
+shardPlan::predictRunTimes(const std::vector<int>& Cells,
+			   const std::string& JName) const
+  /*!
+    Predict the run time of each cell. Cells with a measured
+    time in the journal of a previous run use it, the others
+    use the feature cost scaled by a least squares fit of the
+    measured times.
+    \param Cells :: Cells to predict
+    \param JName :: Journal of the previous run
+    \return map of cell : time [sec / arb. units if nothing measured]
+  */
+{
+  ELog::RegMethod RegA("shardPlan","predictRunTimes");
+
+  const std::map<int,double> Cost=featureCost();
+  const std::map<int,double> Times=runJournal::readTimes(JName);
+
+  double sumTF(0.0),sumFF(0.0);
+  size_t nMeasured(0);
+  for(const int CN : Cells)
+    {
+      std::map<int,double>::const_iterator tc=Times.find(CN);
+      std::map<int,double>::const_iterator fc=Cost.find(CN);
+      if (tc!=Times.end() && fc!=Cost.end())
+	{
+	  sumTF+=tc->second*fc->second;
+	  sumFF+=fc->second*fc->second;
+	  nMeasured++;
+	}
+    }
+  const double scale=(sumFF>0.0) ? sumTF/sumFF : 1.0;
+
+  std::map<int,double> Out;
+  for(const int CN : Cells)
+    {
+      std::map<int,double>::const_iterator tc=Times.find(CN);
+      std::map<int,double>::const_iterator fc=Cost.find(CN);
+      if (tc!=Times.end())
+	Out.emplace(CN,tc->second);
+      else
+	Out.emplace(CN,(fc!=Cost.end()) ? scale*fc->second : 0.0);
+    }
+  ELog::EM<<"Cost model : "<<nMeasured<<" of "<<Cells.size()
+	  <<" cells measured : scale "<<scale<<ELog::endDiag;
+  return Out;
+}
+
+std::vector<int>
+shardPlan::shardCells() const
+  /*!
+    Determine the cells of this shard. The cells with flux
+    are split over nShard by longest processing time first
+    on the predicted cost, so every node makes the same
+    partition without communication.
+    \return cells to run [in cell order]
+  */
+{
+  ELog::RegMethod RegA("shardPlan","shardCells");
+
+  // Only the features are used so all nodes agree
+  std::vector<std::pair<double,int>> Cost;
+  for(const std::map<int,double>::value_type& CV : featureCost())
+    Cost.push_back(std::pair<double,int>(CV.second,CV.first));
+
+  std::vector<int> Out;
+  if (Ctrl.nShard<2)
+    {
+      for(const std::pair<double,int>& CP : Cost)
+	Out.push_back(CP.second);
+      return Out;
+    }
+
+  std::sort(Cost.begin(),Cost.end(),
+	    [](const std::pair<double,int>& A,const std::pair<double,int>& B)
+	    {
+	      return (A.first>B.first) ||
+		(A.first==B.first && A.second<B.second);
+	    });
+
+  std::vector<double> Load(Ctrl.nShard,0.0);
+  for(const std::pair<double,int>& CP : Cost)
+    {
+      const size_t best=static_cast<size_t>
+	(std::min_element(Load.begin(),Load.end())-Load.begin());
+      Load[best]+=CP.first;
+      if (best==Ctrl.shardIndex)
+	Out.push_back(CP.second);
+    }
+  std::sort(Out.begin(),Out.end());
+
+  ELog::EM<<"Shard "<<Ctrl.shardIndex<<"/"<<Ctrl.nShard<<" : "<<Out.size()
+	  <<" of "<<Cost.size()<<" cells : cost "<<Load[Ctrl.shardIndex]
+	  <<" [max "<<*std::max_element(Load.begin(),Load.end())
+	  <<"]"<<ELog::endDiag;
+  return Out;
+}
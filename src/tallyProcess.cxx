@@ -24,7 +24,11 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
 #include <climits>
+#include <cfloat>
 #include <string>
 #include <vector>
 #include <set>
@@ -46,12 +50,14 @@
 #include "RegMethod.h"
 #include "OutputLog.h"
 #include "support.h"
+#include "stringCombine.h"
 #include "regexSupport.h"
 #include "doubleErr.h"
 #include "mathSupport.h"
 #include "BUnit.h"
 #include "Boundary.h"
 #include "WorkData.h"
+#include "mappedFile.h"
 #include "tallyProcess.h"
 
 
@@ -144,11 +150,90 @@ tallyProcess::addFlux(const int cellN,const WorkData& WD)
 }
   
 
+static const char*
+skipSpace(const char* P,const char* endPtr)
+  /*!
+    Move past white space
+    \param P :: Position in line
+    \param endPtr :: End of line
+    \return first non-space position
+  */
+{
+  while(P<endPtr && std::isspace(static_cast<unsigned char>(*P)))
+    P++;
+  return P;
+}
+
+static size_t
+readWord(const char*& P,const char* endPtr,const char*& W)
+  /*!
+    Read a white space / comma separated word [as StrFunc::section]
+    \param P :: Position in line [moved past the word]
+    \param endPtr :: End of line
+    \param W :: Start of word
+    \return length of word [0 at end of line]
+  */
+{
+  W=skipSpace(P,endPtr);
+  P=W;
+  while(P<endPtr && *P!=',' &&
+	!std::isspace(static_cast<unsigned char>(*P)))
+    P++;
+  const size_t N(static_cast<size_t>(P-W));
+  if (P<endPtr) P++;
+  return N;
+}
+
+static int
+sameWord(const char* W,const size_t N,const char* Key)
+  /*!
+    Compare a word with a key
+    \param W :: Start of word
+    \param N :: Length of word
+    \param Key :: Key [null terminated]
+    \return 1 if the same
+  */
+{
+  return (std::strlen(Key)==N && !std::strncmp(W,Key,N)) ? 1 : 0;
+}
+
+template<typename T>
+static int
+readNumber(const char*& P,const char* endPtr,T& Out)
+  /*!
+    Read a number in place. The word is copied to a
+    small buffer [the map has no null terminator].
+    Integer types must not have a fraction part.
+    \param P :: Position in line [moved past the number]
+    \param endPtr :: End of line
+    \param Out :: Value found
+    \return 1 on success [P unchanged on failure]
+  */
+{
+  const char* W;
+  const char* Q(P);
+  const size_t N=readWord(Q,endPtr,W);
+  char Buffer[64];
+  if (!N || N>=sizeof(Buffer)) return 0;
+  std::memcpy(Buffer,W,N);
+  Buffer[N]=0;
+  char* NEnd;
+  const double V=std::strtod(Buffer,&NEnd);
+  if (NEnd!=Buffer+N || static_cast<double>(static_cast<T>(V))!=V)
+    return 0;
+  Out=static_cast<T>(V);
+  P=Q;
+  return 1;
+}
+
 int
-tallyProcess::find1Tally(std::istream& IX,int& tallyN,long int& nps)  
+tallyProcess::find1Tally(const char*& pos,const char* endPtr,
+			 int& tallyN,long int& nps)  
    /*!
-     Read the file and find any 1tally 
-     \param IX :: input stream
+     Find the next 1tally line. Only the lines that start
+     with 1tally are read [^1tally\\s+(\\d+)\\s+nps =\\s+(\\d+)]
+     \param pos :: Start of a line [moved past the 1tally line]
+     \param endPtr :: End of data
      \param tallyN :: tally number
      \param nps :: number of points
      \return true  on success
@@ -156,32 +241,41 @@ tallyProcess::find1Tally(std::istream& IX,int& tallyN,long int& nps)
 {
   ELog::RegMethod RegA("tallyProcess","find1Tally");
 
-  
-  std::regex tallySearch("^1tally\\s+(\\d+)\\s+nps =\\s+(\\d+)");
-
-  
-  std::vector<int> OutPts;
-  std::string SLine=StrFunc::getLine(IX);  
-  while (IX.good())
+  while((pos=mappedFile::findLine(pos,endPtr,"1tally",6))!=endPtr)
     {
-      if (StrFunc::StrFullSplit(SLine,tallySearch,OutPts) &&
-	  OutPts.size()>1)
+      const char* LEnd=mappedFile::lineEnd(pos,endPtr);
+      const char* P=pos+6;
+      pos=mappedFile::nextLine(LEnd,endPtr);
+
+      int TN;
+      long int NP;
+      if (P<LEnd && std::isspace(static_cast<unsigned char>(*P)) &&
+	  readNumber(P,LEnd,TN))
 	{
-	  tallyN=OutPts[0];
-	  nps=OutPts[1];
-	  return 1;
+	  P=skipSpace(P,LEnd);
+	  if (LEnd-P>5 && !std::strncmp(P,"nps =",5) &&
+	      std::isspace(static_cast<unsigned char>(P[5])))
+	    {
+	      P+=5;
+	      if (readNumber(P,LEnd,NP))
+		{
+		  tallyN=TN;
+		  nps=NP;
+		  return 1;
+		}
+	    }
 	}
-      SLine=StrFunc::getLine(IX);  
     }
   return 0;
 }
 
 void
-tallyProcess::getFluxTally(std::istream& IX,
+tallyProcess::getFluxTally(const char*& pos,const char* endPtr,
                            const long int npsFile)
   /*!
     Read the individual tally and make a workset 
-    \param IX :: Input stream
+    \param pos :: Start of line [moved to the end of the tally]
+    \param endPtr :: End of data
     \param npsFile :: number of points in current file
    */
 {
@@ -191,35 +285,32 @@ tallyProcess::getFluxTally(std::istream& IX,
   // FIRST : read file until :
   //   (a) cell: string string string
   //   (b) energy  is the NEXT line
-  std::string testItem;
-  int cellItem;
-  
-  std::string SLine=StrFunc::getLine(IX);
-
-  while (IX.good() && SLine.find("=======")==std::string::npos)
+  const char* W;
+  while (pos<endPtr)
     {
-
-      
-      if (StrFunc::section(SLine,testItem))
+      const char* LEnd=mappedFile::lineEnd(pos,endPtr);
+      const char* P=pos;
+      pos=mappedFile::nextLine(LEnd,endPtr);
+      if (mappedFile::hasText(P,LEnd,"=======",7))
+	break;
+
+      size_t N=readWord(P,LEnd,W);
+      // both possible
+      if (sameWord(W,N,"cell") || sameWord(W,N,"cell:"))
 	{
-          // both possible
-	  if (testItem=="cell" || testItem=="cell:") 
-	    {
-	      std::vector<int> cellName;
-	      // cell name : name : name 
-	      while(StrFunc::section(SLine,cellItem))
-		cellName.push_back(cellItem);
-	      // energy line 
-	      SLine=StrFunc::getLine(IX);
-	      if (StrFunc::section(SLine,testItem) &&
-		  testItem=="energy")
-		{
-		  readWorkEnergy(IX,npsFile,cellName);
-		}
-	    }
-	}	      
-      SLine=StrFunc::getLine(IX);
-
+	  std::vector<int> cellName;
+	  int cellItem;
+	  // cell name : name : name 
+	  while(readNumber(P,LEnd,cellItem))
+	    cellName.push_back(cellItem);
+	  // energy line 
+	  LEnd=mappedFile::lineEnd(pos,endPtr);
+	  P=pos;
+	  pos=mappedFile::nextLine(LEnd,endPtr);
+	  N=readWord(P,LEnd,W);
+	  if (sameWord(W,N,"energy"))
+	    readWorkEnergy(pos,endPtr,npsFile,cellName);
+	}
     }
   nps+=npsFile;
   return;
@@ -257,11 +348,14 @@ tallyProcess::cinderRebin(std::vector<WorkData>& FluxWork)
   
 
 void
-tallyProcess::readWorkEnergy(std::istream& IX,const long int npsFile,
+tallyProcess::readWorkEnergy(const char*& pos,const char* endPtr,
+			     const long int npsFile,
 			     const std::vector<int>& cellName)
   /*!
-    Read cell fluxes from IX for each cell in cellName
-    \param IX :: Input stream
+    Read cell fluxes for each cell in cellName. The
+    columns are read in place from the data.
+    \param pos :: Start of line [moved past the total line]
+    \param endPtr :: End of data
     \param npsFile :: nps points in the fiel
     \param cellName :: cell list
   */
@@ -274,25 +368,32 @@ tallyProcess::readWorkEnergy(std::istream& IX,const long int npsFile,
   for(size_t index=0;index<cnt;index++)
     FluxWork[index].initX(0.0);
   
-  std::regex tallySearch("^\\s+cell\\s+(\\d+)");
-  std::string SLine=StrFunc::getLine(IX);
   double energy;
-  DError::doubleErr flux;
+  double flux,fluxErr;
 
-  while(IX.good() && SLine.find("total")==std::string::npos)
+  while(pos<endPtr)
     {
-      size_t index(0);
-      if (StrFunc::section(SLine,energy))
+      const char* LStart(pos);
+      const char* LEnd=mappedFile::lineEnd(pos,endPtr);
+      pos=mappedFile::nextLine(LEnd,endPtr);
+      if (mappedFile::hasText(LStart,LEnd,"total",5))
+	break;
+
+      const char* P(LStart);
+      if (readNumber(P,LEnd,energy))
 	{
-	  for(index=0;index<cnt;index++)
+	  for(size_t index=0;index<cnt;index++)
 	    {
-	      if (!StrFunc::section(SLine,flux))
+	      if (!readNumber(P,LEnd,flux) ||
+		  !readNumber(P,LEnd,fluxErr))
 		throw ColErr::FileError(static_cast<int>(index),
-					"Error with data in tally",SLine);
-	      FluxWork[index].pushData(energy,flux);
+					"Error with data in tally",
+					std::string(LStart,LEnd));
+	      // MCNP error is relative
+	      FluxWork[index].pushData
+		(energy,DError::doubleErr(flux,fluxErr*std::abs(flux)));
 	    }
 	}
-      SLine=StrFunc::getLine(IX);	    
     }
   
   cinderRebin(FluxWork);
@@ -308,29 +409,84 @@ tallyProcess::readWorkEnergy(std::istream& IX,const long int npsFile,
 void
 tallyProcess::readMCNP(const std::string& FName)
   /*!
-    Read the mcnp file
+    Read the mcnp file. The file is memory mapped and
+    only the lines of the tallies are read.
     \param FName :: file to open
   */
 {
   ELog::RegMethod RegA("tallyProcess","readMCNP");
 
-  std::ifstream IX;
-  if (!FName.empty())
-    IX.open(FName.c_str());
-  if (!IX.good())
-    throw ColErr::FileError(0,FName,"MCNP File not opened");
+  const mappedFile MF(FName);
+  const char* pos=MF.begin();
+  const char* endPtr=MF.end();
 
   int tallyN(0);
   long int npsFile(0);
-  
-  while(find1Tally(IX,tallyN,npsFile))
-    getFluxTally(IX,npsFile);
+  while(find1Tally(pos,endPtr,tallyN,npsFile))
+    getFluxTally(pos,endPtr,npsFile);
   
   if (!tallyN)
       throw ColErr::FileError(1,FName,"MCNP 1Tally not found");
   return;
 }
 
+void
+tallyProcess::mergeCells(const int cellN,const std::vector<int>& Cells,
+			 const std::vector<double>& Vols)
+  /*!
+    Replace the fluxes of a set of cells by their volume
+    weighted mean held under one cell [the others are removed].
+    The cell errors are taken as independent.
+    \param cellN :: Cell to hold the mean
+    \param Cells :: Cells to average
+    \param Vols :: Volumes of the cells
+   */
+{
+  ELog::RegMethod RegA("tallyProcess","mergeCells");
+
+  if (Cells.empty() || Cells.size()!=Vols.size())
+    throw ColErr::MisMatch<size_t>(Cells.size(),Vols.size(),"Cells/Vols");
+
+  WorkData Out(getWorkData(Cells.front()));
+  std::vector<DError::doubleErr> Sum(Out.getSize());
+  double VSum(0.0);
+  for(size_t i=0;i<Cells.size();i++)
+    {
+      const std::vector<DError::doubleErr>& Y=
+	getWorkData(Cells[i]).getYdata();
+      if (Y.size()!=Sum.size())
+	throw ColErr::MisMatch<size_t>(Y.size(),Sum.size(),
+				       "Flux groups of cell "+
+				       StrFunc::makeString(Cells[i]));
+      for(size_t j=0;j<Y.size();j++)
+	Sum[j]+=Y[j]*Vols[i];
+      VSum+=Vols[i];
+    }
+  if (VSum<=0.0)
+    throw ColErr::RangeError<double>(VSum,0.0,DBL_MAX,"Group volume");
+
+  for(size_t j=0;j<Sum.size();j++)
+    Out.setData(j,Sum[j].getVal()/VSum,Sum[j].getErr()/VSum);
+  for(const int CN : Cells)
+    cellFlux.erase(CN);
+  cellFlux[cellN]=Out;
+  return;
+}
+
+double
+tallyProcess::integralFlux(const int cellN) const
+  /*!
+    Integrated flux of a cell [0-25MeV]
+    \param cellN :: cell number
+    \return integrated flux
+  */
+{
+  ELog::RegMethod RegA("tallyProcess","integralFlux");
+
+  const WorkData& WD=getWorkData(cellN);
+  return WD.integrate(0,25.0).getVal();
+}
+
 bool
 tallyProcess::isValid(const int cellN,
 		      const double Tol) const
@@ -342,9 +498,7 @@ tallyProcess::isValid(const int cellN,
 {
   ELog::RegMethod RegA("tallyProcess","isValid");
 
-  const WorkData& WD=getWorkData(cellN);
-  DError::doubleErr IVal=WD.integrate(0,25.0);
-  return (IVal.getVal()<Tol) ? 0 : 1;
+  return (integralFlux(cellN)<Tol) ? 0 : 1;
 }
 
 void
@@ -358,18 +512,44 @@ tallyProcess::writeFluxes(const std::string& FName,
 {
   ELog::RegMethod RegA("tallyProcess","writeFluxes");
 
+  if (FName.empty())
+    {
+      getWorkData(cellN);     // still check the cell exists
+      return;
+    }
+  std::ofstream OX(FName.c_str());
+  writeFluxes(OX,cellN);
+  OX.close();
+  return;
+}
+
+void
+tallyProcess::writeFluxes(std::ostream& OX,const int cellN) const
+  /*!
+    Write out the  fluxes in cinder format
+    \param OX :: Output stream
+    \param cellN :: cell number
+  */
+{
+  ELog::RegMethod RegA("tallyProcess","writeFluxes(ostream)");
+
+  writeFluxes(OX,getWorkData(cellN));
+  return;
+}
+
+void
+tallyProcess::writeFluxes(std::ostream& OX,const WorkData& WD)
+  /*!
+    Write out a flux in cinder format
+    \param OX :: Output stream
+    \param WD :: Rebinned flux
+  */
+{
   boost::format ALineFMT("  Beamline%|74t|%d 0");
   boost::format BLineFMT
     ("tally  4     Integral of Rebinned flux is         %10.4e");
   boost::format CLineFMT(" %9.3e");
 
-
-  const WorkData& WD=getWorkData(cellN);
-  
-
-  if (FName.empty()) return;
-  std::ofstream OX(FName.c_str());
-
   OX<<(ALineFMT % WD.getSize())<<std::endl;;
   OX<<(BLineFMT % WD.integrate(0,1000.0).getVal());
 
@@ -381,7 +561,6 @@ tallyProcess::writeFluxes(const std::string& FName,
       OX<<(CLineFMT % FD[i].getVal());
     }
   OX<<std::endl;
-  OX.close();
   return;
 }
 
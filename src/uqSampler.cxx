@@ -0,0 +1,270 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   src/uqSampler.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "cellProduction.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "cellJob.h"
+#include "cellRunner.h"
+#include "MersenneTwister.h"
+#include "sampleStats.h"
+#include "Control.h"
+#include "uqSampler.h"
+
+uqSampler::uqSampler(const Control& C) :
+  Ctrl(C)
+  /*!
+    Constructor
+    \param C :: Control [problem and run options]
+  */
+{}
+
+uqSampler::~uqSampler()
+  /*!
+    Destructor
+  */
+{}
+
+void
+uqSampler::writeSampleInput(const cellJob& BJ,const cellJob& CJ,
+			    const size_t sample) const
+  /*!
+    Write the deck of a UQ sample of a cell : the fluxes and
+    spallation products are sampled from their errors
+    [uncorrelated normal]. The stream of each sample is seeded
+    from (seed,cell,sample) so it does not depend on the order
+    the samples are written. The other inputs are links to
+    those of the cell.
+    \param BJ :: Job of the cell
+    \param CJ :: Job of the sample
+    \param sample :: Sample number
+  */
+{
+  ELog::RegMethod RegA("uqSampler","writeSampleInput");
+
+  namespace BF=boost::filesystem;
+
+  MTRand::uint32 Key[3]={static_cast<MTRand::uint32>(Ctrl.uqSeed),
+			 static_cast<MTRand::uint32>(CJ.cellN),
+			 static_cast<MTRand::uint32>(sample)};
+  MTRand RNG(Key,3);
+
+  WorkData WD(Ctrl.fluxes.getWorkData(CJ.cellN));
+  const std::vector<DError::doubleErr> FD=WD.getYdata();
+  for(size_t i=0;i<FD.size();i++)
+    {
+      const double V=FD[i].getVal()+FD[i].getErr()*RNG.randNorm(0.0,1.0);
+      WD.setData(i,std::max(V,0.0),FD[i].getErr());
+    }
+  cellProduction CP(Ctrl.HT.getCellProd(CJ.cellN));
+  CP.sample(RNG);
+
+  const BF::path BDir(CJ.dirName);
+  BF::create_directories(BDir);
+  std::ofstream FX((BDir / "fluxes").string().c_str());
+  tallyProcess::writeFluxes(FX,WD);
+  FX.close();
+  std::ofstream SX((BDir / "splprods").string().c_str());
+  htapeProcess::writeSprods(SX,CJ.cellN,CJ.volume,CP);
+  SX.close();
+
+  const BF::path SDir=BF::absolute(BJ.dirName);
+  for(const std::string FName : {"input","locate","material"})
+    {
+      BF::remove(BDir / FName);
+      BF::create_symlink(SDir / FName,BDir / FName);
+    }
+  return;
+}
+
+size_t
+uqSampler::run(const cellRunner& Base) const
+  /*!
+    Uncertainty sampling : uqSamples perturbed decks of each
+    good cell run are run on the workers. As each sample is
+    collected its uqFiles are added to the statistics of the
+    cell and its directory is removed. When all the samples
+    of a cell are in, [file].mean/std/p05/p50/p95 are written
+    to the cell directory. Copied cells take those of the
+    cell they copy, with the values in the time columns of
+    the tables scaled as copyResults scales the tables.
+    The cells of every group [named history] are sampled.
+    \param Base :: Runner of the base run
+    \return number of failed sample runs
+  */
+{
+  ELog::RegMethod RegA("uqSampler","run");
+
+  namespace BF=boost::filesystem;
+
+  if (!Ctrl.uqSamples) return 0;
+
+  /// Statistics of a cell
+  struct UQStat
+  {
+    size_t next;                          ///< Next sample to add
+    std::map<size_t,const cellJob*> Done;  ///< Collected, not added
+    std::vector<sampleStats> Stats;       ///< Statistics of each file
+  };
+  typedef std::pair<std::string,int> GCell;   // (group,cell)
+  std::map<GCell,UQStat> Acc;
+  std::map<std::string,std::pair<size_t,const cellJob*>> Sample;
+
+  cellRunner CR(Ctrl.nWorkers);
+  Ctrl.setRunner(CR);
+  CR.setWriter([this,&Sample](const cellJob& CJ)
+	       {
+		 const std::pair<size_t,const cellJob*>& SV=
+		   Sample.find(CJ.dirName)->second;
+		 writeSampleInput(*SV.second,CJ,SV.first);
+	       });
+  // samples are added in sample order [P^2 depends on the order :
+  // jobs are not added to CR once it runs, so &CJ is stable]
+  // so the statistics do not depend on the number of workers
+  CR.setCollector([this,&Sample,&Acc](const cellJob& CJ)
+    {
+      const std::pair<size_t,const cellJob*>& SV=
+	Sample.find(CJ.dirName)->second;
+      const cellJob& BJ(*SV.second);
+      UQStat& A=Acc[GCell(CJ.group,CJ.cellN)];
+      A.Stats.resize(Ctrl.uqFiles.size());
+      A.Done.emplace(SV.first,&CJ);
+      while(!A.Done.empty() && A.Done.begin()->first==A.next)
+	{
+	  const cellJob& SJ(*A.Done.begin()->second);
+	  if (!SJ.status)
+	    {
+	      for(size_t i=0;i<Ctrl.uqFiles.size();i++)
+		if (!A.Stats[i].addFile
+		    ((BF::path(SJ.dirName) / Ctrl.uqFiles[i]).string()))
+		  ELog::EM<<"UQ sample "<<SJ.dirName<<" : "<<Ctrl.uqFiles[i]
+			  <<" missing or different layout"<<ELog::endWarn;
+	      boost::system::error_code errCode;
+	      BF::remove_all(SJ.dirName,errCode);
+	    }
+	  A.Done.erase(A.Done.begin());
+	  A.next++;
+	}
+      if (A.next==Ctrl.uqSamples)
+	{
+	  std::ofstream OX((BF::path(BJ.dirName) / "uq.summary").
+			   string().c_str());
+	  OX<<"seed "<<Ctrl.uqSeed<<" samples "<<Ctrl.uqSamples<<std::endl;
+	  for(size_t i=0;i<Ctrl.uqFiles.size();i++)
+	    {
+	      A.Stats[i].write
+		((BF::path(BJ.dirName) / Ctrl.uqFiles[i]).string());
+	      OX<<Ctrl.uqFiles[i]<<" "<<A.Stats[i].getCount()<<std::endl;
+	    }
+	  Acc.erase(GCell(CJ.group,CJ.cellN));
+	}
+    });
+
+  // cell major : only a few cells have statistics open
+  for(const cellJob& BJ : Base.getJobs())
+    if (!BJ.status && !BJ.sourceCell)
+      for(size_t s=0;s<Ctrl.uqSamples;s++)
+	{
+	  cellJob CJ(BJ.cellN,
+		     (BF::path(BJ.dirName) /
+		      ("uq"+StrFunc::makeString(s))).string(),
+		     BJ.volume,BJ.logIndex);
+	  CJ.group=BJ.group;
+	  Sample.emplace(CJ.dirName,std::pair<size_t,const cellJob*>(s,&BJ));
+	  CR.addJob(CJ);
+	}
+  ELog::EM<<"UQ : "<<CR.getJobs().size()<<" sample runs on "
+	  <<CR.getWorkers()<<" workers"<<ELog::endDiag;
+  CR.waitAll();
+
+  // copies take the statistics of their source [scaled as the tables]
+  std::map<GCell,const cellJob*> BaseJob;
+  for(const cellJob& BJ : Base.getJobs())
+    BaseJob.emplace(GCell(BJ.group,BJ.cellN),&BJ);
+  for(const cellJob& BJ : Base.getJobs())
+    if (!BJ.status && BJ.sourceCell)
+      {
+	const cellJob& SJ
+	  (*BaseJob.find(GCell(BJ.group,BJ.sourceCell))->second);
+	const BF::path SDir(SJ.dirName);
+	const BF::path BDir(BJ.dirName);
+	const double F=cellRunner::tableScale(SJ,BJ);
+	boost::system::error_code errCode;
+	for(const std::string& FName : Ctrl.uqFiles)
+	  for(const std::string Ext : {".mean",".std",".p05",".p50",".p95"})
+	    {
+	      if (!BF::exists(SDir / (FName+Ext)))
+		continue;
+	      if (F==1.0 || !cellRunner::isTable(FName))
+		BF::copy_file(SDir / (FName+Ext),BDir / (FName+Ext),
+			      BF::copy_option::overwrite_if_exists,errCode);
+	      else
+		{
+		  try
+		    {
+		      cellRunner::scaleStats(SDir / FName,SDir / (FName+Ext),
+					     BDir / (FName+Ext),F);
+		    }
+		  catch (BF::filesystem_error& EX)
+		    {
+		      ELog::EM<<"UQ : failed to scale statistics of cell "
+			      <<SJ.cellN<<" : "<<EX.what()<<ELog::endWarn;
+		    }
+		}
+	    }
+	BF::copy_file(SDir / "uq.summary",BDir / "uq.summary",
+		      BF::copy_option::overwrite_if_exists,errCode);
+      }
+
+  if (CR.nFailed())
+    ELog::EM<<"UQ : "<<CR.nFailed()<<" failed sample runs [kept]"
+	    <<ELog::endWarn;
+  return CR.nFailed();
+}
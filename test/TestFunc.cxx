@@ -0,0 +1,83 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/TestFunc.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <string>
+
+#include "TestFunc.h"
+
+TestFunc::TestFunc()
+  /*!
+    Constructor
+  */
+{}
+
+TestFunc::~TestFunc()
+  /*!
+    Destructor
+  */
+{}
+
+TestFunc&
+TestFunc::Instance()
+  /*!
+    Effective this object
+    \return TestFunc object
+  */
+{
+  static TestFunc A;
+  return A;
+}
+
+void
+TestFunc::regSector(const std::string& SName)
+  /*!
+    Register the test class being run
+    \param SName :: Name of test class
+  */
+{
+  TestFunc& TF=Instance();
+  TF.sectorName=SName;
+  TF.testName.clear();
+  return;
+}
+
+void
+TestFunc::regTest(const std::string& TName)
+  /*!
+    Register the test being run
+    \param TName :: Name of test
+  */
+{
+  Instance().testName=TName;
+  return;
+}
+
+std::string
+TestFunc::getName()
+  /*!
+    Name of the current test
+    \return sector::test
+  */
+{
+  const TestFunc& TF=Instance();
+  return TF.sectorName+"::"+TF.testName;
+}
@@ -0,0 +1,260 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testCellDedup.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <functional>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "Control.h"
+#include "cellDedup.h"
+#include "runProgs.h"
+#include "cellJob.h"
+#include "cellRunner.h"
+
+#include "TestFunc.h"
+#include "testProblem.h"
+#include "testCellDedup.h"
+
+testCellDedup::testCellDedup()
+  /*!
+    Constructor
+  */
+{}
+
+testCellDedup::~testCellDedup()
+  /*!
+    Destructor
+  */
+{}
+
+int
+testCellDedup::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testCellDedup","applyTest");
+  TestFunc::regSector("testCellDedup");
+
+  typedef int (testCellDedup::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testCellDedup::testExact,
+      &testCellDedup::testCopy,
+      &testCellDedup::testCluster
+    };
+  const std::string TestName[]=
+    {
+      "Exact",
+      "Copy",
+      "Cluster"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+int
+testCellDedup::testExact()
+  /*!
+    Test that only cells with the same flux, production
+    and volume are found to have the same problem
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellDedup","testExact");
+
+  const std::vector<int> Cells({1,2,3,4,5});
+  const std::map<int,int> Expect({{2,1},{5,1}});
+  for(const int dedupFlag : {1,0})
+    {
+      testProblem TP("dedup");
+      TP.addCell(1,1.0,1.0,0,1.0);
+      TP.addCell(2,1.0,1.0,0,1.0);
+      TP.addCell(3,2.0,1.0,0,1.0);     // volume
+      TP.addCell(4,1.0,2.0,0,1.0);     // flux
+      TP.addCell(5,1.0,1.0,0,1.0);
+      TP.addCell(6,1.0,1.0,0,3.0);     // production
+      if (!dedupFlag)
+	TP.addOptions("run_options\ndedup 0\n");
+      Control Ctrl;
+      TP.readControl(Ctrl);
+
+      std::vector<int> All(Cells);
+      All.push_back(6);
+      const std::map<int,int> Source=cellDedup(Ctrl).dedupCells(All);
+      if ((dedupFlag && Source!=Expect) || (!dedupFlag && !Source.empty()))
+	{
+	  ELog::EM<<"Dedup "<<dedupFlag<<" : copies == "
+		  <<Source.size()<<ELog::endDiag;
+	  for(const std::map<int,int>::value_type& SV : Source)
+	    ELog::EM<<"  "<<SV.first<<" from "<<SV.second<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testCellDedup::testCopy()
+  /*!
+    Test that a run gives the copies the results of
+    their source cell and records the map of copies
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellDedup","testCopy");
+
+  testProblem TP("dedup");
+  TP.addCell(1,1.0,1.0,0,1.0);
+  TP.addCell(2,1.0,1.0,0,1.0);
+  TP.addCell(3,1.0,2.0,0,1.0);
+  TP.addOptions("run_options\nworkers 2\n");
+  Control Ctrl;
+  TP.readControl(Ctrl);
+  if (Ctrl.writeCinderInput())
+    {
+      ELog::EM<<"Run failed"<<ELog::endDiag;
+      return -1;
+    }
+
+  for(const std::string FName : {"outp","tabs","tab1"})
+    {
+      const std::string A=testProblem::readFile("Cell1/"+FName);
+      // outp is the input : the flux is not in it
+      if (A.empty() || A!=testProblem::readFile("Cell2/"+FName) ||
+	  (FName!="outp" && A==testProblem::readFile("Cell3/"+FName)))
+	{
+	  ELog::EM<<"Copy of "<<FName<<" differs"<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  const std::string Log=testProblem::readFile("Cell2/cinderTXT2.log");
+  const std::string Map=testProblem::readFile("activation.dedup");
+  if (Log!="Results copied from cell 1 [same problem]\n" ||
+      Map.find("\n2 1 1 1 0\n")==std::string::npos ||
+      testProblem::readFile("Cell3/cinderTXT3.log")!="cinder run\n")
+    {
+      ELog::EM<<"Log == "<<Log<<ELog::endDiag;
+      ELog::EM<<"Map == "<<Map<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testCellDedup::testCluster()
+  /*!
+    Test that a clustered cell of another volume takes the
+    tables of its source scaled by the flux ratio and the
+    volume ratio in the time columns only
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellDedup","testCluster");
+
+  testProblem TP("dedup");
+  TP.addCell(1,1.0,1.0,0,1.0);     // from cell 2 [higher flux]
+  TP.addCell(2,2.0,1.5,0,1.5);     // same spectrum : 1.5 x 1
+  TP.addOptions("run_options\ncluster_tol 0.01\n");
+  Control Ctrl;
+  TP.readControl(Ctrl);
+  if (Ctrl.writeCinderInput())
+    {
+      ELog::EM<<"Run failed"<<ELog::endDiag;
+      return -1;
+    }
+
+  const std::string Log=testProblem::readFile("Cell1/cinderTXT1.log");
+  const std::string Scale=testProblem::readFile("Cell1/scale");
+  if (Log!="Results copied from cell 2 [scaled : see scale]\n" ||
+      Scale.find("\ntable_scale 0.333333\n")==std::string::npos)
+    {
+      ELog::EM<<"Log == "<<Log<<ELog::endDiag;
+      ELog::EM<<"Scale == "<<Scale<<ELog::endDiag;
+      return -1;
+    }
+  // stand-in TABCODE : a direct run of cell 1 is 1/3 of cell 2
+  const double D=cellRunner::tableDeviation("Cell2","Cell1",1.0/3.0);
+  if (D<0.0 || D>1e-3)
+    {
+      ELog::EM<<"Deviation from direct run == "<<D<<ELog::endDiag;
+      return -1;
+    }
+  for(const std::string FName : {"tabs","tab1"})
+    {
+      const std::string Table=testProblem::readFile("Cell1/"+FName);
+      if (Table.find("  27060  5.271E+00 ")==std::string::npos ||
+	  Table.find("  0.0000E+00   1.0000E+03\n")==
+	  std::string::npos)
+	{
+	  ELog::EM<<"Table "<<FName<<" ::\n"<<Table<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
@@ -0,0 +1,535 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testCellRunner.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <functional>
+#include <chrono>
+#include <sys/types.h>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "runProgs.h"
+#include "cellJob.h"
+#include "resultCache.h"
+#include "cellRunner.h"
+#include "TestFunc.h"
+#include "testCellRunner.h"
+
+testCellRunner::testCellRunner() :
+  testDir((boost::filesystem::temp_directory_path() /
+	   boost::filesystem::unique_path("runner-%%%%-%%%%")).string()),
+  cinderEXE(runProgs::Instance().getCinderEXE()),
+  tabcodeEXE(runProgs::Instance().getTabcodeEXE())
+  /*!
+    Constructor : make the scratch directory and the
+    stand-in programs
+  */
+{
+  namespace BF=boost::filesystem;
+
+  BF::create_directories(testDir);
+  const BF::path CName=BF::path(testDir) / "cinder.sh";
+  const BF::path TName=BF::path(testDir) / "tabcode.sh";
+  writeFile(CName,
+	    "#!/bin/sh\n"
+	    "case `cat input` in\n"
+	    "  fail) exit 3 ;;\n"
+	    "  slow) sleep 30 ;;\n"
+	    "esac\n"
+	    "cp input outp\n"
+	    "echo work > fort.7\n"
+	    "echo cinder run\n");
+  writeFile(TName,
+	    "#!/bin/sh\n"
+	    "echo ' 1.000E+00' > tabs\n"
+	    "echo ' 2.000E+00' > tab1\n"
+	    "echo tabcode run\n");
+  BF::permissions(CName,BF::owner_all);
+  BF::permissions(TName,BF::owner_all);
+
+  runProgs& RP=runProgs::Instance();
+  RP.setCinderEXE(CName.string());
+  RP.setTabcodeEXE(TName.string());
+}
+
+testCellRunner::~testCellRunner()
+  /*!
+    Destructor : put back the programs and remove
+    the scratch directory
+  */
+{
+  runProgs& RP=runProgs::Instance();
+  RP.setCinderEXE(cinderEXE);
+  RP.setTabcodeEXE(tabcodeEXE);
+  boost::system::error_code EC;
+  boost::filesystem::remove_all(testDir,EC);
+}
+
+int
+testCellRunner::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","applyTest");
+  TestFunc::regSector("testCellRunner");
+
+  typedef int (testCellRunner::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testCellRunner::testRun,
+      &testCellRunner::testFailure,
+      &testCellRunner::testTimeLimit,
+      &testCellRunner::testScratch,
+      &testCellRunner::testScaleLine,
+      &testCellRunner::testTableDeviation,
+      &testCellRunner::testScaleStats
+    };
+  const std::string TestName[]=
+    {
+      "Run",
+      "Failure",
+      "TimeLimit",
+      "Scratch",
+      "ScaleLine",
+      "TableDeviation",
+      "ScaleStats"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+void
+testCellRunner::writeFile(const boost::filesystem::path& FName,
+			  const std::string& Text)
+  /*!
+    Write a file
+    \param FName :: File
+    \param Text :: Contents
+  */
+{
+  std::ofstream OX(FName.string().c_str());
+  OX<<Text;
+  return;
+}
+
+std::string
+testCellRunner::readFile(const boost::filesystem::path& FName)
+  /*!
+    Read a file
+    \param FName :: File
+    \return contents [empty if missing]
+  */
+{
+  std::ifstream IX(FName.string().c_str());
+  std::ostringstream cx;
+  cx<<IX.rdbuf();
+  return cx.str();
+}
+
+std::string
+testCellRunner::cellDir(const int cellN) const
+  /*!
+    Directory of a cell
+    \param cellN :: Cell number
+    \return directory name
+  */
+{
+  return (boost::filesystem::path(testDir) /
+	  ("Cell"+StrFunc::makeString(cellN))).string();
+}
+
+void
+testCellRunner::writeDeck(const cellJob& CJ,const std::string& Text)
+  /*!
+    Write the input deck of a job [in place of Control]
+    \param CJ :: Job
+    \param Text :: Contents of the input file
+  */
+{
+  boost::filesystem::create_directories(CJ.dirName);
+  for(const std::string& IName : resultCache::inputFiles())
+    writeFile(boost::filesystem::path(CJ.dirName) / IName,
+	      (IName=="input") ? Text : IName+"\n");
+  return;
+}
+
+void
+testCellRunner::addJobs(cellRunner& CR,const std::vector<int>& Cells) const
+  /*!
+    Queue the jobs of cells : cell 13 fails in CINDER
+    and cell 17 runs until it is killed
+    \param CR :: Runner
+    \param Cells :: Cell numbers
+  */
+{
+  CR.setWriter([](const cellJob& CJ)
+	       {
+		 writeDeck(CJ,(CJ.cellN==13) ? "fail\n" :
+			   (CJ.cellN==17) ? "slow\n" :
+			   "cell "+StrFunc::makeString(CJ.cellN)+"\n");
+	       });
+  size_t index(1);
+  for(const int CN : Cells)
+    CR.addJob(cellJob(CN,cellDir(CN),1.0,index++));
+  return;
+}
+
+int
+testCellRunner::testRun()
+  /*!
+    Test that the cells run in their own directories
+    [the cwd is not changed] and keep the log naming
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","testRun");
+
+  namespace BF=boost::filesystem;
+
+  const BF::path CWD=BF::current_path();
+  cellRunner CR(2);
+  addJobs(CR,{1,2,3,4});
+  CR.waitAll();
+
+  if (CR.nFailed() || CR.getJobs().size()!=4 || BF::current_path()!=CWD)
+    {
+      ELog::EM<<"Failed jobs == "<<CR.nFailed()<<ELog::endDiag;
+      return -1;
+    }
+  for(const cellJob& CJ : CR.getJobs())
+    {
+      const BF::path DName(CJ.dirName);
+      if (CJ.status || CJ.nTry!=1 || CJ.cinderExit || CJ.tabcodeExit ||
+	  readFile(DName / "outp")!=
+	  "cell "+StrFunc::makeString(CJ.cellN)+"\n" ||
+	  readFile(DName / "tabs")!=" 1.000E+00\n" ||
+	  readFile(DName / "tab1")!=" 2.000E+00\n" ||
+	  readFile(DName / CJ.cinderLog())!="cinder run\n" ||
+	  readFile(DName / CJ.tabcodeLog())!="tabcode run\n")
+	{
+	  ELog::EM<<"Cell "<<CJ.cellN<<" : "<<CJ.statusString()
+		  <<" in "<<CJ.dirName<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testCellRunner::testFailure()
+  /*!
+    Test that a failed CINDER run is re-run and reported
+    without affecting the other cells
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","testFailure");
+
+  cellRunner CR(2);
+  CR.setRetry(1,0.0);
+  addJobs(CR,{5,13});
+  CR.waitAll();
+
+  const cellJob& AJ(CR.getJobs()[0]);
+  const cellJob& BJ(CR.getJobs()[1]);
+  if (CR.nFailed()!=1 || AJ.status || AJ.nTry!=1 ||
+      !(BJ.status & 1) || BJ.cinderExit!=3 || BJ.nTry!=2 ||
+      boost::filesystem::exists(boost::filesystem::path(BJ.dirName) / "outp"))
+    {
+      ELog::EM<<"Cell 5 : "<<AJ.statusString()<<ELog::endDiag;
+      ELog::EM<<"Cell 13 : "<<BJ.statusString()<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testCellRunner::testTimeLimit()
+  /*!
+    Test that a run over the wall time limit is killed
+    and the next cell still runs
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","testTimeLimit");
+
+  typedef std::chrono::steady_clock clockTYPE;
+
+  const clockTYPE::time_point T0=clockTYPE::now();
+  cellRunner CR(1);
+  CR.setTimeLimit(0.5);
+  addJobs(CR,{17,6});
+  CR.waitAll();
+  const double T=std::chrono::duration<double>(clockTYPE::now()-T0).count();
+
+  const cellJob& AJ(CR.getJobs()[0]);
+  const cellJob& BJ(CR.getJobs()[1]);
+  if (!(AJ.status & 32) || BJ.status || T>10.0)
+    {
+      ELog::EM<<"Cell 17 : "<<AJ.statusString()<<ELog::endDiag;
+      ELog::EM<<"Cell 6 : "<<BJ.statusString()<<ELog::endDiag;
+      ELog::EM<<"Time == "<<T<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testCellRunner::testScratch()
+  /*!
+    Test that a run on scratch copies back only the
+    result files and the logs
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","testScratch");
+
+  namespace BF=boost::filesystem;
+
+  cellRunner CR(2);
+  CR.setScratch((BF::path(testDir) / "node").string(),0);
+  addJobs(CR,{21,22});
+  CR.waitAll();
+
+  if (CR.nFailed())
+    {
+      ELog::EM<<"Failed jobs == "<<CR.nFailed()<<ELog::endDiag;
+      return -1;
+    }
+  for(const cellJob& CJ : CR.getJobs())
+    {
+      const BF::path DName(CJ.dirName);
+      if (readFile(DName / "outp")!=
+	  "cell "+StrFunc::makeString(CJ.cellN)+"\n" ||
+	  readFile(DName / "tab1")!=" 2.000E+00\n" ||
+	  readFile(DName / CJ.cinderLog())!="cinder run\n" ||
+	  readFile(DName / CJ.tabcodeLog())!="tabcode run\n" ||
+	  BF::exists(DName / "fort.7"))
+	{
+	  ELog::EM<<"Cell "<<CJ.cellN<<" : "<<CJ.statusString()
+		  <<" in "<<CJ.dirName<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testCellRunner::testScaleLine()
+  /*!
+    Test that only the values in the time columns of a
+    table are scaled : ids, half-lives, lines before the
+    time header and lines of other columns are kept
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","testScaleLine");
+
+  namespace BF=boost::filesystem;
+
+  const std::string Table=
+    " nuclide table  mass 1.000E+00\n"
+    " time (s)            0.0000E+00   1.0000E+03\n"
+    "  27060  5.271E+00   2.4680E-02   1.2340E-02\n"
+    "   1003  1.232e+01   2.4680e-03        4e-03\n"
+    " total               2.7148E-02   1.4808E-02\n"
+    " half-life 5.271E+00 1.00E+00\n"
+    " Time (d)   1.0E+00\n"
+    "  27060     2.0E-01   3.0E-01\n";
+  const std::string Expect=
+    " nuclide table  mass 1.000E+00\n"
+    " time (s)            0.0000E+00   1.0000E+03\n"
+    "  27060  5.271E+00   4.9360E-02   2.4680E-02\n"
+    "   1003  1.232e+01   4.9360e-03        8e-03\n"
+    " total               5.4296E-02   2.9616E-02\n"
+    " half-life 5.271E+00 1.00E+00\n"
+    " Time (d)   1.0E+00\n"
+    "  27060     4.0E-01   3.0E-01\n";
+
+  const BF::path AName=BF::path(testDir) / "tab1";
+  const BF::path BName=BF::path(testDir) / "tab1.scaled";
+  writeFile(AName,Table);
+  cellRunner::scaleTable(AName,BName,2.0);
+  const std::string Out=readFile(BName);
+  if (Out!=Expect)
+    {
+      ELog::EM<<"Scaled table ::\n"<<Out<<ELog::endDiag;
+      ELog::EM<<"Expected ::\n"<<Expect<<ELog::endDiag;
+      return -1;
+    }
+
+  // values without a time header cannot be scaled
+  writeFile(AName," 27060  5.271E+00   2.4680E-02\n");
+  try
+    {
+      cellRunner::scaleTable(AName,BName,2.0);
+      ELog::EM<<"Scaled a table without time columns"<<ELog::endDiag;
+      return -1;
+    }
+  catch (BF::filesystem_error&)
+    { }
+  // no values : copied
+  writeFile(AName," nuclide  id\n  27060  co60\n");
+  cellRunner::scaleTable(AName,BName,2.0);
+  if (readFile(BName)!=" nuclide  id\n  27060  co60\n")
+    {
+      ELog::EM<<"Table without values == "<<readFile(BName)<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testCellRunner::testTableDeviation()
+  /*!
+    Test that the deviation compares the time columns
+    of the tables only and finds a layout change
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","testTableDeviation");
+
+  namespace BF=boost::filesystem;
+
+  const BF::path ADir=BF::path(testDir) / "devA";
+  const BF::path BDir=BF::path(testDir) / "devB";
+  BF::create_directories(ADir);
+  BF::create_directories(BDir);
+  writeFile(ADir / "tabs",
+	    " time (s)            0.0000E+00   1.0000E+03\n"
+	    "  27060  5.271E+00   1.0000E-02   4.0000E-03\n"
+	    "  26055  2.737E+00   1.0000E-10   2.0000E-03\n");
+  writeFile(BDir / "tabs",
+	    " time (s)            0.0000E+00   1.0000E+03\n"
+	    "  27060  9.999E+00   3.0000E-02   1.2600E-02\n"
+	    "  26055  2.737E+00   5.0000E-10   6.0000E-03\n");
+  writeFile(ADir / "outp","not a table 1.0E+00\n");
+  writeFile(BDir / "outp","not a table 7.0E+00\n");
+
+  // 1.26e-2 against 1.2e-2 : the 1e-10 values are rounding
+  const double D=cellRunner::tableDeviation(ADir.string(),BDir.string(),3.0);
+  if (std::abs(D-0.0476190)>1e-6)
+    {
+      ELog::EM<<"Deviation == "<<D<<ELog::endDiag;
+      return -1;
+    }
+
+  writeFile(BDir / "tabs",
+	    " time (s)            0.0000E+00   1.0000E+03\n"
+	    "  27060  9.999E+00   3.0000E-02   1.2600E-02\n");
+  if (cellRunner::tableDeviation(ADir.string(),BDir.string(),3.0)>=0.0)
+    {
+      ELog::EM<<"Layout change not found"<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testCellRunner::testScaleStats()
+  /*!
+    Test that the statistics of a table are scaled in the
+    numbers that are time column values of the table : the
+    statistics are not in the layout of the table
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testCellRunner","testScaleStats");
+
+  namespace BF=boost::filesystem;
+
+  const BF::path TName=BF::path(testDir) / "tabs";
+  const BF::path SName=BF::path(testDir) / "tabs.mean";
+  const BF::path OName=BF::path(testDir) / "copy.mean";
+  writeFile(TName,
+	    " time (s)            0.0000E+00   1.0000E+03\n"
+	    "  27060  5.271E+00   2.4680E-02   1.2340E-02\n"
+	    " total               2.7148E-02   1.4808E-02\n");
+  writeFile(SName,
+	    " time (s)             0.00000e+00   1.00000e+03\n"
+	    "   2.70600e+04   5.27100e+00   2.46800e-02   1.23400e-02\n"
+	    " total   2.71480e-02   1.48080e-02\n");
+  cellRunner::scaleStats(TName,SName,OName,2.0);
+  const std::string Expect=
+    " time (s)             0.00000e+00   1.00000e+03\n"
+    "   2.70600e+04   5.27100e+00   4.93600e-02   2.46800e-02\n"
+    " total   5.42960e-02   2.96160e-02\n";
+  if (readFile(OName)!=Expect)
+    {
+      ELog::EM<<"Scaled ::\n"<<readFile(OName)<<ELog::endDiag;
+      ELog::EM<<"Expected ::\n"<<Expect<<ELog::endDiag;
+      return -1;
+    }
+
+  // statistics not of the table
+  writeFile(SName,
+	    " time (s)             0.00000e+00   1.00000e+03\n"
+	    "   2.70600e+04   5.27100e+00   2.46800e-02\n");
+  try
+    {
+      cellRunner::scaleStats(TName,SName,OName,2.0);
+      ELog::EM<<"Scaled statistics of another layout"<<ELog::endDiag;
+      return -1;
+    }
+  catch (BF::filesystem_error&)
+    { }
+  return 0;
+}
@@ -0,0 +1,345 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testHtapeScan.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <regex>
+#include <chrono>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "regexSupport.h"
+#include "htapeScan.h"
+#include "TestFunc.h"
+#include "testHtapeScan.h"
+
+testHtapeScan::testHtapeScan()
+  /*!
+    Constructor
+  */
+{}
+
+testHtapeScan::~testHtapeScan()
+  /*!
+    Destructor
+  */
+{}
+
+int
+testHtapeScan::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testHtapeScan","applyTest");
+  TestFunc::regSector("testHtapeScan");
+
+  typedef int (testHtapeScan::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testHtapeScan::testCaseLine,
+      &testHtapeScan::testCellLine,
+      &testHtapeScan::testTiming,
+      &testHtapeScan::testZaidLine
+    };
+  const std::string TestName[]=
+    {
+      "CaseLine",
+      "CellLine",
+      "Timing",
+      "ZaidLine"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+int
+testHtapeScan::testCaseLine()
+  /*!
+    Test htapeScan::caseLine against ^1\\s+case no.\\s+(\\d+)
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testHtapeScan","testCaseLine");
+
+  const std::regex caseSearch("^1\\s+case no.\\s+(\\d+)");
+  const std::vector<std::string> Tests=
+    {
+      "1   case no.    5",
+      "1\tcase no.\t7  cell 3",
+      "1 case no  3",
+      "1 case no 3",
+      "1case no. 5",
+      " 1 case no. 5",
+      "1  case no:   12abc",
+      "1  case no.   ",
+      "1  case no.",
+      "1  case no. -4",
+      "1  case no. 99999999999",
+      "1  case number 8",
+      ""
+    };
+
+  for(const std::string& Line : Tests)
+    {
+      int N(-1),M(-1);
+      const int flag=htapeScan::caseLine(Line,N);
+      const int reFlag=StrFunc::StrComp(Line,caseSearch,M,0);
+      if (flag!=reFlag || (flag && N!=M))
+	{
+	  ELog::EM<<"Line   == ["<<Line<<"]"<<ELog::endDiag;
+	  ELog::EM<<"Scan   == "<<flag<<" : "<<N<<ELog::endDiag;
+	  ELog::EM<<"Regex  == "<<reFlag<<" : "<<M<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testHtapeScan::testCellLine()
+  /*!
+    Test htapeScan::cellLine against for cell:\\s*(\\d+)
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testHtapeScan","testCellLine");
+
+  const std::regex cellSearch("for cell:\\s*(\\d+)");
+  const std::vector<std::string> Tests=
+    {
+      "   nuclide production for cell:   12",
+      "for cell:12",
+      "for cell:  abc for cell: 7",
+      "for cell:",
+      "for cell :  3",
+      "   for cell:\t 45 and more",
+      "   for cell:  99999999999",
+      "  residual nuclei",
+      ""
+    };
+
+  for(const std::string& Line : Tests)
+    {
+      int N(-1),M(-1);
+      const int flag=htapeScan::cellLine(Line,N);
+      const int reFlag=StrFunc::StrComp(Line,cellSearch,M,0);
+      if (flag!=reFlag || (flag && N!=M))
+	{
+	  ELog::EM<<"Line   == ["<<Line<<"]"<<ELog::endDiag;
+	  ELog::EM<<"Scan   == "<<flag<<" : "<<N<<ELog::endDiag;
+	  ELog::EM<<"Regex  == "<<reFlag<<" : "<<M<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testHtapeScan::testTiming()
+  /*!
+    Benchmark of the scanners against the regular expressions
+    they replaced, on a table of case/cell sections as in
+    an outt08 file. The regex pass builds the case/cell
+    expressions for each line and the row expressions for each
+    section as readHeader/readZaid did. Both passes must find
+    the same rows and the scanners must be the faster.
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testHtapeScan","testTiming");
+
+  typedef std::chrono::steady_clock CLOCK;
+
+  const size_t nCell(100);
+  const size_t nRow(50);
+  std::vector<std::string> Lines;
+  for(size_t i=0;i<nCell;i++)
+    {
+      std::ostringstream cx;
+      cx<<"1   case no.    "<<i+1;
+      Lines.push_back(cx.str());
+      cx.str("");
+      cx<<"   nuclide production for cell:   "<<i+1;
+      Lines.push_back(cx.str());
+      for(size_t j=0;j<nRow;j++)
+	{
+	  std::ostringstream zx;
+	  if (j % 10)
+	    zx<<"           n = "<<std::setw(3)<<j;
+	  else
+	    zx<<"   z = "<<std::setw(3)<<j/10+1<<" n = "<<std::setw(3)<<j;
+	  zx<<"  1.2345E-03  0.0123";
+	  Lines.push_back(zx.str());
+	}
+      Lines.push_back("  production complete");
+    }
+
+  const std::string caseSearch("^1\\s+case no.\\s+(\\d+)");
+  const std::string cellSearch("for cell:\\s*(\\d+)");
+  const std::string zaidSearch
+    ("z =\\s*(\\d+)\\s*n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)");
+  const std::string midSearch("n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)");
+
+  // regex pass
+  const CLOCK::time_point reStart=CLOCK::now();
+  size_t reCount(0);
+  long int reSum(0);
+  std::regex zaidRE,midRE;
+  for(const std::string& Line : Lines)
+    {
+      int N;
+      std::vector<std::string> Comp;
+      if (StrFunc::StrComp(Line,std::regex(caseSearch),N,0))
+	{
+	  zaidRE=std::regex(zaidSearch);
+	  midRE=std::regex(midSearch);
+	}
+      else if (StrFunc::StrComp(Line,std::regex(cellSearch),N,0))
+	reSum+=N;
+      else if (StrFunc::StrSingleSplit(Line,zaidRE,Comp) ||
+	       StrFunc::StrSingleSplit(Line,midRE,Comp))
+	reCount++;
+    }
+  const std::chrono::duration<double> reTime=CLOCK::now()-reStart;
+
+  // scanner pass
+  const CLOCK::time_point scanStart=CLOCK::now();
+  size_t scanCount(0);
+  long int scanSum(0);
+  for(const std::string& Line : Lines)
+    {
+      int N,Z;
+      std::string Frac,Err;
+      if (htapeScan::caseLine(Line,N))
+	continue;
+      else if (htapeScan::cellLine(Line,N))
+	scanSum+=N;
+      else if (htapeScan::zaidLine(Line,Z,N,Frac,Err))
+	scanCount++;
+    }
+  const std::chrono::duration<double> scanTime=CLOCK::now()-scanStart;
+
+  ELog::EM<<"Lines "<<Lines.size()<<" : regex "<<reTime.count()
+	  <<" sec : scan "<<scanTime.count()<<" sec"<<ELog::endDiag;
+
+  if (reCount!=nCell*nRow || scanCount!=reCount || scanSum!=reSum ||
+      scanTime.count()>reTime.count())
+    {
+      ELog::EM<<"Rows  == "<<reCount<<" : "<<scanCount<<ELog::endDiag;
+      ELog::EM<<"Cells == "<<reSum<<" : "<<scanSum<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testHtapeScan::testZaidLine()
+  /*!
+    Test htapeScan::zaidLine against the z = / n = row
+    expressions [as htapeProcess::readZaid]
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testHtapeScan","testZaidLine");
+
+  const std::regex zaidSearch
+    ("z =\\s*(\\d+)\\s*n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)");
+  const std::regex midSearch("n =\\s*(\\d+)\\s+(\\S+)\\s+(\\S+)");
+  const std::vector<std::string> Tests=
+    {
+      "   z =  26 n =  30  1.2345E-03  0.0123",
+      "           n =  31  5.0000E-04  0.1000",
+      "  z =26n =30 1 2",
+      "  z = 26 n = 30 1.0",
+      "  z = x n = 5 1.0E-1 0.5",
+      "  z = 8 n = 8 1.0E-1",
+      "  n =12 3 4 5",
+      "  n = 5",
+      "  z = 3 n = 4  1.0-300 0.2 z = 5 n = 6 1 2",
+      "  n = 1 a n = 2 b c",
+      "  production complete",
+      ""
+    };
+
+  for(const std::string& Line : Tests)
+    {
+      int Z(-1),N(-1);
+      std::string Frac,Err;
+      const int flag=htapeScan::zaidLine(Line,Z,N,Frac,Err);
+
+      std::vector<std::string> Comp;
+      int reFlag(0);
+      if (StrFunc::StrSingleSplit(Line,zaidSearch,Comp))
+	reFlag=2;
+      else if (StrFunc::StrSingleSplit(Line,midSearch,Comp))
+	reFlag=1;
+
+      std::ostringstream scanOut,reOut;
+      if (flag==2)
+	scanOut<<Z<<" ";
+      if (flag)
+	scanOut<<N<<" "<<Frac<<" "<<Err;
+      for(size_t i=0;i<Comp.size();i++)
+	reOut<<((i) ? " " : "")<<Comp[i];
+
+      if (flag!=reFlag || scanOut.str()!=reOut.str())
+	{
+	  ELog::EM<<"Line   == ["<<Line<<"]"<<ELog::endDiag;
+	  ELog::EM<<"Scan   == "<<flag<<" : "<<scanOut.str()<<ELog::endDiag;
+	  ELog::EM<<"Regex  == "<<reFlag<<" : "<<reOut.str()<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
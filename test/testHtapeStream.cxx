@@ -0,0 +1,285 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testHtapeStream.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <regex>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "doubleErr.h"
+#include "cellProduction.h"
+#include "htapeSection.h"
+#include "htapeStream.h"
+#include "htapeProcess.h"
+#include "TestFunc.h"
+#include "testHtapeStream.h"
+
+testHtapeStream::testHtapeStream()
+  /*!
+    Constructor
+  */
+{}
+
+testHtapeStream::~testHtapeStream()
+  /*!
+    Destructor
+  */
+{}
+
+int
+testHtapeStream::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testHtapeStream","applyTest");
+  TestFunc::regSector("testHtapeStream");
+
+  typedef int (testHtapeStream::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testHtapeStream::testProduction,
+      &testHtapeStream::testGas
+    };
+  const std::string TestName[]=
+    {
+      "Production",
+      "Gas"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+std::string
+testHtapeStream::prodTable()
+  /*!
+    Make an outt08 style production table
+    \return table text
+  */
+{
+  std::ostringstream cx;
+  cx<<std::fixed<<std::setprecision(4);
+  cx<<" htape output file 8"<<std::endl;
+  cx<<"  case no. 0 is not a header"<<std::endl;
+  cx<<" statistical degrees of freedom for the run =   250000"<<std::endl;
+  for(int i=0;i<6;i++)
+    {
+      cx<<"1   case no.    "<<i+1<<"   nuclide production"<<std::endl;
+      cx<<"   residual nuclei for cell:   "<<10+i<<std::endl;
+      cx<<"      nucleus   production   rel. error   # title"<<std::endl;
+      for(int z=20+i;z<23+2*i;z++)
+	{
+	  cx<<"   z = "<<std::setw(3)<<z<<" n = "<<std::setw(3)<<z+4
+	    <<"  "<<1.0+z<<"E-0"<<(i % 3)+2<<"  0.0"<<z<<std::endl;
+	  cx<<"             n = "<<std::setw(3)<<z+5
+	    <<"  "<<2.5+i<<"-04  0.1"<<i<<std::endl;
+	  if (i==2)
+	    cx<<"             n = bad row"<<std::endl;
+	}
+      cx<<"   total production complete"<<std::endl;
+      cx<<std::endl;
+    }
+  // last table has no end line
+  cx<<"1   case no.    7"<<std::endl;
+  cx<<"   residual nuclei for cell:   90"<<std::endl;
+  cx<<"      nucleus   production   rel. error"<<std::endl;
+  cx<<"   z =   1 n =   1  4.0E-03  0.2";
+  return cx.str();
+}
+
+std::string
+testHtapeStream::gasTable()
+  /*!
+    Make an outt14 style gas table
+    \return table text
+  */
+{
+  std::ostringstream cx;
+  cx<<std::fixed<<std::setprecision(4);
+  cx<<" htape output file 14"<<std::endl;
+  for(int i=0;i<5;i++)
+    {
+      cx<<"1   case no.    "<<i+1<<std::endl;
+      cx<<"   gas production for cell:  "<<20+i<<std::endl;
+      cx<<std::endl;
+      cx<<"     hydrogen   deuterium   tritium    total h"<<std::endl;
+      cx<<"   "<<1.0+i<<"E-02 0.010  2.0000E-03 0.020  "
+	<<3.0+i<<"-04 0.030  1.0"<<std::endl;
+      if (i==3)
+	cx<<"   unexpected line"<<std::endl;
+      cx<<"     helium-3   helium-4   total he   gas(h&he)"<<std::endl;
+      cx<<"   4.0000E-05 0.040  "<<5.0+i<<"E-03 0.050"<<std::endl;
+    }
+  // last table is cut short
+  cx<<"1   case no.    6"<<std::endl;
+  cx<<"   gas production for cell:  30"<<std::endl;
+  cx<<"     hydrogen   deuterium   tritium    total h"<<std::endl;
+  cx<<"   1.0E-02 0.010  2.0E-03 0.020  3.0E-04 0.030  1.0"<<std::endl;
+  return cx.str();
+}
+
+std::string
+testHtapeStream::sectString(const size_t prodType,const htapeSection& HS)
+  /*!
+    Write a section for comparison
+    \param prodType :: Type of production [0-2]
+    \param HS :: Section
+    \return section as text
+  */
+{
+  std::ostringstream cx;
+  cx<<"cell "<<HS.getCell()<<" status "<<HS.getStatus()<<std::endl;
+  for(const std::string& BL : HS.getBadLines())
+    cx<<"bad ["<<BL<<"]"<<std::endl;
+
+  cellProduction CP;
+  HS.addProd(prodType,CP);
+  CP.write(cx);
+  return cx.str();
+}
+
+int
+testHtapeStream::compareTable(const std::string& Table,const bool prodFlag)
+  /*!
+    Read a table both ways and compare the sections
+    \param Table :: Table text
+    \param prodFlag :: Production table [else gas]
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testHtapeStream","compareTable");
+
+  const size_t prodType(prodFlag ? 0 : 1);
+
+  std::istringstream IX(Table);
+  long int npsFile(0);
+  std::vector<htapeSection> Sect=
+    htapeProcess::findSections(IX,prodFlag,npsFile);
+  for(htapeSection& HS : Sect)
+    {
+      if (prodFlag)
+	HS.readZaid(IX);
+      else
+	HS.readGas(IX);
+    }
+  // rows are written with a four space indent
+  if (Sect.size()<2 ||
+      sectString(prodType,Sect.front()).find("\n    ")==std::string::npos)
+    {
+      ELog::EM<<"Sections found == "<<Sect.size()<<ELog::endDiag;
+      return -1;
+    }
+
+  const std::vector<size_t> BlockSize({1,7,64,Table.size()});
+  for(const size_t BS : BlockSize)
+    {
+      htapeStream HStream(prodFlag);
+      for(size_t i=0;i<Table.size();i+=BS)
+	HStream.addData(Table.c_str()+i,std::min(BS,Table.size()-i));
+      HStream.finish();
+
+      const std::vector<htapeSection>& SSect=HStream.getSections();
+      if (HStream.getNPS()!=npsFile ||
+	  HStream.getNByte()!=Table.size() ||
+	  SSect.size()!=Sect.size())
+	{
+	  ELog::EM<<"Block size == "<<BS<<ELog::endDiag;
+	  ELog::EM<<"NPS      == "<<HStream.getNPS()<<" : "
+		  <<npsFile<<ELog::endDiag;
+	  ELog::EM<<"Bytes    == "<<HStream.getNByte()<<" : "
+		  <<Table.size()<<ELog::endDiag;
+	  ELog::EM<<"Sections == "<<SSect.size()<<" : "
+		  <<Sect.size()<<ELog::endDiag;
+	  return -1;
+	}
+      for(size_t i=0;i<Sect.size();i++)
+	{
+	  const std::string A=sectString(prodType,SSect[i]);
+	  const std::string B=sectString(prodType,Sect[i]);
+	  if (A!=B)
+	    {
+	      ELog::EM<<"Block size == "<<BS<<" section "<<i<<ELog::endDiag;
+	      ELog::EM<<"Stream   == \n"<<A<<ELog::endDiag;
+	      ELog::EM<<"Sections == \n"<<B<<ELog::endDiag;
+	      return -1;
+	    }
+	}
+    }
+  return 0;
+}
+
+int
+testHtapeStream::testProduction()
+  /*!
+    Test an outt08 production table
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testHtapeStream","testProduction");
+  return compareTable(prodTable(),1);
+}
+
+int
+testHtapeStream::testGas()
+  /*!
+    Test an outt14 gas table
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testHtapeStream","testGas");
+  return compareTable(gasTable(),0);
+}
@@ -0,0 +1,228 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testMaterialProcess.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <tuple>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "Zaid.h"
+#include "MXcards.h"
+#include "Material.h"
+#include "materialProcess.h"
+#include "TestFunc.h"
+#include "testMaterialProcess.h"
+
+testMaterialProcess::testMaterialProcess() :
+  FName((boost::filesystem::temp_directory_path() /
+	 boost::filesystem::unique_path("mat-%%%%-%%%%.outp")).string())
+  /*!
+    Constructor : write the test outp file
+  */
+{
+  std::ofstream OX(FName.c_str());
+  OX<<"          Code Name & Version = MCNPX, 2.7.0"<<std::endl;
+  OX<<" CELL CARDS"<<std::endl;
+  OX<<"    1-       1  1 0.1    -1"<<std::endl;
+  OX<<"    2-       2  2 0.08   1 -2"<<std::endl;
+  OX<<"    3-       3  3 0.05   2 -3"<<std::endl;
+  OX<<"  ++ END ++"<<std::endl;
+  OX<<" MATERIAL CARDS"<<std::endl;
+  OX<<"   10-       m1  1001.70c 0.1"<<std::endl;
+  OX<<"   11-       m2  26056.70c 0.08"<<std::endl;
+  OX<<"   12-       m3  1001.70c 0.02  26056.70c 0.03"<<std::endl;
+  OX<<"  ++ END ++"<<std::endl;
+}
+
+testMaterialProcess::~testMaterialProcess()
+  /*!
+    Destructor : remove the test file
+  */
+{
+  boost::system::error_code EC;
+  boost::filesystem::remove(FName,EC);
+}
+
+int
+testMaterialProcess::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testMaterialProcess","applyTest");
+  TestFunc::regSector("testMaterialProcess");
+
+  typedef int (testMaterialProcess::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testMaterialProcess::testMix,
+      &testMaterialProcess::testSameVoid
+    };
+  const std::string TestName[]=
+    {
+      "Mix",
+      "SameVoid"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+void
+testMaterialProcess::readMaterials(materialProcess& MP) const
+  /*!
+    Read the materials of the test outp file
+    \param MP :: Material process to fill
+  */
+{
+  std::map<int,int> cellMat({{1,0},{2,0},{3,0}});
+  MP.readMCNP(FName,cellMat);
+  return;
+}
+
+std::string
+testMaterialProcess::matBlock(const materialProcess& MP,const int matN)
+  /*!
+    Get the CINDER card of a material
+    \param MP :: Materials
+    \param matN :: Material number
+    \return lines of the material [empty if not found]
+  */
+{
+  std::ostringstream cx;
+  MP.write(cx);
+  const std::string Out=cx.str();
+  const std::string Head="Mat Number: "+std::to_string(matN)+"\n";
+  const std::string::size_type pos=Out.find(Head);
+  if (pos==std::string::npos)
+    return "";
+  const std::string::size_type endPos=Out.find("Mat Number:",pos+1);
+  return Out.substr(pos+Head.size(),
+		    (endPos==std::string::npos) ? std::string::npos :
+		    endPos-pos-Head.size());
+}
+
+int
+testMaterialProcess::testMix()
+  /*!
+    Test the volume weighted mixture : each nuclide has the
+    volume mean of its atom density in the materials
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testMaterialProcess","testMix");
+
+  materialProcess MP;
+  readMaterials(MP);
+  // H : (0.1 x 1 + 0.02 x 4)/8  Fe : (0.08 x 3 + 0.03 x 4)/8
+  const int matN=MP.mixMaterials({1,2,3},{1.0,3.0,4.0});
+  const std::string Expect=
+    "mat  4   20.0675\n"
+    "  10010  3.333e-01\n"
+    " 560260  6.667e-01\n";
+  if (matN!=4 || MP.nComponents(4)!=2 || matBlock(MP,4)!=Expect)
+    {
+      ELog::EM<<"Mixture "<<matN<<" ::\n"<<matBlock(MP,matN)<<ELog::endDiag;
+      ELog::EM<<"Expected ::\n"<<Expect<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testMaterialProcess::testSameVoid()
+  /*!
+    Test that a mixture of one material is that material,
+    void adds volume but no atoms and a mismatch throws
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testMaterialProcess","testSameVoid");
+
+  materialProcess MP;
+  readMaterials(MP);
+  if (MP.mixMaterials({2,2},{1.0,5.0})!=2 || MP.nComponents(4))
+    {
+      ELog::EM<<"Mixture of one material made"<<ELog::endDiag;
+      return -1;
+    }
+  if (MP.mixMaterials({98,99},{1.0,1.0})!=0)
+    {
+      ELog::EM<<"Mixture of void made"<<ELog::endDiag;
+      return -1;
+    }
+  // half void : half the atom density
+  const int matN=MP.mixMaterials({1,99},{1.0,1.0});
+  const std::string Expect=
+    "mat  4   10.05\n"
+    "  10010  1.000e+00\n";
+  if (matN!=4 || matBlock(MP,4)!=Expect)
+    {
+      ELog::EM<<"Mixture "<<matN<<" ::\n"<<matBlock(MP,matN)<<ELog::endDiag;
+      return -1;
+    }
+  try
+    {
+      MP.mixMaterials({1,2},{1.0});
+      ELog::EM<<"Mixture of mismatched volumes made"<<ELog::endDiag;
+      return -1;
+    }
+  catch (ColErr::MisMatch<size_t>&)
+    { }
+  return 0;
+}
@@ -0,0 +1,235 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testNormSweep.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <functional>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "Control.h"
+#include "runProgs.h"
+#include "cellJob.h"
+#include "cellRunner.h"
+
+#include "TestFunc.h"
+#include "testProblem.h"
+#include "testNormSweep.h"
+
+testNormSweep::testNormSweep()
+  /*!
+    Constructor
+  */
+{}
+
+testNormSweep::~testNormSweep()
+  /*!
+    Destructor
+  */
+{}
+
+int
+testNormSweep::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testNormSweep","applyTest");
+  TestFunc::regSector("testNormSweep");
+
+  typedef int (testNormSweep::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testNormSweep::testFlagged,
+      &testNormSweep::testSpotCheck
+    };
+  const std::string TestName[]=
+    {
+      "Flagged",
+      "SpotCheck"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+bool
+testNormSweep::isRun(const int cellN,const size_t j)
+  /*!
+    Determine if a cell was run at sweep factor j
+    \param cellN :: Cell number
+    \param j :: Index of the factor
+    \return true if run [false if scaled or missing]
+  */
+{
+  const std::string Dir="Cell"+StrFunc::makeString(cellN)+
+    "/sweep"+StrFunc::makeString(j);
+  return testProblem::readFile(Dir+"/cinderTXT"+
+			       StrFunc::makeString(cellN)+".log")==
+    "cinder run\n";
+}
+
+int
+testNormSweep::testFlagged()
+  /*!
+    Test that only the cells flagged by the burn-up bound
+    and a spot check of the others are run : the other
+    cells are scaled from the base run
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testNormSweep","testFlagged");
+
+  testProblem TP("sweep");
+  for(int cellN=1;cellN<=6;cellN++)
+    TP.addCell(cellN,static_cast<double>(cellN),1.0,0,1.0);
+  TP.addCell(7,1.0,1e4,0,1.0);
+  // burn-up bound at x 2 : below burn_tol [flux 1] and above [flux 1e4]
+  TP.addOptions("run_options\nsweep 2.0 0.5\nsweep_check 2\n"
+		"dedup 0\nburn_xs 1.4e17\nburn_tol 0.2\n");
+  Control Ctrl;
+  TP.readControl(Ctrl);
+  if (Ctrl.writeCinderInput())
+    {
+      ELog::EM<<"Run failed"<<ELog::endDiag;
+      return -1;
+    }
+
+  // check factor [x 2] : flagged 7 and spot check of 1 and 4
+  const std::set<int> RunA({1,4,7});
+  for(int cellN=1;cellN<=7;cellN++)
+    {
+      const bool runA(RunA.find(cellN)!=RunA.end());
+      if (isRun(cellN,0)!=runA || isRun(cellN,1)!=(cellN==7))
+	{
+	  ELog::EM<<"Cell "<<cellN<<" run : "<<isRun(cellN,0)
+		  <<" "<<isRun(cellN,1)<<ELog::endDiag;
+	  return -1;
+	}
+      const std::string CName="Cell"+StrFunc::makeString(cellN);
+      for(size_t j=0;j<2;j++)
+	{
+	  const double F=(j) ? 0.5 : 2.0;
+	  const double D=cellRunner::tableDeviation
+	    (CName,CName+"/sweep"+StrFunc::makeString(j),F);
+	  if (D<0.0 || D>1e-3)
+	    {
+	      ELog::EM<<"Cell "<<cellN<<" sweep "<<j<<" deviation == "
+		      <<D<<ELog::endDiag;
+	      return -1;
+	    }
+	}
+    }
+  return 0;
+}
+
+int
+testNormSweep::testSpotCheck()
+  /*!
+    Test that a spot check that finds a cell that is not
+    linear in the source runs every cell
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testNormSweep","testSpotCheck");
+
+  testProblem TP("sweep");
+  for(int cellN=1;cellN<=4;cellN++)
+    TP.addCell(cellN,static_cast<double>(cellN),1.0,0,1.0);
+  TP.addOptions("run_options\nsweep 2.0 0.5\nsweep_check 1\n"
+		"dedup 0\nburn_xs 1.4e17\nburn_tol 0.2\n");
+  Control Ctrl;
+  TP.readControl(Ctrl);
+
+  // stand-in TABCODE with tables in proportion to norm^2
+  const boost::filesystem::path TName=
+    boost::filesystem::path(TP.getDir()) / "tabcode.sh";
+  std::string Script=testProblem::readFile(TName);
+  const std::string::size_type pos=Script.find("A=F*V*N*I;");
+  if (pos==std::string::npos)
+    {
+      ELog::EM<<"Stand-in TABCODE not found"<<ELog::endDiag;
+      return -1;
+    }
+  Script.replace(pos,10,"A=F*V*N*N*I;");
+  testProblem::writeFile(TName,Script);
+
+  if (Ctrl.writeCinderInput())
+    {
+      ELog::EM<<"Run failed"<<ELog::endDiag;
+      return -1;
+    }
+  for(int cellN=1;cellN<=4;cellN++)
+    if (!isRun(cellN,0) || !isRun(cellN,1) ||
+	testProblem::readFile("Cell"+StrFunc::makeString(cellN)+
+			      "/sweep1/scale")!="")
+      {
+	ELog::EM<<"Cell "<<cellN<<" run : "<<isRun(cellN,0)
+		<<" "<<isRun(cellN,1)<<ELog::endDiag;
+	return -1;
+      }
+  return 0;
+}
@@ -0,0 +1,305 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testProblem.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "runProgs.h"
+#include "Control.h"
+
+#include "testProblem.h"
+
+testProblem::testProblem(const std::string& Tag) :
+  testDir((boost::filesystem::temp_directory_path() /
+	   boost::filesystem::unique_path(Tag+"-%%%%-%%%%")).string()),
+  topDir(boost::filesystem::current_path()),
+  htapeEXE(runProgs::Instance().getHTapeEXE()),
+  cinderEXE(runProgs::Instance().getCinderEXE()),
+  tabcodeEXE(runProgs::Instance().getTabcodeEXE())
+  /*!
+    Constructor : make the scratch directory [as the
+    working directory] and the stand-in programs
+    \param Tag :: Start of the directory name
+  */
+{
+  boost::filesystem::create_directories(testDir);
+  boost::filesystem::current_path(testDir);
+  writeScripts();
+}
+
+testProblem::~testProblem()
+  /*!
+    Destructor : put back the programs and the working
+    directory and remove the scratch directory
+  */
+{
+  runProgs& RP=runProgs::Instance();
+  RP.setHTapeEXE(htapeEXE);
+  RP.setCinderEXE(cinderEXE);
+  RP.setTabcodeEXE(tabcodeEXE);
+  boost::system::error_code EC;
+  boost::filesystem::current_path(topDir,EC);
+  boost::filesystem::remove_all(testDir,EC);
+}
+
+void
+testProblem::writeFile(const boost::filesystem::path& FName,
+		       const std::string& Text)
+  /*!
+    Write a file
+    \param FName :: File
+    \param Text :: Contents
+  */
+{
+  std::ofstream OX(FName.string().c_str());
+  OX<<Text;
+  return;
+}
+
+std::string
+testProblem::readFile(const boost::filesystem::path& FName)
+  /*!
+    Read a whole file
+    \param FName :: File
+    \return contents [empty if not readable]
+  */
+{
+  std::ifstream IX(FName.string().c_str());
+  std::ostringstream cx;
+  cx<<IX.rdbuf();
+  return cx.str();
+}
+
+void
+testProblem::writeScripts() const
+  /*!
+    Write the stand-in programs. HTAPE writes a production
+    table [outt08] for each cell of the int08 file from the
+    histp rows [cell z n production error] and empty gas and
+    destruction tables. TABCODE writes tabs/tab1 with a
+    half-life column [not a time column] and two time
+    columns.
+  */
+{
+  namespace BF=boost::filesystem;
+
+  const BF::path HName=BF::path(testDir) / "htape.sh";
+  const BF::path CName=BF::path(testDir) / "cinder.sh";
+  const BF::path TName=BF::path(testDir) / "tabcode.sh";
+  writeFile(HName,
+	    "#!/bin/sh\n"
+	    "for A in \"$@\"; do\n"
+	    "  case $A in\n"
+	    "    int=*) I=${A#int=} ;;\n"
+	    "    outt=*) O=${A#outt=} ;;\n"
+	    "    histp=*) H=${A#histp=} ;;\n"
+	    "  esac\n"
+	    "done\n"
+	    "if [ \"$I\" != int08 ]; then : > $O; echo htape run; exit 0; fi\n"
+	    "awk 'FNR==NR { R[$1]=R[$1] sprintf(\"   z = %3d n = %3d  "
+	    "%.4E  %.4f\\n\",$2,$3,$4,$5); next }\n"
+	    "  FNR==1 { print \" htape output file 8\";\n"
+	    "    print \" statistical degrees of freedom for the run =   "
+	    "250000\" }\n"
+	    "  /^for cell:/ { n++;\n"
+	    "    printf \"1   case no.    %d   nuclide production\\n\",n;\n"
+	    "    printf \"   residual nuclei for cell:   %d\\n\",$3;\n"
+	    "    print \"      nucleus   production   rel. error\";\n"
+	    "    printf \"%s\",R[$3];\n"
+	    "    print \"   total production complete\"; print \"\" }' "
+	    "$H $I > $O\n"
+	    "echo htape run\n");
+  writeFile(CName,
+	    "#!/bin/sh\n"
+	    "cp input outp\n"
+	    "echo cinder run\n");
+  writeFile(TName,
+	    "#!/bin/sh\n"
+	    "V=`sed -n 2p input | cut -d, -f1`\n"
+	    "N=`sed -n 2p input | cut -d, -f2`\n"
+	    "I=`sed -n 2p fluxes | awk '{ print $NF }'`\n"
+	    "for T in tabs:1 tab1:2; do\n"
+	    "  awk -v \"V=$V\" -v \"N=$N\" -v \"I=$I\" -v F=${T#*:} 'BEGIN {\n"
+	    "    A=F*V*N*I;\n"
+	    "    printf \" %-17s %12.4E %12.4E\\n\",\"time (s)\",0,1000;\n"
+	    "    printf \" %6d %10.3E %12.4E %12.4E\\n\",27060,5.271,A,0.5*A;\n"
+	    "    printf \" %6d %10.3E %12.4E %12.4E\\n\",1003,12.32,0.1*A,0.1*A;\n"
+	    "    printf \" %-17s %12.4E %12.4E\\n\",\"total\",1.1*A,0.6*A }' "
+	    "> ${T%:*}\n"
+	    "done\n"
+	    "echo tabcode run\n");
+  BF::permissions(HName,BF::owner_all);
+  BF::permissions(CName,BF::owner_all);
+  BF::permissions(TName,BF::owner_all);
+  return;
+}
+
+void
+testProblem::addCell(const int cellN,const double V,const double F,
+		     const int shape,const double P)
+  /*!
+    Add a cell to the problem
+    \param cellN :: Cell number
+    \param V :: Volume
+    \param F :: Flux factor
+    \param shape :: Spectrum shape [0 : flat / else tilted]
+    \param P :: Production factor [per unit volume]
+  */
+{
+  Cells[cellN]=cellDef({V,F,shape,P});
+  return;
+}
+
+void
+testProblem::addOptions(const std::string& Lines)
+  /*!
+    Add lines to the control file [e.g. run_options]
+    \param Lines :: Lines [each ending in a new line]
+  */
+{
+  Options+=Lines;
+  return;
+}
+
+void
+testProblem::writeOutp() const
+  /*!
+    Write an MCNP output with a flux tally block of each cell
+  */
+{
+  const std::vector<double> Energy=
+    {1.0e-9,1.0e-7,1.0e-5,1.0e-3,0.1,1.0,5.0,10.0,20.0};
+
+  std::ofstream OX((boost::filesystem::path(testDir) / "problem.outp").
+		   string().c_str());
+  OX<<"          Code Name & Version = MCNPX, 2.7.0"<<std::endl;
+  OX<<"1tally        4        nps =     100000"<<std::endl;
+  OX<<"           tally type 4    track length estimate"<<std::endl;
+  for(const std::map<int,cellDef>::value_type& CV : Cells)
+    {
+      OX<<" cell  "<<CV.first<<std::endl;
+      OX<<"      energy   "<<std::endl;
+      for(size_t i=0;i<Energy.size();i++)
+	{
+	  const double S=(CV.second.shape) ?
+	    1.0+0.1*static_cast<double>(CV.second.shape*i) : 1.0;
+	  OX<<"    "<<std::scientific<<std::setprecision(4)<<Energy[i]
+	    <<"   "<<std::setprecision(5)<<1.0e-3*CV.second.flux*S
+	    <<" "<<std::fixed<<std::setprecision(4)<<0.01<<std::endl;
+	}
+      OX<<"      total      1.00000E-02 0.0100"<<std::endl;
+      OX<<" "<<std::endl;
+    }
+  OX<<" ==================================================="<<std::endl;
+  OX<<" run terminated when 100000 particle histories were done."
+    <<std::endl;
+  return;
+}
+
+void
+testProblem::writeHistp() const
+  /*!
+    Write the histp stand-in : production rows of each cell
+    [total production in proportion to the volume]
+  */
+{
+  std::ofstream OX((boost::filesystem::path(testDir) / "problem.histp").
+		   string().c_str());
+  OX<<std::scientific<<std::setprecision(5);
+  for(const std::map<int,cellDef>::value_type& CV : Cells)
+    {
+      const double P=1.0e-3*CV.second.prod*CV.second.volume;
+      OX<<CV.first<<" 26 30 "<<P<<" 0.01"<<std::endl;
+      OX<<CV.first<<" 27 33 "<<0.5*P<<" 0.02"<<std::endl;
+    }
+  return;
+}
+
+void
+testProblem::writeControl() const
+  /*!
+    Write the control file : the stand-in programs, the
+    outputs, a one step history and the cells
+  */
+{
+  std::ofstream OX((boost::filesystem::path(testDir) / "control").
+		   string().c_str());
+  OX<<"files"<<std::endl;
+  OX<<"htape_exe "<<testDir<<"/htape.sh"<<std::endl;
+  OX<<"cinder_exe "<<testDir<<"/cinder.sh"<<std::endl;
+  OX<<"tabcode_exe "<<testDir<<"/tabcode.sh"<<std::endl;
+  OX<<"mcnpx_outp problem.outp"<<std::endl;
+  OX<<"mcnpx_histp problem.histp"<<std::endl;
+  OX<<"normalization"<<std::endl;
+  OX<<"snorm 2.0"<<std::endl;
+  OX<<"history"<<std::endl;
+  OX<<"1 1.0 10 d"<<std::endl;
+  OX<<Options;
+  OX<<"cell_list"<<std::endl;
+  for(const std::map<int,cellDef>::value_type& CV : Cells)
+    OX<<"c"<<CV.first<<" "<<CV.first<<" "<<CV.second.volume<<std::endl;
+  return;
+}
+
+void
+testProblem::readControl(Control& Ctrl) const
+  /*!
+    Write the problem and read it as the activation
+    program does [up to the cell runs]
+    \param Ctrl :: Control to set
+  */
+{
+  writeOutp();
+  writeHistp();
+  writeControl();
+  Ctrl.readControlFile("control");
+  Ctrl.readFluxes();
+  Ctrl.pruneCells();
+  Ctrl.runHTape();
+  Ctrl.readMaterials();
+  Ctrl.groupCells();
+  return;
+}
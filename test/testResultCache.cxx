@@ -0,0 +1,305 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testResultCache.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "resultCache.h"
+#include "TestFunc.h"
+#include "testResultCache.h"
+
+testResultCache::testResultCache() :
+  testDir((boost::filesystem::temp_directory_path() /
+	   boost::filesystem::unique_path("cache-%%%%-%%%%")).string())
+  /*!
+    Constructor : make the scratch directory
+  */
+{
+  boost::filesystem::create_directories(testDir);
+}
+
+testResultCache::~testResultCache()
+  /*!
+    Destructor : remove the scratch directory
+  */
+{
+  boost::system::error_code EC;
+  boost::filesystem::remove_all(testDir,EC);
+}
+
+int
+testResultCache::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testResultCache","applyTest");
+  TestFunc::regSector("testResultCache");
+
+  typedef int (testResultCache::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testResultCache::testKey,
+      &testResultCache::testRunFile,
+      &testResultCache::testStore,
+      &testResultCache::testEviction
+    };
+  const std::string TestName[]=
+    {
+      "Key",
+      "RunFile",
+      "Store",
+      "Eviction"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+void
+testResultCache::writeFile(const boost::filesystem::path& FName,
+			   const std::string& Text)
+  /*!
+    Write a file
+    \param FName :: File
+    \param Text :: Contents
+  */
+{
+  std::ofstream OX(FName.string().c_str());
+  OX<<Text;
+  return;
+}
+
+std::string
+testResultCache::readFile(const boost::filesystem::path& FName)
+  /*!
+    Read a file
+    \param FName :: File
+    \return contents
+  */
+{
+  std::ifstream IX(FName.string().c_str());
+  std::ostringstream cx;
+  cx<<IX.rdbuf();
+  return cx.str();
+}
+
+std::string
+testResultCache::makeCell(const std::string& CName,
+			  const std::string& Flux) const
+  /*!
+    Make a cell directory with inputs and the
+    outputs of a run
+    \param CName :: Cell directory name
+    \param Flux :: Contents of the fluxes file
+    \return cell directory
+  */
+{
+  const boost::filesystem::path DName=
+    boost::filesystem::path(testDir) / CName;
+  boost::filesystem::create_directories(DName);
+
+  for(const std::string& F : resultCache::inputFiles())
+    writeFile(DName / F,(F=="fluxes") ? Flux : F+" input\n");
+  writeFile(DName / "outp","outp of "+Flux);
+  writeFile(DName / "tab2","tab2 of "+Flux);
+  writeFile(DName / "cinder.log","not a result\n");
+  return DName.string();
+}
+
+int
+testResultCache::testKey()
+  /*!
+    Test that the problem key depends only on the
+    contents of the input files
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testResultCache","testKey");
+
+  const std::string DA=makeCell("a","flux 1\n");
+  const std::string DB=makeCell("b","flux 1\n");
+  const std::string DC=makeCell("c","flux 2\n");
+  const std::string DD=makeCell("d","flux 1\n");
+  boost::filesystem::remove(boost::filesystem::path(DD) / "splprods");
+
+  const std::string KA=resultCache::problemKey(DA);
+  writeFile(boost::filesystem::path(DA) / "outp","new output\n");
+  if (KA.size()!=32 ||
+      resultCache::problemKey(DA)!=KA ||
+      resultCache::problemKey(DB)!=KA ||
+      resultCache::problemKey(DC)==KA ||
+      !resultCache::problemKey(DD).empty())
+    {
+      ELog::EM<<"Key A == "<<KA<<ELog::endDiag;
+      ELog::EM<<"Key B == "<<resultCache::problemKey(DB)<<ELog::endDiag;
+      ELog::EM<<"Key C == "<<resultCache::problemKey(DC)<<ELog::endDiag;
+      ELog::EM<<"Key D == "<<resultCache::problemKey(DD)<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testResultCache::testRunFile()
+  /*!
+    Test that a changed run file [material] of the same
+    size is not taken from the hash of the old file
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testResultCache","testRunFile");
+
+  const boost::filesystem::path DA=makeCell("r","flux 1\n");
+  const std::string KA=resultCache::problemKey(DA.string());
+  writeFile(DA / "material","MATERIAL INPUT\n");
+  const std::string KB=resultCache::problemKey(DA.string());
+  writeFile(DA / "material","material input\n");
+  const std::string KC=resultCache::problemKey(DA.string());
+  if (KA.empty() || KB==KA || KC!=KA)
+    {
+      ELog::EM<<"Key A == "<<KA<<ELog::endDiag;
+      ELog::EM<<"Key B == "<<KB<<ELog::endDiag;
+      ELog::EM<<"Key C == "<<KC<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testResultCache::testStore()
+  /*!
+    Test that the results [only] are stored and
+    restored and that the index is written
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testResultCache","testStore");
+
+  namespace BF=boost::filesystem;
+
+  const BF::path CDir=BF::path(testDir) / "cacheStore";
+  const std::string DA=makeCell("sa","flux 1\n");
+  const std::string DB=makeCell("sb","flux 9\n");
+  const std::string Key=resultCache::problemKey(DA);
+  {
+    resultCache RC(CDir.string(),0);
+    RC.store(Key,DA);
+    RC.flush();
+  }
+  resultCache RC(CDir.string(),0);
+  BF::remove(BF::path(DB) / "outp");
+  BF::remove(BF::path(DB) / "tab2");
+  if (!RC.restore(Key,DB) || RC.restore("none",DB) ||
+      readFile(BF::path(DB) / "outp")!="outp of flux 1\n" ||
+      readFile(BF::path(DB) / "tab2")!="tab2 of flux 1\n" ||
+      BF::exists(CDir / Key / "cinder.log") ||
+      BF::exists(CDir / Key / "fluxes"))
+    {
+      ELog::EM<<"Restore failed : "<<DB<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testResultCache::testEviction()
+  /*!
+    Test that the least recently used entries are
+    removed when the cache is over its size
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testResultCache","testEviction");
+
+  namespace BF=boost::filesystem;
+
+  // two old entries of 100 bytes [used at time 10 / 20] and a
+  // new one of 98 bytes : only the oldest is removed
+  const BF::path CDir=BF::path(testDir) / "cacheEvict";
+  const std::string Block(100,'x');
+  BF::create_directories(CDir / "k1");
+  BF::create_directories(CDir / "k2");
+  writeFile(CDir / "k1" / "outp",Block);
+  writeFile(CDir / "k2" / "outp",Block);
+  writeFile(CDir / "index","k1 100 10\nk2 100 20\n");
+
+  const std::string DA=makeCell("ea",std::string(40,'y')+"\n");
+  const std::string DB=makeCell("eb","flux\n");
+  {
+    resultCache RC(CDir.string(),250);
+    RC.store("k3",DA);
+    RC.flush();
+    if (BF::exists(CDir / "k1") || !BF::exists(CDir / "k2") ||
+	!BF::exists(CDir / "k3" / "outp"))
+      {
+	ELog::EM<<"Eviction failed"<<ELog::endDiag;
+	return -1;
+      }
+  }
+
+  resultCache RC(CDir.string(),250);
+  if (RC.restore("k1",DB) || !RC.restore("k2",DB) ||
+      readFile(BF::path(DB) / "outp")!=Block ||
+      !RC.restore("k3",DB))
+    {
+      ELog::EM<<"Restore after eviction failed"<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
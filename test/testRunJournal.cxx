@@ -0,0 +1,357 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testRunJournal.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "cellJob.h"
+#include "resultCache.h"
+#include "runJournal.h"
+#include "TestFunc.h"
+#include "testRunJournal.h"
+
+testRunJournal::testRunJournal() :
+  testDir((boost::filesystem::temp_directory_path() /
+	   boost::filesystem::unique_path("journal-%%%%-%%%%")).string()),
+  JName((boost::filesystem::path(testDir) / "journal").string())
+  /*!
+    Constructor : make the scratch directory
+  */
+{
+  boost::filesystem::create_directories(testDir);
+}
+
+testRunJournal::~testRunJournal()
+  /*!
+    Destructor : remove the scratch directory
+  */
+{
+  boost::system::error_code EC;
+  boost::filesystem::remove_all(testDir,EC);
+}
+
+int
+testRunJournal::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testRunJournal","applyTest");
+  TestFunc::regSector("testRunJournal");
+
+  typedef int (testRunJournal::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testRunJournal::testRoundTrip,
+      &testRunJournal::testTornLine,
+      &testRunJournal::testResume,
+      &testRunJournal::testAppendOnly
+    };
+  const std::string TestName[]=
+    {
+      "RoundTrip",
+      "TornLine",
+      "Resume",
+      "AppendOnly"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+std::string
+testRunJournal::makeCell(const int cellN) const
+  /*!
+    Make a cell directory with the inputs and outputs
+    of a finished run
+    \param cellN :: Cell number
+    \return cell directory
+  */
+{
+  const boost::filesystem::path DName=
+    boost::filesystem::path(testDir) / ("c"+StrFunc::makeString(cellN));
+  boost::filesystem::create_directories(DName);
+
+  std::vector<std::string> Files(resultCache::inputFiles());
+  Files.push_back("outp");
+  Files.push_back("tabs");
+  Files.push_back("tab1");
+  for(const std::string& F : Files)
+    {
+      std::ofstream OX((DName / F).string().c_str());
+      OX<<F<<" of cell "<<cellN<<std::endl;
+    }
+  return DName.string();
+}
+
+cellJob
+testRunJournal::makeJob(const int cellN,const std::string& DName,
+			const int status)
+  /*!
+    Make a finished job
+    \param cellN :: Cell number
+    \param DName :: Cell directory
+    \param status :: Job status
+    \return job
+  */
+{
+  cellJob CJ(cellN,DName,1.0,0);
+  CJ.status=status;
+  CJ.cinderExit=(status) ? 3 : 0;
+  CJ.tabcodeExit=(status) ? -1 : 0;
+  CJ.startTime=1.0*cellN;
+  CJ.endTime=2.5*cellN;
+  CJ.hashKey=resultCache::problemKey(DName);
+  return CJ;
+}
+
+std::vector<std::string>
+testRunJournal::readLines(const std::string& FName)
+  /*!
+    Read the lines of a file
+    \param FName :: File
+    \return lines
+  */
+{
+  std::vector<std::string> Out;
+  std::ifstream IX(FName.c_str());
+  std::string Line;
+  while(std::getline(IX,Line))
+    Out.push_back(Line);
+  return Out;
+}
+
+int
+testRunJournal::testRoundTrip()
+  /*!
+    Test that records are read back and checked
+    against the inputs and outputs
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testRunJournal","testRoundTrip");
+
+  const cellJob CA=makeJob(1,makeCell(1),0);
+  const cellJob CB=makeJob(2,makeCell(2),1);
+  {
+    runJournal JW(JName,0);
+    JW.record(CA);
+    JW.record(CB);
+  }
+
+  const std::vector<std::string> Lines=readLines(JName);
+  runJournal JR(JName,1);
+  if (Lines.size()!=2 || JR.nDone()!=1 ||
+      !JR.isComplete(CA) || !JR.isComplete(1) ||
+      JR.isComplete(CB) || JR.isComplete(2) ||
+      JR.getRecord(1)!=Lines[0]+"\n")
+    {
+      ELog::EM<<"Lines == "<<Lines.size()<<" done "
+	      <<JR.nDone()<<ELog::endDiag;
+      return -1;
+    }
+
+  const std::map<int,double> Times=runJournal::readTimes(JName);
+  if (Times.size()!=1 || Times.begin()->first!=1 ||
+      std::abs(Times.begin()->second-1.5)>1e-6)
+    {
+      ELog::EM<<"Times == "<<Times.size()<<ELog::endDiag;
+      return -1;
+    }
+
+  // changed key / output / input
+  cellJob CC(CA);
+  CC.hashKey="other";
+  if (JR.isComplete(CC))
+    {
+      ELog::EM<<"Complete with a different key"<<ELog::endDiag;
+      return -1;
+    }
+  std::ofstream((boost::filesystem::path(CA.dirName) / "tab1").
+		string().c_str())<<"changed"<<std::endl;
+  if (JR.isComplete(CA) || JR.isComplete(1))
+    {
+      ELog::EM<<"Complete with a changed output"<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testRunJournal::testTornLine()
+  /*!
+    Test that a torn last line is skipped and ended
+    on resume so the next record is on its own line
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testRunJournal","testTornLine");
+
+  const cellJob CA=makeJob(1,makeCell(1),0);
+  const cellJob CB=makeJob(2,makeCell(2),0);
+  {
+    runJournal JW(JName,0);
+    JW.record(CA);
+    JW.append("cell 2 dir "+CB.dirName+" status 0 cin");
+  }
+  {
+    runJournal JR(JName,1);
+    if (JR.nDone()!=1 || JR.isComplete(CB))
+      {
+	ELog::EM<<"Torn line done == "<<JR.nDone()<<ELog::endDiag;
+	return -1;
+      }
+    JR.record(CB);
+  }
+
+  const std::vector<std::string> Lines=readLines(JName);
+  runJournal JR(JName,1);
+  if (Lines.size()!=3 || JR.nDone()!=2 || !JR.isComplete(CB) ||
+      JR.getRecord(2)!=Lines[2]+"\n")
+    {
+      ELog::EM<<"Lines == "<<Lines.size()<<" done "
+	      <<JR.nDone()<<ELog::endDiag;
+      for(const std::string& L : Lines)
+	ELog::EM<<"  ["<<L<<"]"<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testRunJournal::testResume()
+  /*!
+    Test that the last record of a cell wins, that a
+    new journal is truncated and the shard spec is kept
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testRunJournal","testResume");
+
+  const std::string DA=makeCell(1);
+  const std::string DB=makeCell(2);
+  {
+    runJournal JW(JName,0);
+    JW.writeShard(1,3,std::vector<int>({1,2,7}));
+    JW.record(makeJob(1,DA,8));
+    JW.record(makeJob(2,DB,0));
+  }
+  {
+    // resumed run : 1 now good and 2 failed
+    runJournal JW(JName,1);
+    JW.record(makeJob(1,DA,0));
+    JW.record(makeJob(2,DB,32));
+  }
+
+  size_t I,N;
+  runJournal JR(JName,1);
+  if (JR.nDone()!=1 || !JR.isComplete(1) || JR.isComplete(2) ||
+      !JR.getShard(I,N) || I!=1 || N!=3 ||
+      JR.getPlanned()!=std::vector<int>({1,2,7}))
+    {
+      ELog::EM<<"Done == "<<JR.nDone()<<ELog::endDiag;
+      return -1;
+    }
+
+  runJournal JNew(JName,0);
+  runJournal JEmpty(JName,1);
+  if (JEmpty.nDone() || JEmpty.getShard(I,N) ||
+      !readLines(JName).empty())
+    {
+      ELog::EM<<"New journal not empty"<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testRunJournal::testAppendOnly()
+  /*!
+    Test that a kept journal that is not read [plan job]
+    is appended to without truncation
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testRunJournal","testAppendOnly");
+
+  const cellJob CA=makeJob(1,makeCell(1),0);
+  const cellJob CB=makeJob(2,makeCell(2),0);
+  {
+    runJournal JW(JName,0);
+    JW.record(CA);
+  }
+  {
+    runJournal JA(JName,1,0);
+    if (JA.nDone() || JA.isComplete(CA))
+      {
+	ELog::EM<<"Append only journal read : "<<JA.nDone()<<ELog::endDiag;
+	return -1;
+      }
+    JA.record(CB);
+  }
+  const runJournal JR(JName);
+  if (readLines(JName).size()!=2 || JR.nDone()!=2 ||
+      !JR.isComplete(CA) || !JR.isComplete(CB))
+    {
+      ELog::EM<<"Done == "<<JR.nDone()<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
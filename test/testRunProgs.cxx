@@ -0,0 +1,268 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testRunProgs.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <functional>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "runProgs.h"
+#include "TestFunc.h"
+#include "testRunProgs.h"
+
+testRunProgs::testRunProgs() :
+  testDir((boost::filesystem::temp_directory_path() /
+	   boost::filesystem::unique_path("progs-%%%%-%%%%")).string())
+  /*!
+    Constructor : make the scratch directory
+  */
+{
+  boost::filesystem::create_directories(testDir);
+}
+
+testRunProgs::~testRunProgs()
+  /*!
+    Destructor : remove the scratch directory
+  */
+{
+  boost::system::error_code EC;
+  boost::filesystem::remove_all(testDir,EC);
+}
+
+int
+testRunProgs::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testRunProgs","applyTest");
+  TestFunc::regSector("testRunProgs");
+
+  typedef int (testRunProgs::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testRunProgs::testCapture,
+      &testRunProgs::testEnv,
+      &testRunProgs::testPipe
+    };
+  const std::string TestName[]=
+    {
+      "Capture",
+      "Env",
+      "Pipe"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+std::string
+testRunProgs::readFile(const boost::filesystem::path& FName)
+  /*!
+    Read a file
+    \param FName :: File
+    \return contents [empty if missing]
+  */
+{
+  std::ifstream IX(FName.string().c_str());
+  std::ostringstream cx;
+  cx<<IX.rdbuf();
+  return cx.str();
+}
+
+int
+testRunProgs::waitFor(const pid_t pid)
+  /*!
+    Wait for a child to finish
+    \param pid :: Child
+    \return exit code [-1 if not started]
+  */
+{
+  if (pid<=0) return -1;
+  runProgs& RP=runProgs::Instance();
+  int code;
+  while(!RP.checkChild(pid,code))
+    RP.reapChildren(1,1.0);
+  return code;
+}
+
+int
+testRunProgs::testCapture()
+  /*!
+    Test that a child runs in its working directory
+    with stdout and stderr in separate files
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testRunProgs","testCapture");
+
+  namespace BF=boost::filesystem;
+
+  const std::map<std::string,std::string> noEnv;
+  runProgs& RP=runProgs::Instance();
+  const BF::path EDir=BF::path(testDir) / "capture";
+  BF::create_directories(EDir);
+  std::ofstream OX((EDir / "here").string().c_str());
+  OX<<"x"<<std::endl;
+  OX.close();
+
+  const int AExit=waitFor
+    (RP.startCode("ls","here",EDir.string(),"a.out","a.err",noEnv));
+  const int BExit=waitFor
+    (RP.startCode("ls","not-here",EDir.string(),"b.out","b.err",noEnv));
+  const int CExit=waitFor
+    (RP.startCode("no-such-program-here","",EDir.string(),"","",noEnv));
+
+  if (AExit || readFile(EDir / "a.out")!="here\n" ||
+      !readFile(EDir / "a.err").empty() ||
+      !BExit || !readFile(EDir / "b.out").empty() ||
+      readFile(EDir / "b.err").empty() || CExit!=127)
+    {
+      ELog::EM<<"Exit codes == "<<AExit<<" "<<BExit<<" "
+	      <<CExit<<ELog::endDiag;
+      ELog::EM<<"b.err == "<<readFile(EDir / "b.err")<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testRunProgs::testEnv()
+  /*!
+    Test the environment of a child : the process
+    environment, setEnv for all children and the
+    variables of one child [which win]
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testRunProgs","testEnv");
+
+  namespace BF=boost::filesystem;
+
+  runProgs& RP=runProgs::Instance();
+  const BF::path EDir=BF::path(testDir) / "env";
+  BF::create_directories(EDir);
+  RP.setEnv("ACT_TEST_ALL","all children");
+
+  std::map<std::string,std::string> jobEnv;
+  jobEnv["ACT_TEST_JOB"]="this job";
+  const int AExit=waitFor
+    (RP.startCode("printenv","ACT_TEST_ALL ACT_TEST_JOB HOME",
+		  EDir.string(),"a.out","",jobEnv));
+  jobEnv["ACT_TEST_ALL"]="mine";
+  const int BExit=waitFor
+    (RP.startCode("printenv","ACT_TEST_ALL",EDir.string(),"b.out","",jobEnv));
+  const int CExit=waitFor
+    (RP.startCode("printenv","ACT_TEST_JOB",EDir.string(),"c.out","",
+		  std::map<std::string,std::string>()));
+
+  const char* homePtr=getenv("HOME");
+  const std::string Home=(homePtr) ? std::string(homePtr)+"\n" : "";
+  if (AExit || readFile(EDir / "a.out")!="all children\nthis job\n"+Home ||
+      BExit || readFile(EDir / "b.out")!="mine\n" ||
+      !CExit || !readFile(EDir / "c.out").empty())
+    {
+      ELog::EM<<"a.out == "<<readFile(EDir / "a.out")<<ELog::endDiag;
+      ELog::EM<<"b.out == "<<readFile(EDir / "b.out")<<ELog::endDiag;
+      ELog::EM<<"c.out == "<<readFile(EDir / "c.out")<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testRunProgs::testPipe()
+  /*!
+    Test that stdout of a child can be read from a pipe
+    while stderr goes to a file
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testRunProgs","testPipe");
+
+  namespace BF=boost::filesystem;
+
+  runProgs& RP=runProgs::Instance();
+  const BF::path EDir=BF::path(testDir) / "pipe";
+  BF::create_directories(EDir);
+
+  std::map<std::string,std::string> jobEnv;
+  jobEnv["ACT_TEST_PIPE"]="through the pipe";
+  int readFD;
+  const pid_t pid=RP.startPipe("printenv","ACT_TEST_PIPE ACT_TEST_NONE",
+			       EDir.string(),"p.err",jobEnv,readFD);
+  std::string Out;
+  if (readFD>=0)
+    {
+      char Buffer[64];
+      ssize_t N;
+      while((N=read(readFD,Buffer,sizeof(Buffer)))>0)
+	Out.append(Buffer,static_cast<size_t>(N));
+      close(readFD);
+    }
+  // printenv exits 1 : one variable is not set
+  const int PExit=waitFor(pid);
+  if (readFD<0 || Out!="through the pipe\n" || PExit!=1 ||
+      !BF::exists(EDir / "p.err"))
+    {
+      ELog::EM<<"Pipe == "<<Out<<" : exit "<<PExit<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
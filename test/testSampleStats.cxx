@@ -0,0 +1,282 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testSampleStats.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "pSquare.h"
+#include "sampleStats.h"
+#include "TestFunc.h"
+#include "testSampleStats.h"
+
+testSampleStats::testSampleStats() :
+  testDir((boost::filesystem::temp_directory_path() /
+	   boost::filesystem::unique_path("stats-%%%%-%%%%")).string())
+  /*!
+    Constructor : make the scratch directory
+  */
+{
+  boost::filesystem::create_directories(testDir);
+}
+
+testSampleStats::~testSampleStats()
+  /*!
+    Destructor : remove the scratch directory
+  */
+{
+  boost::system::error_code EC;
+  boost::filesystem::remove_all(testDir,EC);
+}
+
+int
+testSampleStats::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testSampleStats","applyTest");
+  TestFunc::regSector("testSampleStats");
+
+  typedef int (testSampleStats::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testSampleStats::testPSquare,
+      &testSampleStats::testStats,
+      &testSampleStats::testLayout
+    };
+  const std::string TestName[]=
+    {
+      "PSquare",
+      "Stats",
+      "Layout"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+void
+testSampleStats::writeFile(const std::string& FName,
+			   const std::string& Text) const
+  /*!
+    Write a file in the scratch directory
+    \param FName :: File name
+    \param Text :: Contents
+  */
+{
+  std::ofstream OX((boost::filesystem::path(testDir) / FName).
+		   string().c_str());
+  OX<<Text;
+  return;
+}
+
+std::string
+testSampleStats::readFile(const std::string& FName) const
+  /*!
+    Read a file of the scratch directory
+    \param FName :: File name
+    \return contents [empty if not readable]
+  */
+{
+  std::ifstream IX((boost::filesystem::path(testDir) / FName).
+		   string().c_str());
+  std::ostringstream cx;
+  cx<<IX.rdbuf();
+  return cx.str();
+}
+
+int
+testSampleStats::testPSquare()
+  /*!
+    Test the quantile estimate : exact for fewer than five
+    values and close to the exact quantile of many values
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testSampleStats","testPSquare");
+
+  // exact : sorted 1 3 5
+  typedef std::tuple<double,double> TTYPE;
+  const std::vector<TTYPE> Small=
+    {
+      TTYPE(0.05,1.0),TTYPE(0.5,3.0),TTYPE(0.95,5.0)
+    };
+  for(const TTYPE& tc : Small)
+    {
+      pSquare PS(std::get<0>(tc));
+      if (PS.getValue()!=0.0) return -1;
+      for(const double V : {5.0,1.0,3.0})
+	PS.addValue(V);
+      if (PS.getCount()!=3 || PS.getValue()!=std::get<1>(tc))
+	{
+	  ELog::EM<<"P "<<std::get<0>(tc)<<" : "<<PS.getValue()
+		  <<" != "<<std::get<1>(tc)<<ELog::endDiag;
+	  return -1;
+	}
+    }
+
+  // 0-999 in a scrambled order
+  const std::vector<TTYPE> Large=
+    {
+      TTYPE(0.05,49.95),TTYPE(0.5,499.5),TTYPE(0.95,949.05)
+    };
+  for(const TTYPE& tc : Large)
+    {
+      pSquare PS(std::get<0>(tc));
+      for(size_t i=0;i<1000;i++)
+	PS.addValue(static_cast<double>((i*377) % 1000));
+      if (PS.getCount()!=1000 ||
+	  std::abs(PS.getValue()-std::get<1>(tc))>10.0)
+	{
+	  ELog::EM<<"P "<<std::get<0>(tc)<<" : "<<PS.getValue()
+		  <<" != "<<std::get<1>(tc)<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testSampleStats::testStats()
+  /*!
+    Test the statistics files : every number of the first
+    file is replaced by its statistic over the samples
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testSampleStats","testStats");
+
+  sampleStats SS;
+  const std::string FBase=
+    (boost::filesystem::path(testDir) / "tabs").string();
+  for(const std::string V : {"1.0E+00","3.0E+00","2.0E+00"})
+    {
+      writeFile("tabs"," cell 5\n  27060  "+V+"\n");
+      if (!SS.addFile(FBase))
+	{
+	  ELog::EM<<"Sample "<<V<<" not added"<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  SS.write(FBase);
+
+  typedef std::tuple<std::string,std::string> TTYPE;
+  const std::vector<TTYPE> Tests=
+    {
+      TTYPE("tabs.mean","2.00000e+00"),
+      TTYPE("tabs.std","1.00000e+00"),
+      TTYPE("tabs.p05","1.00000e+00"),
+      TTYPE("tabs.p50","2.00000e+00"),
+      TTYPE("tabs.p95","3.00000e+00")
+    };
+  for(const TTYPE& tc : Tests)
+    {
+      // constant numbers : std of zero
+      const std::string CellN=(std::get<0>(tc)=="tabs.std") ?
+	"0.00000e+00" : "5.00000e+00";
+      const std::string ID=(std::get<0>(tc)=="tabs.std") ?
+	"0.00000e+00" : "2.70600e+04";
+      const std::string Expect=" cell  "+CellN+"\n   "+ID+
+	"   "+std::get<1>(tc)+"\n";
+      const std::string Out=readFile(std::get<0>(tc));
+      if (Out!=Expect)
+	{
+	  ELog::EM<<std::get<0>(tc)<<" ::\n"<<Out<<ELog::endDiag;
+	  ELog::EM<<"Expected ::\n"<<Expect<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  if (SS.getCount()!=3)
+    return -1;
+  return 0;
+}
+
+int
+testSampleStats::testLayout()
+  /*!
+    Test that a missing sample file or a sample with
+    another layout is not added
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testSampleStats","testLayout");
+
+  sampleStats SS;
+  const std::string FBase=
+    (boost::filesystem::path(testDir) / "layout").string();
+  if (SS.addFile(FBase))
+    {
+      ELog::EM<<"Missing file added"<<ELog::endDiag;
+      return -1;
+    }
+  writeFile("layout"," cell 5\n  27060  1.0E+00\n");
+  if (!SS.addFile(FBase)) return -1;
+
+  for(const std::string Text : {" cell 5\n  27060\n",
+	" cell 5\n  27060  1.0E+00\n  27061  1.0E+00\n"})
+    {
+      writeFile("layout",Text);
+      if (SS.addFile(FBase) || SS.getCount()!=1)
+	{
+	  ELog::EM<<"Layout added ::\n"<<Text<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
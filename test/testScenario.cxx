@@ -0,0 +1,161 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testScenario.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "Control.h"
+
+#include "TestFunc.h"
+#include "testProblem.h"
+#include "testScenario.h"
+
+testScenario::testScenario()
+  /*!
+    Constructor
+  */
+{}
+
+testScenario::~testScenario()
+  /*!
+    Destructor
+  */
+{}
+
+int
+testScenario::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testScenario","applyTest");
+  TestFunc::regSector("testScenario");
+
+  typedef int (testScenario::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testScenario::testShareDecks
+    };
+  const std::string TestName[]=
+    {
+      "ShareDecks"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+int
+testScenario::testShareDecks()
+  /*!
+    Test that a named history writes only its input file :
+    the other input files are links to the files of the
+    main directory of the cell
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testScenario","testShareDecks");
+
+  namespace BF=boost::filesystem;
+
+  testProblem TP("scenario");
+  TP.addCell(1,1.0,1.0,0,1.0);
+  TP.addCell(2,2.0,3.0,0,1.0);
+  TP.addOptions("history low\n1 0.5 10 d\n"
+		"run_options\nworkers 2\ndedup 0\n");
+  Control Ctrl;
+  TP.readControl(Ctrl);
+  if (Ctrl.writeCinderInput())
+    {
+      ELog::EM<<"Run failed"<<ELog::endDiag;
+      return -1;
+    }
+
+  for(const std::string CName : {"Cell1","Cell2"})
+    {
+      const BF::path MDir(CName);
+      const BF::path LDir=BF::path("low") / CName;
+      for(const std::string FName : {"fluxes","splprods","material","locate"})
+	if (!BF::exists(LDir / FName) ||
+	    !BF::equivalent(MDir / FName,LDir / FName))
+	  {
+	    ELog::EM<<"File "<<(LDir / FName).string()
+		    <<" not shared"<<ELog::endDiag;
+	    return -1;
+	  }
+      const std::string MInput=testProblem::readFile(MDir / "input");
+      const std::string LInput=testProblem::readFile(LDir / "input");
+      if (MInput.empty() || LInput.empty() || MInput==LInput ||
+	  BF::hard_link_count(LDir / "input")!=1 ||
+	  testProblem::readFile(LDir / "tabs").empty())
+	{
+	  ELog::EM<<"Input of "<<CName<<" ::\n"<<MInput<<ELog::endDiag;
+	  ELog::EM<<"Input of low/"<<CName<<" ::\n"<<LInput<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
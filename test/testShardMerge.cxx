@@ -0,0 +1,346 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testShardMerge.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "stringCombine.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "cellJob.h"
+#include "resultCache.h"
+#include "runJournal.h"
+#include "Control.h"
+#include "shardMerge.h"
+
+#include "TestFunc.h"
+#include "testShardMerge.h"
+
+testShardMerge::testShardMerge() :
+  testDir((boost::filesystem::temp_directory_path() /
+	   boost::filesystem::unique_path("shard-%%%%-%%%%")).string()),
+  JName((boost::filesystem::path(testDir) / "journal").string())
+  /*!
+    Constructor : make the scratch directory
+  */
+{
+  boost::filesystem::create_directories(testDir);
+}
+
+testShardMerge::~testShardMerge()
+  /*!
+    Destructor : remove the scratch directory
+  */
+{
+  boost::system::error_code EC;
+  boost::filesystem::remove_all(testDir,EC);
+}
+
+int
+testShardMerge::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testShardMerge","applyTest");
+  TestFunc::regSector("testShardMerge");
+
+  typedef int (testShardMerge::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testShardMerge::testMerge,
+      &testShardMerge::testMissing,
+      &testShardMerge::testReadOnly
+    };
+  const std::string TestName[]=
+    {
+      "Merge",
+      "Missing",
+      "ReadOnly"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+std::string
+testShardMerge::makeCell(const std::string& G,const int cellN) const
+  /*!
+    Make a cell directory of a history with the inputs
+    and outputs of a finished run
+    \param G :: Named history [empty : main history]
+    \param cellN :: Cell number
+    \return cell directory
+  */
+{
+  boost::filesystem::path DName(testDir);
+  if (!G.empty())
+    DName/=G;
+  DName/=("c"+StrFunc::makeString(cellN));
+  boost::filesystem::create_directories(DName);
+
+  std::vector<std::string> Files(resultCache::inputFiles());
+  Files.push_back("outp");
+  Files.push_back("tabs");
+  for(const std::string& F : Files)
+    {
+      std::ofstream OX((DName / F).string().c_str());
+      OX<<F<<" of cell "<<cellN<<" "<<G<<std::endl;
+    }
+  return DName.string();
+}
+
+void
+testShardMerge::writeShard(const std::string& G,const size_t I,
+			   const std::vector<int>& Cells,
+			   const int badCell) const
+  /*!
+    Write the journal of shard I/2 of a history with a
+    record for each cell
+    \param G :: Named history [empty : main history]
+    \param I :: Shard index
+    \param Cells :: Planned cells
+    \param badCell :: Cell recorded as failed
+  */
+{
+  boost::filesystem::path SName(testDir);
+  if (!G.empty())
+    SName/=G;
+  SName/=("journal."+StrFunc::makeString(I));
+  boost::filesystem::create_directories(SName.parent_path());
+
+  runJournal JW(SName.string(),0);
+  JW.writeShard(I,2,Cells);
+  for(const int CN : Cells)
+    {
+      cellJob CJ(CN,makeCell(G,CN),1.0,0);
+      CJ.status=(CN==badCell) ? 1 : 0;
+      CJ.cinderExit=(CN==badCell) ? 3 : 0;
+      CJ.tabcodeExit=0;
+      CJ.hashKey=resultCache::problemKey(CJ.dirName);
+      JW.record(CJ);
+    }
+  return;
+}
+
+void
+testShardMerge::readControl(Control& Ctrl) const
+  /*!
+    Read a control file with the journal in the scratch
+    directory, a main history and a named history [low]
+    \param Ctrl :: Control to set
+  */
+{
+  const std::string CName=
+    (boost::filesystem::path(testDir) / "control").string();
+  std::ofstream OX(CName.c_str());
+  OX<<"files"<<std::endl;
+  OX<<"journal "<<JName<<std::endl;
+  OX<<"history"<<std::endl;
+  OX<<"1 1.0 10 d"<<std::endl;
+  OX<<"history low"<<std::endl;
+  OX<<"1 0.5 10 d"<<std::endl;
+  OX.close();
+  Ctrl.readControlFile(CName);
+  return;
+}
+
+std::string
+testShardMerge::readFile(const std::string& FName)
+  /*!
+    Read a whole file
+    \param FName :: File
+    \return contents
+  */
+{
+  std::ifstream IX(FName.c_str());
+  std::ostringstream cx;
+  cx<<IX.rdbuf();
+  return cx.str();
+}
+
+size_t
+testShardMerge::nRecords(const std::string& FName)
+  /*!
+    Number of good records in a journal
+    \param FName :: Journal file
+    \return completed cells
+  */
+{
+  const runJournal JR(FName);
+  return JR.nDone();
+}
+
+int
+testShardMerge::testMerge()
+  /*!
+    Test that the shard journals of the main and the
+    named history are merged into their journals and
+    are left unchanged
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testShardMerge","testMerge");
+
+  const std::string LName=scenarioSet::scenarioPath("low",JName);
+  writeShard("",0,std::vector<int>({1,2}),0);
+  writeShard("",1,std::vector<int>({3}),0);
+  writeShard("low",0,std::vector<int>({1,2}),0);
+  writeShard("low",1,std::vector<int>({3}),0);
+  const std::vector<std::string> Before=
+    {
+      readFile(JName+".0"),readFile(JName+".1"),
+      readFile(LName+".0"),readFile(LName+".1")
+    };
+
+  Control Ctrl;
+  readControl(Ctrl);
+  const shardMerge SM(Ctrl);
+  const size_t nBad=SM.merge(2);
+
+  const std::vector<std::string> After=
+    {
+      readFile(JName+".0"),readFile(JName+".1"),
+      readFile(LName+".0"),readFile(LName+".1")
+    };
+  if (nBad || nRecords(JName)!=3 || nRecords(LName)!=3 ||
+      After!=Before)
+    {
+      ELog::EM<<"Bad == "<<nBad<<" main "<<nRecords(JName)
+	      <<" low "<<nRecords(LName)<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testShardMerge::testMissing()
+  /*!
+    Test that a failed cell in a named history and a
+    missing shard journal are counted
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testShardMerge","testMissing");
+
+  writeShard("",0,std::vector<int>({1,2}),0);
+  writeShard("",1,std::vector<int>({3}),0);
+  writeShard("low",0,std::vector<int>({1,2}),2);
+  // shard 1 of low never ran
+  boost::filesystem::remove
+    (scenarioSet::scenarioPath("low",JName)+".1");
+
+  Control Ctrl;
+  readControl(Ctrl);
+  const shardMerge SM(Ctrl);
+  const size_t nBad=SM.merge(2);
+  const std::string LName=scenarioSet::scenarioPath("low",JName);
+  if (nBad!=2 || nRecords(JName)!=3 || nRecords(LName)!=1)
+    {
+      ELog::EM<<"Bad == "<<nBad<<" main "<<nRecords(JName)
+	      <<" low "<<nRecords(LName)<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
+
+int
+testShardMerge::testReadOnly()
+  /*!
+    Test that a journal opened read only is read
+    but cannot be appended to
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testShardMerge","testReadOnly");
+
+  writeShard("",0,std::vector<int>({4,5}),5);
+  const std::string SName=JName+".0";
+  const std::string Before=readFile(SName);
+
+  const runJournal SJ(SName);
+  size_t SI,SN;
+  if (SJ.nDone()!=1 || !SJ.isComplete(4) || SJ.isComplete(5) ||
+      !SJ.getShard(SI,SN) || SI!=0 || SN!=2 ||
+      SJ.getPlanned()!=std::vector<int>({4,5}))
+    {
+      ELog::EM<<"Done == "<<SJ.nDone()<<ELog::endDiag;
+      return -1;
+    }
+  runJournal RJ(SName);
+  try
+    {
+      RJ.append(SJ.getRecord(4));
+      ELog::EM<<"Appended to a read only journal"<<ELog::endDiag;
+      return -1;
+    }
+  catch (ColErr::FileError&)
+    { }
+  if (readFile(SName)!=Before)
+    {
+      ELog::EM<<"Journal changed"<<ELog::endDiag;
+      return -1;
+    }
+  return 0;
+}
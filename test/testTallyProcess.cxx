@@ -0,0 +1,432 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testTallyProcess.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <regex>
+
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "regexSupport.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "tallyProcess.h"
+#include "TestFunc.h"
+#include "testTallyProcess.h"
+
+testTallyProcess::testTallyProcess() :
+  FName((boost::filesystem::temp_directory_path() /
+	 boost::filesystem::unique_path("tally-%%%%-%%%%.outp")).string())
+  /*!
+    Constructor
+  */
+{}
+
+testTallyProcess::~testTallyProcess()
+  /*!
+    Destructor : remove the test file
+  */
+{
+  boost::system::error_code EC;
+  boost::filesystem::remove(FName,EC);
+}
+
+int
+testTallyProcess::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testTallyProcess","applyTest");
+  TestFunc::regSector("testTallyProcess");
+
+  typedef int (testTallyProcess::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testTallyProcess::testReadMCNP,
+      &testTallyProcess::testNoTally,
+      &testTallyProcess::testRelError
+    };
+  const std::string TestName[]=
+    {
+      "ReadMCNP",
+      "NoTally",
+      "RelError"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+void
+testTallyProcess::writeOutp(const std::string& OutName)
+  /*!
+    Write an outp file with three flux tallies : single
+    cell blocks, a two cell block and a repeat of a cell
+    \param OutName :: File to write
+  */
+{
+  const std::vector<double> Energy=
+    {1.0e-9,1.0e-7,1.0e-5,1.0e-3,0.1,1.0,5.0,10.0,20.0};
+
+  std::ofstream OX(OutName.c_str());
+  OX<<"          Code Name & Version = MCNPX, 2.7.0"<<std::endl;
+  OX<<"1tally fluctuation charts"<<std::endl;
+  OX<<"  1tally   4   nps is not here"<<std::endl;
+  for(int tally=0;tally<3;tally++)
+    {
+      const std::vector<int> Cells=(tally==1) ?
+	std::vector<int>({7,8}) : std::vector<int>({5,6});
+      OX<<"1tally        4        nps =     "<<100000*(tally+1)<<std::endl;
+      OX<<"           tally type 4    track length estimate"<<std::endl;
+      OX<<"           volumes "<<std::endl;
+      OX<<"                   cell:       "<<Cells[0]
+	<<"            "<<Cells[1]<<std::endl;
+      OX<<"                         1.00000E+00  1.00000E+00"<<std::endl;
+      OX<<" "<<std::endl;
+      // tally 1 has the cells in columns
+      const size_t nBlock((tally==1) ? 1 : Cells.size());
+      const size_t nCol((tally==1) ? Cells.size() : 1);
+      for(size_t b=0;b<nBlock;b++)
+	{
+	  if (tally==1)
+	    OX<<" cell: "<<Cells[0]<<" "<<Cells[1]<<std::endl;
+	  else
+	    OX<<" cell  "<<Cells[b]<<std::endl;
+	  OX<<"      energy   "<<std::endl;
+	  for(size_t i=0;i<Energy.size();i++)
+	    {
+	      OX<<"    "<<std::scientific<<std::setprecision(4)<<Energy[i];
+	      for(size_t c=0;c<nCol;c++)
+		{
+		  const double V=1.0e-3*static_cast<double>
+		    ((i+1)*(b+c+1)+static_cast<size_t>(tally)*3);
+		  OX<<"   "<<std::scientific<<std::setprecision(5)<<V<<" "
+		    <<std::fixed<<std::setprecision(4)
+		    <<0.01*static_cast<double>(i+c+1);
+		}
+	      OX<<std::endl;
+	    }
+	  OX<<"      total      1.00000E-02 0.0100"<<std::endl;
+	  OX<<" "<<std::endl;
+	}
+      OX<<" ==================================================="<<std::endl;
+    }
+  OX<<" run terminated when "<<300000<<" particle histories were done."
+    <<std::endl;
+  OX.close();
+  return;
+}
+
+int
+testTallyProcess::streamFind1Tally(std::istream& IX,int& tallyN,
+				   long int& nps)
+  /*!
+    Find the next 1tally line [stream reader]
+    \param IX :: input stream
+    \param tallyN :: tally number
+    \param nps :: number of points
+    \return true on success
+  */
+{
+  const std::regex tallySearch("^1tally\\s+(\\d+)\\s+nps =\\s+(\\d+)");
+
+  std::vector<int> OutPts;
+  std::string SLine=StrFunc::getLine(IX);
+  while (IX.good())
+    {
+      if (StrFunc::StrFullSplit(SLine,tallySearch,OutPts) &&
+	  OutPts.size()>1)
+	{
+	  tallyN=OutPts[0];
+	  nps=OutPts[1];
+	  return 1;
+	}
+      SLine=StrFunc::getLine(IX);
+    }
+  return 0;
+}
+
+void
+testTallyProcess::streamFluxTally(std::istream& IX,const long int npsFile,
+				  CTYPE& Flux)
+  /*!
+    Read a tally [stream reader]
+    \param IX :: Input stream
+    \param npsFile :: number of points in current file
+    \param Flux :: Fluxes to add to
+  */
+{
+  std::string testItem;
+  int cellItem;
+
+  std::string SLine=StrFunc::getLine(IX);
+  while (IX.good() && SLine.find("=======")==std::string::npos)
+    {
+      if (StrFunc::section(SLine,testItem) &&
+	  (testItem=="cell" || testItem=="cell:"))
+	{
+	  std::vector<int> cellName;
+	  while(StrFunc::section(SLine,cellItem))
+	    cellName.push_back(cellItem);
+	  SLine=StrFunc::getLine(IX);
+	  if (StrFunc::section(SLine,testItem) && testItem=="energy")
+	    streamWorkEnergy(IX,npsFile,cellName,Flux);
+	}
+      SLine=StrFunc::getLine(IX);
+    }
+  return;
+}
+
+void
+testTallyProcess::streamWorkEnergy(std::istream& IX,const long int npsFile,
+				   const std::vector<int>& cellName,
+				   CTYPE& Flux)
+  /*!
+    Read the energy rows of a tally [stream reader]. The
+    MCNP error is relative [as tallyProcess].
+    \param IX :: Input stream
+    \param npsFile :: nps points in the file
+    \param cellName :: cell list
+    \param Flux :: Fluxes to add to
+  */
+{
+  const size_t cnt(cellName.size());
+
+  std::vector<WorkData> FluxWork(cnt);
+  for(size_t index=0;index<cnt;index++)
+    FluxWork[index].initX(0.0);
+
+  std::string SLine=StrFunc::getLine(IX);
+  double energy,flux,fluxErr;
+  while(IX.good() && SLine.find("total")==std::string::npos)
+    {
+      if (StrFunc::section(SLine,energy))
+	{
+	  for(size_t index=0;index<cnt;index++)
+	    {
+	      if (!StrFunc::section(SLine,flux) ||
+		  !StrFunc::section(SLine,fluxErr))
+		throw ColErr::FileError(static_cast<int>(index),
+					"Error with data in tally",SLine);
+	      FluxWork[index].pushData
+		(energy,DError::doubleErr(flux,fluxErr*std::abs(flux)));
+	    }
+	}
+      SLine=StrFunc::getLine(IX);
+    }
+
+  tallyProcess::cinderRebin(FluxWork);
+  for(size_t index=0;index<cnt;index++)
+    {
+      FluxWork[index].setWeight(static_cast<double>(npsFile));
+      CTYPE::iterator mc=Flux.find(cellName[index]);
+      if (mc==Flux.end())
+	Flux.emplace(cellName[index],FluxWork[index]);
+      else
+	mc->second+=FluxWork[index];
+    }
+  return;
+}
+
+void
+testTallyProcess::streamRead(const std::string& OutName,CTYPE& Flux)
+  /*!
+    Read all the tallies of an outp file [stream reader]
+    \param OutName :: File to read
+    \param Flux :: Fluxes found
+  */
+{
+  std::ifstream IX(OutName.c_str());
+  int tallyN(0);
+  long int npsFile(0);
+  while(streamFind1Tally(IX,tallyN,npsFile))
+    streamFluxTally(IX,npsFile,Flux);
+  return;
+}
+
+int
+testTallyProcess::testReadMCNP()
+  /*!
+    Test that the mapped reader gives the same fluxes
+    as the stream reader
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testTallyProcess","testReadMCNP");
+
+  writeOutp(FName);
+
+  CTYPE Flux;
+  streamRead(FName,Flux);
+
+  tallyProcess TP;
+  TP.readMCNP(FName);
+
+  if (Flux.size()!=4 || TP.hasFlux(9))
+    {
+      ELog::EM<<"Reference cells == "<<Flux.size()<<ELog::endDiag;
+      return -1;
+    }
+  for(const CTYPE::value_type& FV : Flux)
+    {
+      if (!TP.hasFlux(FV.first))
+	{
+	  ELog::EM<<"Cell "<<FV.first<<" not read"<<ELog::endDiag;
+	  return -1;
+	}
+      const WorkData& WD=TP.getWorkData(FV.first);
+      const std::vector<DError::doubleErr>& A=WD.getYdata();
+      const std::vector<DError::doubleErr>& B=FV.second.getYdata();
+      bool good(A.size()==B.size() && !B.empty() &&
+		WD.getXdata()==FV.second.getXdata() &&
+		std::abs(WD.getWeight()-FV.second.getWeight())<1e-6);
+      for(size_t i=0;good && i<A.size();i++)
+	good=(std::abs(A[i].getVal()-B[i].getVal())<=
+	      1e-12*std::abs(B[i].getVal()) &&
+	      std::abs(A[i].getErr()-B[i].getErr())<=
+	      1e-12*std::abs(B[i].getErr()));
+      if (!good)
+	{
+	  std::ostringstream cx,rx;
+	  tallyProcess::writeFluxes(cx,WD);
+	  tallyProcess::writeFluxes(rx,FV.second);
+	  ELog::EM<<"Cell "<<FV.first<<ELog::endDiag;
+	  ELog::EM<<"Mapped == \n"<<cx.str()<<ELog::endDiag;
+	  ELog::EM<<"Stream == \n"<<rx.str()<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testTallyProcess::testNoTally()
+  /*!
+    Test that a file without a 1tally line [or no file]
+    is an error
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testTallyProcess","testNoTally");
+
+  std::ofstream OX(FName.c_str());
+  OX<<"1tally fluctuation charts"<<std::endl;
+  OX<<" cell  5"<<std::endl;
+  OX.close();
+
+  const std::vector<std::string> Files({FName,FName+".none",""});
+  for(const std::string& File : Files)
+    {
+      int flag(0);
+      try
+	{
+	  tallyProcess TP;
+	  TP.readMCNP(File);
+	}
+      catch (ColErr::FileError&)
+	{
+	  flag=1;
+	}
+      if (!flag)
+	{
+	  ELog::EM<<"No error reading ["<<File<<"]"<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testTallyProcess::testRelError()
+  /*!
+    Test that the relative errors of the MCNP tally are
+    stored as absolute errors of the fluxes
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testTallyProcess","testRelError");
+
+  writeOutp(FName);
+  tallyProcess TP;
+  TP.readMCNP(FName);
+  for(const int cellN : {5,6,7,8})
+    {
+      const std::vector<DError::doubleErr>& FV=
+	TP.getWorkData(cellN).getYdata();
+      size_t nBin(0);
+      for(const DError::doubleErr& DE : FV)
+	if (DE.getVal()>0.0)
+	  {
+	    // outp relative errors : 0.01 to 0.1
+	    const double R=DE.getErr()/DE.getVal();
+	    if (R<=0.0 || R>0.1+1e-6)
+	      {
+		ELog::EM<<"Cell "<<cellN<<" : "<<DE.getVal()<<" +/- "
+			<<DE.getErr()<<ELog::endDiag;
+		return -1;
+	      }
+	    nBin++;
+	  }
+      if (!nBin)
+	{
+	  ELog::EM<<"Cell "<<cellN<<" has no flux"<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
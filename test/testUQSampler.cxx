@@ -0,0 +1,239 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   test/testUQSampler.cxx
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <functional>
+#include <boost/filesystem.hpp>
+
+#include "Exception.h"
+#include "BaseVisit.h"
+#include "BaseModVisit.h"
+#include "GTKreport.h"
+#include "FileReport.h"
+#include "NameStack.h"
+#include "RegMethod.h"
+#include "OutputLog.h"
+#include "support.h"
+#include "doubleErr.h"
+#include "WorkData.h"
+#include "cinderOption.h"
+#include "cinderHistory.h"
+#include "scenarioSet.h"
+#include "htapeProcess.h"
+#include "tallyProcess.h"
+#include "materialProcess.h"
+#include "Control.h"
+#include "runProgs.h"
+#include "cellJob.h"
+#include "cellRunner.h"
+
+#include "TestFunc.h"
+#include "testProblem.h"
+#include "testUQSampler.h"
+
+testUQSampler::testUQSampler()
+  /*!
+    Constructor
+  */
+{}
+
+testUQSampler::~testUQSampler()
+  /*!
+    Destructor
+  */
+{}
+
+int
+testUQSampler::applyTest(const int extra)
+  /*!
+    Applies all the tests and returns
+    the error number
+    \param extra :: Index of test to run [-ve : all]
+    \returns -ve on error 0 on success.
+  */
+{
+  ELog::RegMethod RegA("testUQSampler","applyTest");
+  TestFunc::regSector("testUQSampler");
+
+  typedef int (testUQSampler::*testPtr)();
+  testPtr TPtr[]=
+    {
+      &testUQSampler::testSamples,
+      &testUQSampler::testScaledCopy
+    };
+  const std::string TestName[]=
+    {
+      "Samples",
+      "ScaledCopy"
+    };
+
+  const size_t TSize(sizeof(TPtr)/sizeof(testPtr));
+  if (!extra)
+    {
+      std::ios::fmtflags flagIO=std::cout.setf(std::ios::left);
+      for(size_t i=0;i<TSize;i++)
+	std::cout<<std::setw(30)<<TestName[i]<<"("<<i+1<<")"<<std::endl;
+      std::cout.flags(flagIO);
+      return 0;
+    }
+  for(size_t i=0;i<TSize;i++)
+    {
+      if (extra<0 || static_cast<size_t>(extra)==i+1)
+	{
+	  TestFunc::regTest(TestName[i]);
+	  const int retValue= (this->*TPtr[i])();
+	  if (retValue || extra>0)
+	    return retValue;
+	}
+    }
+  return 0;
+}
+
+int
+testUQSampler::testSamples()
+  /*!
+    Test that the samples of a cell are reduced to the
+    statistics files and removed, and that the statistics
+    do not depend on the number of workers
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testUQSampler","testSamples");
+
+  std::string Mean;
+  for(const size_t nW : {1,3})
+    {
+      testProblem TP("uq");
+      TP.addCell(1,1.0,1.0,0,1.0);
+      TP.addOptions("run_options\nuq_samples 6\nworkers "+
+		    std::to_string(nW)+"\n");
+      Control Ctrl;
+      TP.readControl(Ctrl);
+      if (Ctrl.writeCinderInput())
+	{
+	  ELog::EM<<"Run failed : workers "<<nW<<ELog::endDiag;
+	  return -1;
+	}
+      for(const std::string Ext : {".mean",".std",".p05",".p50",".p95"})
+	if (testProblem::readFile("Cell1/tabs"+Ext).empty())
+	  {
+	    ELog::EM<<"Missing tabs"<<Ext<<ELog::endDiag;
+	    return -1;
+	  }
+      if (boost::filesystem::exists("Cell1/uq0") ||
+	  testProblem::readFile("Cell1/uq.summary")!=
+	  "seed 12345 samples 6\ntabs 6\n")
+	{
+	  ELog::EM<<"Summary == "<<testProblem::readFile("Cell1/uq.summary")
+		  <<ELog::endDiag;
+	  return -1;
+	}
+      const std::string M=testProblem::readFile("Cell1/tabs.mean");
+      if (Mean.empty())
+	Mean=M;
+      else if (M!=Mean)
+	{
+	  ELog::EM<<"Mean depends on the workers ::\n"<<M<<ELog::endDiag;
+	  return -1;
+	}
+      // sampled flux : spread in the values [not the ids]
+      const std::string S=testProblem::readFile("Cell1/tabs.std");
+      if (M.find("2.70600e+04")==std::string::npos ||
+	  S.find("0.00000e+00")==std::string::npos ||
+	  S.find_first_of("123456789")==std::string::npos)
+	{
+	  ELog::EM<<"Mean ::\n"<<M<<ELog::endDiag;
+	  ELog::EM<<"Std ::\n"<<S<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+int
+testUQSampler::testScaledCopy()
+  /*!
+    Test that a clustered copy of another volume takes the
+    statistics of its source scaled as its tables
+    \return -ve on error
+  */
+{
+  ELog::RegMethod RegA("testUQSampler","testScaledCopy");
+
+  testProblem TP("uq");
+  TP.addCell(1,1.0,1.0,0,1.0);     // from cell 2 [x 1/3]
+  TP.addCell(2,2.0,1.5,0,1.5);
+  TP.addOptions("run_options\nuq_samples 4\ncluster_tol 0.01\n");
+  Control Ctrl;
+  TP.readControl(Ctrl);
+  if (Ctrl.writeCinderInput())
+    {
+      ELog::EM<<"Run failed"<<ELog::endDiag;
+      return -1;
+    }
+
+  for(const std::string Ext : {".mean",".std",".p05",".p50",".p95"})
+    {
+      const std::string A=testProblem::readFile("Cell2/tabs"+Ext);
+      const std::string B=testProblem::readFile("Cell1/tabs"+Ext);
+      // ids and half-lives kept : values 1/3
+      std::istringstream AX(A),BX(B);
+      std::string AItem,BItem;
+      size_t nScaled(0);
+      while(AX>>AItem)
+	{
+	  double AV,BV;
+	  if (!(BX>>BItem)) return -1;
+	  if (!StrFunc::convert(AItem,AV) || !StrFunc::convert(BItem,BV))
+	    {
+	      if (AItem!=BItem) return -1;
+	    }
+	  else if (AItem!=BItem)
+	    {
+	      nScaled++;
+	      if (std::abs(BV-AV/3.0)>1e-5*std::abs(AV))
+		{
+		  ELog::EM<<"tabs"<<Ext<<" : "<<AItem<<" "<<BItem
+			  <<ELog::endDiag;
+		  return -1;
+		}
+	    }
+	}
+      if (A.empty() || nScaled!=6 ||
+	  (Ext!=".std" && (B.find("2.70600e+04")==std::string::npos ||
+			   B.find("5.27100e+00")==std::string::npos)))
+	{
+	  ELog::EM<<"Cell2 tabs"<<Ext<<" ::\n"<<A<<ELog::endDiag;
+	  ELog::EM<<"Cell1 tabs"<<Ext<<" ::\n"<<B<<ELog::endDiag;
+	  return -1;
+	}
+    }
+  return 0;
+}
@@ -0,0 +1,62 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/TestFunc.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef TestFunc_h
+#define TestFunc_h
+
+/*!
+  \class TestFunc
+  \brief Names of the test being run
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Each test class registers itself [regSector] and each
+  test [regTest] before it is run, so that a failure can
+  be reported as sector::test by testMain.
+*/
+
+class TestFunc
+{
+ private:
+
+  std::string sectorName;      ///< Current test class
+  std::string testName;        ///< Current test
+
+  TestFunc();
+
+  ///\cond SINGLETON
+  TestFunc(const TestFunc&);
+  TestFunc& operator=(const TestFunc&);
+  ///\endcond SINGLETON
+
+ public:
+
+  static TestFunc& Instance();
+  ~TestFunc();
+
+  static void regSector(const std::string&);
+  static void regTest(const std::string&);
+  static std::string getName();
+
+};
+
+#endif
@@ -0,0 +1,52 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testCellDedup.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testCellDedup_h
+#define testCellDedup_h
+
+/*!
+  \class testCellDedup
+  \brief Tests the reuse of cell problems
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Runs stand-in problems [testProblem] with cells
+  that have the same or different CINDER problems.
+*/
+
+class testCellDedup
+{
+ private:
+
+  int testExact();
+  int testCopy();
+  int testCluster();
+
+ public:
+
+  testCellDedup();
+  ~testCellDedup();
+
+  int applyTest(const int);
+};
+
+#endif
@@ -0,0 +1,70 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testCellRunner.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testCellRunner_h
+#define testCellRunner_h
+
+struct cellJob;
+class cellRunner;
+
+/*!
+  \class testCellRunner
+  \brief Tests the cell runner with stand-in CINDER/TABCODE
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  The programs are shell scripts written to the scratch
+  directory : CINDER copies the input to outp [or fails/
+  hangs if the input says so] and TABCODE writes tabs/tab1.
+*/
+
+class testCellRunner
+{
+ private:
+
+  std::string testDir;          ///< Scratch directory
+  std::string cinderEXE;        ///< CINDER of runProgs before the test
+  std::string tabcodeEXE;       ///< TABCODE of runProgs before the test
+
+  std::string cellDir(const int) const;
+  static void writeFile(const boost::filesystem::path&,const std::string&);
+  static std::string readFile(const boost::filesystem::path&);
+  static void writeDeck(const cellJob&,const std::string&);
+  void addJobs(cellRunner&,const std::vector<int>&) const;
+
+  int testRun();
+  int testFailure();
+  int testTimeLimit();
+  int testScratch();
+  int testScaleLine();
+  int testTableDeviation();
+  int testScaleStats();
+
+ public:
+
+  testCellRunner();
+  ~testCellRunner();
+
+  int applyTest(const int);
+};
+
+#endif
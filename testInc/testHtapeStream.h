@@ -0,0 +1,59 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testHtapeStream.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testHtapeStream_h
+#define testHtapeStream_h
+
+class htapeSection;
+
+/*!
+  \class testHtapeStream
+  \brief Tests the incremental htape table reader
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  The same table is read by htapeProcess::findSections
+  [and the sections read from the stream] and by an
+  htapeStream given the text in blocks of several sizes.
+*/
+
+class testHtapeStream
+{
+ private:
+
+  static std::string prodTable();
+  static std::string gasTable();
+  static std::string sectString(const size_t,const htapeSection&);
+  int compareTable(const std::string&,const bool);
+
+  int testProduction();
+  int testGas();
+
+ public:
+
+  testHtapeStream();
+  ~testHtapeStream();
+
+  int applyTest(const int);
+};
+
+#endif
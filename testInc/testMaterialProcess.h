@@ -0,0 +1,58 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testMaterialProcess.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testMaterialProcess_h
+#define testMaterialProcess_h
+
+class materialProcess;
+
+/*!
+  \class testMaterialProcess
+  \brief Tests the material cards of the MCNP output
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Reads the cell and material cards of a stand-in
+  MCNP output and mixes the materials.
+*/
+
+class testMaterialProcess
+{
+ private:
+
+  std::string FName;            ///< Test outp file
+
+  void readMaterials(materialProcess&) const;
+  static std::string matBlock(const materialProcess&,const int);
+
+  int testMix();
+  int testSameVoid();
+
+ public:
+
+  testMaterialProcess();
+  ~testMaterialProcess();
+
+  int applyTest(const int);
+};
+
+#endif
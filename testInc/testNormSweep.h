@@ -0,0 +1,53 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testNormSweep.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testNormSweep_h
+#define testNormSweep_h
+
+/*!
+  \class testNormSweep
+  \brief Tests the source normalisation sweep
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Runs stand-in problems [testProblem] with a sweep and
+  checks which cells are run and which are scaled.
+*/
+
+class testNormSweep
+{
+ private:
+
+  static bool isRun(const int,const size_t);
+
+  int testFlagged();
+  int testSpotCheck();
+
+ public:
+
+  testNormSweep();
+  ~testNormSweep();
+
+  int applyTest(const int);
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testProblem.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testProblem_h
+#define testProblem_h
+
+class Control;
+
+/*!
+  \class testProblem
+  \brief Stand-in activation problem for the Control tests
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Writes an MCNP output [flux tallies], a histp stand-in
+  [production per cell] and a control file in a scratch
+  directory, which is the working directory while the
+  problem exists. HTAPE, CINDER and TABCODE are shell
+  scripts : TABCODE writes tables with values in
+  proportion to volume x norm x integral flux.
+*/
+
+class testProblem
+{
+ private:
+
+  /// Cell : volume, flux factor, spectrum shape, production factor
+  struct cellDef
+  {
+    double volume;            ///< Cell volume
+    double flux;              ///< Flux factor
+    int shape;                ///< Spectrum shape [0 : flat]
+    double prod;              ///< Production factor
+  };
+
+  std::string testDir;          ///< Scratch directory
+  boost::filesystem::path topDir;  ///< Working directory before
+  std::string htapeEXE;         ///< HTAPE of runProgs before
+  std::string cinderEXE;        ///< CINDER of runProgs before
+  std::string tabcodeEXE;       ///< TABCODE of runProgs before
+
+  std::map<int,cellDef> Cells;  ///< Cells of the problem
+  std::string Options;          ///< Extra control file lines
+
+  ///\cond SINGLETON
+  testProblem(const testProblem&);
+  testProblem& operator=(const testProblem&);
+  ///\endcond SINGLETON
+
+  void writeScripts() const;
+  void writeOutp() const;
+  void writeHistp() const;
+  void writeControl() const;
+
+ public:
+
+  explicit testProblem(const std::string&);
+  ~testProblem();
+
+  static void writeFile(const boost::filesystem::path&,const std::string&);
+  static std::string readFile(const boost::filesystem::path&);
+
+  /// Scratch directory
+  const std::string& getDir() const { return testDir; }
+  void addCell(const int,const double,const double,
+	       const int,const double);
+  void addOptions(const std::string&);
+  void readControl(Control&) const;
+};
+
+#endif
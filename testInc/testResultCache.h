@@ -0,0 +1,56 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testResultCache.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testResultCache_h
+#define testResultCache_h
+
+/*!
+  \class testResultCache
+  \brief Tests the CINDER/TABCODE result cache
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+*/
+
+class testResultCache
+{
+ private:
+
+  std::string testDir;          ///< Scratch directory
+
+  std::string makeCell(const std::string&,const std::string&) const;
+  static void writeFile(const boost::filesystem::path&,const std::string&);
+  static std::string readFile(const boost::filesystem::path&);
+
+  int testKey();
+  int testRunFile();
+  int testStore();
+  int testEviction();
+
+ public:
+
+  testResultCache();
+  ~testResultCache();
+
+  int applyTest(const int);
+};
+
+#endif
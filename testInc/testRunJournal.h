@@ -0,0 +1,62 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testRunJournal.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testRunJournal_h
+#define testRunJournal_h
+
+struct cellJob;
+
+/*!
+  \class testRunJournal
+  \brief Tests the run journal
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Records are written for cells with real input/output
+  files in a scratch directory and read back on resume.
+*/
+
+class testRunJournal
+{
+ private:
+
+  std::string testDir;          ///< Scratch directory
+  std::string JName;            ///< Journal file
+
+  std::string makeCell(const int) const;
+  static cellJob makeJob(const int,const std::string&,const int);
+  static std::vector<std::string> readLines(const std::string&);
+
+  int testRoundTrip();
+  int testTornLine();
+  int testResume();
+  int testAppendOnly();
+
+ public:
+
+  testRunJournal();
+  ~testRunJournal();
+
+  int applyTest(const int);
+};
+
+#endif
@@ -0,0 +1,57 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testSampleStats.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testSampleStats_h
+#define testSampleStats_h
+
+/*!
+  \class testSampleStats
+  \brief Tests the streaming statistics of sample files
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Quantile estimates [pSquare] against exact values and
+  statistics files of sample files in a scratch directory.
+*/
+
+class testSampleStats
+{
+ private:
+
+  std::string testDir;          ///< Scratch directory
+
+  void writeFile(const std::string&,const std::string&) const;
+  std::string readFile(const std::string&) const;
+
+  int testPSquare();
+  int testStats();
+  int testLayout();
+
+ public:
+
+  testSampleStats();
+  ~testSampleStats();
+
+  int applyTest(const int);
+};
+
+#endif
@@ -0,0 +1,50 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testScenario.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testScenario_h
+#define testScenario_h
+
+/*!
+  \class testScenario
+  \brief Tests the runs of named histories
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Runs a stand-in problem [testProblem] with the main
+  history and a named history.
+*/
+
+class testScenario
+{
+ private:
+
+  int testShareDecks();
+
+ public:
+
+  testScenario();
+  ~testScenario();
+
+  int applyTest(const int);
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testShardMerge.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testShardMerge_h
+#define testShardMerge_h
+
+class Control;
+
+/*!
+  \class testShardMerge
+  \brief Tests the merge of the shard journals
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  Shard journals of the main history and of a named
+  history are written in a scratch directory and merged
+  through a Control read from a control file.
+*/
+
+class testShardMerge
+{
+ private:
+
+  std::string testDir;          ///< Scratch directory
+  std::string JName;            ///< Main journal file
+
+  std::string makeCell(const std::string&,const int) const;
+  void writeShard(const std::string&,const size_t,
+		  const std::vector<int>&,const int) const;
+  void readControl(Control&) const;
+  static std::string readFile(const std::string&);
+  static size_t nRecords(const std::string&);
+
+  int testMerge();
+  int testMissing();
+  int testReadOnly();
+
+ public:
+
+  testShardMerge();
+  ~testShardMerge();
+
+  int applyTest(const int);
+};
+
+#endif
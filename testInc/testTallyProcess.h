@@ -0,0 +1,65 @@
+/*********************************************************************
+  CombLayer : MCNP(X) Input builder
+
+ * File:   testInc/testTallyProcess.h
+ *
+ * Copyright (c) 2004-2016 by Stuart Ansell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+#ifndef testTallyProcess_h
+#define testTallyProcess_h
+
+/*!
+  \class testTallyProcess
+  \brief Tests the MCNP outp tally reader
+  \version 1.0
+  \date October 2016
+  \author S. Ansell
+
+  The memory mapped reader in tallyProcess is checked
+  against the line by line stream reader it replaced,
+  which is kept here as the reference.
+*/
+
+class testTallyProcess
+{
+ private:
+
+  /// Reference fluxes [cell : flux]
+  typedef std::map<int,WorkData> CTYPE;
+
+  std::string FName;            ///< Test outp file
+
+  static void writeOutp(const std::string&);
+  static int streamFind1Tally(std::istream&,int&,long int&);
+  static void streamFluxTally(std::istream&,const long int,CTYPE&);
+  static void streamWorkEnergy(std::istream&,const long int,
+			       const std::vector<int>&,CTYPE&);
+  static void streamRead(const std::string&,CTYPE&);
+
+  int testReadMCNP();
+  int testNoTally();
+  int testRelError();
+
+ public:
+
+  testTallyProcess();
+  ~testTallyProcess();
+
+  int applyTest(const int);
+};
+
+#endif